@@ -414,6 +414,9 @@ ACMD(do_gen_comm)
     char color_on[24];
     char buf1[MAX_INPUT_LENGTH], buf2[MAX_INPUT_LENGTH + 50], *msg; /* 50 to make room for color codes */
     bool emoting = FALSE;
+    struct broadcast heard[4];
+    char *heard_msg[4] = {NULL, NULL, NULL, NULL};
+    int variant;
 
     /* Array of flags which must _not_ be set in order for comm to be heard. */
     int channels[] = {0, PRF_NOSHOUT, PRF_NOGOSS, PRF_NOAUCT, PRF_NOGRATZ, PRF_NOGOSS, 0};
@@ -504,11 +507,16 @@ ACMD(do_gen_comm)
     if (!emoting)
         snprintf(buf1, sizeof(buf1), "$n %s, '%s'", com_msgs[subcmd][1], argument);
 
-    /* Now send all the strings out. */
+    /* Now send all the strings out.  A player hears one of four versions of
+       the message (colour or not, ch seen or not), so each version goes
+       through act() once and is then shared with every player hearing it. */
     for (i = descriptor_list; i; i = i->next) {
         if (STATE(i) != CON_PLAYING || i == ch->desc || !i->character)
             continue;
-        if (!IS_NPC(ch) && (PRF_FLAGGED(i->character, channels[subcmd]) || PLR_FLAGGED(i->character, PLR_WRITING)))
+        /* act() never writes into an editor, whoever speaks; the shared copy must not either. */
+        if (PLR_FLAGGED(i->character, PLR_WRITING))
+            continue;
+        if (!IS_NPC(ch) && PRF_FLAGGED(i->character, channels[subcmd]))
             continue;
 
         if (ROOM_FLAGGED(IN_ROOM(i->character), ROOM_SOUNDPROOF) && (GET_LEVEL(ch) < LVL_GOD))
@@ -518,9 +526,29 @@ ACMD(do_gen_comm)
             ((world[IN_ROOM(ch)].zone != world[IN_ROOM(i->character)].zone) || !AWAKE(i->character)))
             continue;
 
+        variant = (COLOR_LEV(i->character) >= C_NRM ? 1 : 0) | (CAN_SEE(i->character, ch) ? 2 : 0);
+        if (heard_msg[variant] && !IS_NPC(i->character)) {
+            broadcast_send(&heard[variant], i);
+            add_history(i->character, heard_msg[variant], hist_type[subcmd]);
+            continue;
+        }
+
+        /* NPCs (switched immortals) always go through act() for their triggers. */
         snprintf(buf2, sizeof(buf2), "%s%s%s", (COLOR_LEV(i->character) >= C_NRM) ? color_on : "", buf1, KNRM);
         msg = act(buf2, FALSE, ch, 0, i->character, TO_VICT | TO_SLEEP);
         add_history(i->character, msg, hist_type[subcmd]);
+
+        if (msg && !heard_msg[variant] && !IS_NPC(i->character)) {
+            heard_msg[variant] = strdup(msg);
+            broadcast_init(&heard[variant], "%s", CAP(heard_msg[variant]));
+        }
+    }
+
+    for (variant = 0; variant < 4; variant++) {
+        if (heard_msg[variant]) {
+            broadcast_free(&heard[variant]);
+            free(heard_msg[variant]);
+        }
     }
 }
 
@@ -436,8 +436,6 @@ ACMD(do_emotionimport);
 ACMD(do_disguise);
 ACMD(do_undisguise);
 
-void init_disabled_commands(void);
-bool is_command_disabled(int cmd_num);
 bool is_level_compatible_with_group(struct char_data *prospect, struct group_data *group);
 void remove_disguise(struct char_data *ch, bool expired);
 void cleanup_disguise_data(struct char_data *ch);
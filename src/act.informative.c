@@ -27,6 +27,7 @@
 #include "fight.h"
 #include "modify.h"
 #include "asciimap.h"
+#include "graph.h"
 #include "quest.h"
 #include "spedit.h"
 #include "string.h" /* garante que strcmp/strlcpy/strtok estejam disponíveis */
@@ -3021,6 +3022,7 @@ static void perform_immort_where(char_data *ch, const char *arg)
     char_data *i;
     obj_data *k;
     struct descriptor_data *d;
+    struct name_cursor cur;
     int num = 0,
         found = FALSE;   // "num" here needs to match the lookup in do_stat, so "stat 4.sword" finds the right one
     const char *error_message = "\r\n***OVERFLOW***\r\n";
@@ -3050,8 +3052,8 @@ static void perform_immort_where(char_data *ch, const char *arg)
         if (PRF_FLAGGED(ch, PRF_VERBOSE))
             len = snprintf(buf, buf_size, "   ### Mob name                   - Room #  Room name\r\n");
 
-        for (i = character_list; i; i = i->next)
-            if (CAN_SEE(ch, i) && IN_ROOM(i) != NOWHERE && isname(arg, i->player.name)) {
+        for (i = first_char_named(arg, &cur); i; i = next_char_named(&cur))
+            if (CAN_SEE(ch, i) && IN_ROOM(i) != NOWHERE) {
                 found = 1;
                 nlen = snprintf(buf + len, buf_size - len, "M%4d. %-25s%s - [%5d] %-25s%s", ++num, GET_NAME(i), QNRM,
                                 GET_ROOM_VNUM(IN_ROOM(i)), world[IN_ROOM(i)].name, QNRM);
@@ -3426,6 +3428,7 @@ ACMD(do_toggle)
             break;
         case SCMD_TRACK:
             result = (CONFIG_TRACK_T_DOORS = !CONFIG_TRACK_T_DOORS);
+            invalidate_pathfind_cache(NOWHERE);
             break;
         case SCMD_BUILDWALK:
             if (GET_LEVEL(ch) < LVL_BUILDER) {
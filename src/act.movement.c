@@ -27,6 +27,7 @@
 #include "quest.h"
 #include "mud_event.h"
 #include "dg_event.h"
+#include "graph.h"
 
 /* local only functions */
 /* do_simple_move utility functions */
@@ -705,6 +706,11 @@ void do_doorcmd(struct char_data *ch, struct obj_data *obj, int door, int scmd)
             OPEN_DOOR(IN_ROOM(ch), obj, door);
             if (back)
                 OPEN_DOOR(other_room, obj, rev_dir[door]);
+            if (!obj) {
+                pathfind_door_changed(IN_ROOM(ch));
+                if (back)
+                    pathfind_door_changed(other_room);
+            }
             send_to_char(ch, "%s", CONFIG_OK);
             break;
 
@@ -712,6 +718,11 @@ void do_doorcmd(struct char_data *ch, struct obj_data *obj, int door, int scmd)
             CLOSE_DOOR(IN_ROOM(ch), obj, door);
             if (back)
                 CLOSE_DOOR(other_room, obj, rev_dir[door]);
+            if (!obj) {
+                pathfind_door_changed(IN_ROOM(ch));
+                if (back)
+                    pathfind_door_changed(other_room);
+            }
             send_to_char(ch, "%s", CONFIG_OK);
             break;
 
@@ -1010,6 +1021,9 @@ ACMD(do_bash_door)
     REMOVE_BIT(EXITN(IN_ROOM(ch), door)->exit_info, EX_CLOSED);
     if (back)
         REMOVE_BIT(EXITN(other_room, rev_dir[door])->exit_info, EX_CLOSED);
+    pathfind_door_changed(IN_ROOM(ch));
+    if (back)
+        pathfind_door_changed(other_room);
 
     send_to_char(ch, "Você derruba a porta com um golpe poderoso!\r\n");
     act("$n derruba $F!", FALSE, ch, 0, EXIT(ch, door)->keyword ? EXIT(ch, door)->keyword : "a porta", TO_ROOM);
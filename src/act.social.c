@@ -284,17 +284,20 @@ static int find_action(int cmd)
 
 ACMD(do_gmote)
 {
-    int act_nr, length;
+    int act_nr;
     char arg[MAX_INPUT_LENGTH], buf[MAX_INPUT_LENGTH];
     struct social_messg *action;
     struct char_data *vict = NULL;
 
     half_chop(argument, buf, arg);
 
-    if (subcmd)
-        for (length = strlen(buf), cmd = 0; *complete_cmd_info[cmd].command != '\n'; cmd++)
-            if (!strncmp(complete_cmd_info[cmd].command, buf, length))
-                break;
+    if (subcmd) {
+        int social = find_command_abbrev(buf, INT_MAX, TRUE);
+
+        cmd = find_command_abbrev(buf, INT_MAX, FALSE);
+        if (cmd < 0 || (social >= 0 && social < cmd))
+            cmd = social;
+    }
 
     if ((act_nr = find_action(cmd)) < 0) {
         snprintf(buf, sizeof(buf), "Gemote: $n%s", argument);
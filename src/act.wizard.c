@@ -38,7 +38,9 @@
 #include "spirits.h"
 #include "graph.h"
 #include "emotion_projection.h"
+#include "perf.h"
 #include "sec.h"
+#include "netio.h"
 #include <math.h>
 
 /* external functions*/
@@ -2244,6 +2246,8 @@ ACMD(do_switch)
 
         victim->desc = ch->desc;
         ch->desc = NULL;
+        update_zone_presence(ch);
+        update_zone_presence(victim);
     }
 }
 
@@ -2279,7 +2283,9 @@ void return_to_char(struct char_data *ch)
 
     /* And our body's pointer to descriptor now points to our descriptor. */
     ch->desc->character->desc = ch->desc;
+    update_zone_presence(ch->desc->character);
     ch->desc = NULL;
+    update_zone_presence(ch);
 }
 
 ACMD(do_return)
@@ -2467,6 +2473,7 @@ ACMD(do_purge)
                     STATE(vict->desc) = CON_CLOSE;
                     vict->desc->character = NULL;
                     vict->desc = NULL;
+                    update_zone_presence(vict);
                 }
             }
             extract_char(vict);
@@ -2574,6 +2581,7 @@ ACMD(do_advance)
     }
 
     gain_exp_regardless(victim, level_exp(GET_CLASS(victim), newlevel) - GET_EXP(victim));
+    update_zone_presence(victim);
     save_char(victim);
 }
 
@@ -3475,8 +3483,11 @@ static size_t print_zone_to_buf(char *bufptr, size_t left, zone_rnum zone, int l
                         "         Mobiles:  %2d\r\n"
                         "         Shops:    %2d\r\n"
                         "         Triggers: %2d\r\n"
-                        "         Quests:   %2d\r\n",
-                        buf, zone_table[zone].min_level, zone_table[zone].max_level, j, k, l, m, n, o);
+                        "         Quests:   %2d\r\n"
+                        "         Players:  %2d (%d connected)\r\n"
+                        "         Dormant:  %s\r\n",
+                        buf, zone_table[zone].min_level, zone_table[zone].max_level, j, k, l, m, n, o,
+                        zone_player_count(zone), zone_table[zone].connected, YESNO(zone_table[zone].dormant));
 
         return tmp;
     }
@@ -3518,6 +3529,7 @@ ACMD(do_show)
                   {"exp", LVL_IMMORT},
                   {"colour", LVL_IMMORT},
                   {"pathstats", LVL_IMMORT},
+                  {"perf", LVL_IMMORT}, /* 15 */
                   {"\n", 0}};
 
     skip_spaces(&argument);
@@ -3666,13 +3678,14 @@ ACMD(do_show)
                          "  %5d objects          %5d prototypes\r\n"
                          "  %5d rooms            %5d zones\r\n"
                          "  %5d triggers         %5d shops\r\n"
-                         "  %5d large bufs       %5d autoquests\r\n"
-                         "  %5d buf switches     %5d overflows\r\n"
-                         "  %5d lists            %5d groups (%5d pending cleanup)\r\n",
+                         "  %5d output chunks    %5d autoquests\r\n"
+                         "  %5d partial sends    %5d overflows\r\n"
+                         "  %5d lists            %5d groups (%5d pending cleanup)\r\n"
+                         "  %5d pulse overruns\r\n",
                          i, con, top_of_p_table + 1, j, top_of_mobt + 1, k, top_of_objt + 1, top_of_world + 1,
-                         top_of_zone_table + 1, top_of_trigt + 1, top_shop + 1, buf_largecount, total_quests,
-                         buf_switches, buf_overflows, global_lists->iSize, group_list ? group_list->iSize : 0,
-                         get_pending_group_cleanup_count());
+                         top_of_zone_table + 1, top_of_trigt + 1, top_shop + 1, buf_chunkcount, total_quests,
+                         buf_partial_sends, buf_overflows, global_lists->iSize, group_list ? group_list->iSize : 0,
+                         get_pending_group_cleanup_count(), pulse_overruns);
 
             /* Calculate and display economy stats for mortal players (level <= 100)
              * Note: This iterates through all player files, which may be slow on
@@ -3852,9 +3865,30 @@ ACMD(do_show)
             }
 
             send_to_char(ch, "Cache entries in use: %d/%d\r\n", valid_entries, PATHFIND_CACHE_SIZE);
+            send_to_char(ch, "Flow fields in use: %d/%d, steps served: %ld\r\n", get_flow_fields_live(), FLOW_FIELDS,
+                         get_flow_field_hits());
+            if (get_astar_searches() > 0)
+                send_to_char(ch, "Cost searches: %ld, rooms expanded per search: %.1f\r\n", get_astar_searches(),
+                             (float)get_astar_rooms_expanded() / get_astar_searches());
             break;
         }
 
+            /* show perf [reset | csv] */
+        case 15:
+            if (is_abbrev(value, "reset") && *value) {
+                perf_reset();
+                send_to_char(ch, "Heartbeat profile reset.\r\n");
+            } else if (is_abbrev(value, "csv") && *value) {
+                if (perf_dump_csv(PERF_LOGFILE))
+                    send_to_char(ch, "Heartbeat profile appended to %s.\r\n", PERF_LOGFILE);
+                else
+                    send_to_char(ch, "Could not write %s.\r\n", PERF_LOGFILE);
+            } else {
+                perf_report(buf, sizeof(buf));
+                send_to_char(ch, "%s", buf);
+            }
+            break;
+
             /* show what? */
         default:
             send_to_char(ch, "Sorry, I don't understand that.\r\n");
@@ -4153,6 +4187,7 @@ static int perform_set(struct char_data *ch, struct char_data *vict, int mode, c
             }
             RANGE(1, LVL_IMPL);
             vict->player.level = value;
+            update_zone_presence(vict);
             break;
         case 26: /* loadroom */
             if (!str_cmp(val_arg, "off")) {
@@ -4211,6 +4246,7 @@ static int perform_set(struct char_data *ch, struct char_data *vict, int mode, c
                 return (0);
             }
             SET_OR_REMOVE(PRF_FLAGS(vict), PRF_NOHASSLE);
+            update_zone_presence(vict);
             break;
         case 35: /* nosummon */
             SET_OR_REMOVE(PRF_FLAGS(vict), PRF_SUMMONABLE);
@@ -5355,6 +5391,11 @@ ACMD(do_copyover)
         exit(1);
     }
 
+#ifdef CIRCLE_NET_THREAD
+    /* Let the network thread finish writing the messages above. */
+    netio_stop();
+#endif
+
     /* Close reserve and other always-open files and release other resources */
     execl(EXE_FILE, "circle", buf2, buf, (char *)NULL);
 
@@ -5799,11 +5840,13 @@ bool change_player_name(struct char_data *ch, struct char_data *vict, char *new_
     // the index
     for (k = 0; (*(player_table[i].name + k) = LOWER(*(player_table[i].name + k))); k++)
         ;
+    hash_player_index();
 
     free(GET_PC_NAME(vict));
     GET_PC_NAME(vict) = strdup(CAP(new_name));   // Change the name in
     // the
     // victims char struct
+    name_index_update(vict);
 
     /* Rename the player's pfile */
     sprintf(buf, "mv %s %s", old_pfile, new_pfile);
@@ -6251,12 +6294,15 @@ ACMD(do_plrload)
             Crash_load(victim);
             victim->next = character_list;
             character_list = victim;
+            name_index_add(victim);
             victim->desc = NULL;
             char_to_room(victim, IN_ROOM(ch));
             ch->desc->character = victim;
             ch->desc->original = ch;
             victim->desc = ch->desc;
             ch->desc = NULL;
+            update_zone_presence(ch);
+            update_zone_presence(victim);
         } else {
             send_to_char(ch, "Sorry, you aren't godly enough to linkload that char.\r\n");
             free_char(victim);
@@ -7371,41 +7417,14 @@ ACMD(do_portal)
            GET_NAME(ch), bidirectional ? "s" : "", world[IN_ROOM(ch)].number, dest_vnum, timer_buf);
 }
 
-/* Global array to track disabled commands */
-static bool *disabled_cmd = NULL;
-static int num_of_cmds = 0;
-
-void init_disabled_commands(void)
-{
-    int i;
-
-    /* Count commands */
-    for (i = 0; *complete_cmd_info[i].command != '\n'; i++)
-        ;
-    num_of_cmds = i;
-
-    /* Allocate and initialize disabled array */
-    CREATE(disabled_cmd, bool, num_of_cmds);
-    for (i = 0; i < num_of_cmds; i++)
-        disabled_cmd[i] = FALSE;
-}
-
-bool is_command_disabled(int cmd_num)
-{
-    if (cmd_num < 0 || cmd_num >= num_of_cmds)
-        return FALSE;
-
-    return disabled_cmd[cmd_num];
-}
-
 static void list_disabled_commands(struct char_data *ch)
 {
     int i;
     bool found = FALSE;
 
     send_to_char(ch, "Comandos desabilitados:\r\n");
-    for (i = 0; i < num_of_cmds; i++) {
-        if (disabled_cmd[i]) {
+    for (i = 0; *complete_cmd_info[i].command != '\n'; i++) {
+        if (is_command_disabled(i) && find_command(complete_cmd_info[i].command) == i) {
             send_to_char(ch, "  %s\r\n", complete_cmd_info[i].command);
             found = TRUE;
         }
@@ -7442,13 +7461,13 @@ ACMD(do_disable)
     }
 
     /* Check if already disabled */
-    if (disabled_cmd[cmd_num]) {
+    if (is_command_disabled(cmd_num)) {
         send_to_char(ch, "O comando '%s' já está desabilitado.\r\n", complete_cmd_info[cmd_num].command);
         return;
     }
 
     /* Disable the command */
-    disabled_cmd[cmd_num] = TRUE;
+    set_command_disabled(cmd_num, TRUE);
     send_to_char(ch, "Comando '%s' desabilitado com sucesso.\r\n", complete_cmd_info[cmd_num].command);
     mudlog(BRF, LVL_IMMORT, TRUE, "(GC) %s desabilitou o comando: %s", GET_NAME(ch),
            complete_cmd_info[cmd_num].command);
@@ -7475,13 +7494,13 @@ ACMD(do_enable)
     }
 
     /* Check if not disabled */
-    if (!disabled_cmd[cmd_num]) {
+    if (!is_command_disabled(cmd_num)) {
         send_to_char(ch, "O comando '%s' não está desabilitado.\r\n", complete_cmd_info[cmd_num].command);
         return;
     }
 
     /* Enable the command */
-    disabled_cmd[cmd_num] = FALSE;
+    set_command_disabled(cmd_num, FALSE);
     send_to_char(ch, "Comando '%s' habilitado com sucesso.\r\n", complete_cmd_info[cmd_num].command);
     mudlog(BRF, LVL_IMMORT, TRUE, "(GC) %s habilitou o comando: %s", GET_NAME(ch), complete_cmd_info[cmd_num].command);
 }
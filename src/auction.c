@@ -37,12 +37,13 @@ struct auction_stats global_auction_stats = {0, 0, 0, 0, 0, 0};
 static struct char_data *find_player_online(const char *name)
 {
     struct char_data *i;
+    struct name_cursor cur;
 
     if (!name || !*name) {
         return NULL;
     }
 
-    for (i = character_list; i; i = i->next) {
+    for (i = first_char_named(name, &cur); i; i = next_char_named(&cur)) {
         if (!IS_NPC(i) && !str_cmp(GET_NAME(i), name)) {
             return i;
         }
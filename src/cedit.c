@@ -18,6 +18,7 @@
 #include "improved-edit.h"
 #include "modify.h"
 #include "malp.h"
+#include "graph.h"
 
 /* local scope functions, not used externally */
 static void cedit_disp_menu(struct descriptor_data *d);
@@ -160,6 +161,8 @@ static void cedit_setup(struct descriptor_data *d)
     OLC_CONFIG(d)->operation.protocol_negotiation = CONFIG_PROTOCOL_NEGOTIATION;
     OLC_CONFIG(d)->operation.special_in_comm = CONFIG_SPECIAL_IN_COMM;
     OLC_CONFIG(d)->operation.debug_mode = CONFIG_DEBUG_MODE;
+    OLC_CONFIG(d)->operation.zone_dormancy = CONFIG_ZONE_DORMANCY;
+    OLC_CONFIG(d)->operation.dormant_mob_rate = CONFIG_DORMANT_MOB_RATE;
 
     /* Autowiz */
     OLC_CONFIG(d)->autowiz.use_autowiz = CONFIG_USE_AUTOWIZ;
@@ -394,7 +397,11 @@ static void cedit_save_internally(struct descriptor_data *d)
     CONFIG_IDLE_MAX_LEVEL = OLC_CONFIG(d)->play.idle_max_level;
     CONFIG_DTS_ARE_DUMPS = OLC_CONFIG(d)->play.dts_are_dumps;
     CONFIG_LOAD_INVENTORY = OLC_CONFIG(d)->play.load_into_inventory;
-    CONFIG_TRACK_T_DOORS = OLC_CONFIG(d)->play.track_through_doors;
+    /* Cached paths were found with the old door rule. */
+    if (CONFIG_TRACK_T_DOORS != OLC_CONFIG(d)->play.track_through_doors) {
+        CONFIG_TRACK_T_DOORS = OLC_CONFIG(d)->play.track_through_doors;
+        invalidate_pathfind_cache(NOWHERE);
+    }
     CONFIG_NO_MORT_TO_IMMORT = OLC_CONFIG(d)->play.no_mort_to_immort;
     CONFIG_DISP_CLOSED_DOORS = OLC_CONFIG(d)->play.disp_closed_doors;
     CONFIG_DIAGONAL_DIRS = OLC_CONFIG(d)->play.diagonal_dirs;
@@ -446,6 +453,8 @@ static void cedit_save_internally(struct descriptor_data *d)
     CONFIG_PROTOCOL_NEGOTIATION = OLC_CONFIG(d)->operation.protocol_negotiation;
     CONFIG_SPECIAL_IN_COMM = OLC_CONFIG(d)->operation.special_in_comm;
     CONFIG_DEBUG_MODE = OLC_CONFIG(d)->operation.debug_mode;
+    CONFIG_ZONE_DORMANCY = OLC_CONFIG(d)->operation.zone_dormancy;
+    CONFIG_DORMANT_MOB_RATE = OLC_CONFIG(d)->operation.dormant_mob_rate;
 
     /* Autowiz */
     CONFIG_USE_AUTOWIZ = OLC_CONFIG(d)->autowiz.use_autowiz;
@@ -1092,6 +1101,17 @@ int save_config(IDXTYPE nowhere)
             "debug_mode = %d\n\n",
             CONFIG_DEBUG_MODE);
 
+    fprintf(fl,
+            "* Minutes a zone and its neighbours must be empty before its mobs go\n"
+            "* dormant, 0 to keep every zone awake.\n"
+            "zone_dormancy = %d\n\n",
+            CONFIG_ZONE_DORMANCY);
+
+    fprintf(fl,
+            "* Dormant mobs act one turn in this many; 0 freezes them until the zone wakes.\n"
+            "dormant_mob_rate = %d\n\n",
+            CONFIG_DORMANT_MOB_RATE);
+
     fprintf(fl, "\n\n\n* [ Experimental Features ]\n");
 
     fprintf(fl,
@@ -1543,6 +1563,8 @@ static void cedit_disp_operation_options(struct descriptor_data *d)
         "%sR%s) Enable Protocol Negotiation : %s%s\r\n"
         "%sS%s) Enable Special Char in Comm : %s%s\r\n"
         "%sT%s) Current Debug Mode : %s%s\r\n"
+        "%sU%s) Zone Dormancy (minutes, 0 = off) : %s%d\r\n"
+        "%sV%s) Dormant Mob Rate (0 = frozen) : %s%d\r\n"
         "%sQ%s) Exit To The Main Menu\r\n"
         "Enter your choice : ",
         grn, nrm, cyn, OLC_CONFIG(d)->operation.DFLT_PORT, grn, nrm, cyn,
@@ -1565,7 +1587,8 @@ static void cedit_disp_operation_options(struct descriptor_data *d)
             : (OLC_CONFIG(d)->operation.debug_mode == 1
                    ? "BRIEF"
                    : (OLC_CONFIG(d)->operation.debug_mode == 2 ? "NORMAL" : "COMPLETE")),
-        grn, nrm);
+        grn, nrm, cyn, OLC_CONFIG(d)->operation.zone_dormancy, grn, nrm, cyn,
+        OLC_CONFIG(d)->operation.dormant_mob_rate, grn, nrm);
 
     OLC_MODE(d) = CEDIT_OPERATION_OPTIONS_MENU;
 }
@@ -3270,6 +3293,18 @@ void cedit_parse(struct descriptor_data *d, char *arg)
                     OLC_MODE(d) = CEDIT_DEBUG_MODE;
                     return;
 
+                case 'u':
+                case 'U':
+                    write_to_output(d, "Enter the minutes a zone must be empty before it goes dormant (0 = never) : ");
+                    OLC_MODE(d) = CEDIT_ZONE_DORMANCY;
+                    return;
+
+                case 'v':
+                case 'V':
+                    write_to_output(d, "Enter how many turns dormant mobs wait between actions (0 = frozen) : ");
+                    OLC_MODE(d) = CEDIT_DORMANT_MOB_RATE;
+                    return;
+
                 case 'q':
                 case 'Q':
                     cedit_disp_menu(d);
@@ -4893,6 +4928,16 @@ void cedit_parse(struct descriptor_data *d, char *arg)
             cedit_disp_operation_options(d);
             break;
 
+        case CEDIT_ZONE_DORMANCY:
+            OLC_CONFIG(d)->operation.zone_dormancy = LIMIT(atoi(arg), 0, 1440);
+            cedit_disp_operation_options(d);
+            break;
+
+        case CEDIT_DORMANT_MOB_RATE:
+            OLC_CONFIG(d)->operation.dormant_mob_rate = LIMIT(atoi(arg), 0, 100);
+            cedit_disp_operation_options(d);
+            break;
+
         case CEDIT_MIN_WIZLIST_LEV:
             if (atoi(arg) > LVL_IMPL) {
                 write_to_output(d,
@@ -86,6 +86,8 @@
 #include "ann.h"
 #include "protocol.h" /* for ProtocolNAWSAutoConfig */
 #include "auction.h"  /* for update_auctions */
+#include "netio.h"
+#include "perf.h"
 
 #ifndef INVALID_SOCKET
 #    define INVALID_SOCKET (-1)
@@ -95,15 +97,24 @@
 #    define RUSAGE 1
 #endif
 
+/* Output counted against MAX_OUTPUT_BACKLOG: still queued here, plus already
+   handed to the network thread and not yet written. */
+#ifdef CIRCLE_NET_THREAD
+#    define OUTPUT_BACKLOG(d) ((d)->output.total + ((d)->conn ? netio_backlog((d)->conn) : 0))
+#else
+#    define OUTPUT_BACKLOG(d) ((d)->output.total)
+#endif
+
 extern time_t motdmod;
 extern time_t newsmod;
 extern void free_armweap();
 
 /* locally defined globals, used externally */
 struct descriptor_data *descriptor_list = NULL; /* master desc list */
-int buf_largecount = 0;                         /* # of large buffers which exist */
+int buf_chunkcount = 0;                         /* # of output chunks which exist */
 int buf_overflows = 0;                          /* # of overflows of output */
-int buf_switches = 0;                           /* # of switches from small to large buf */
+int buf_partial_sends = 0;                      /* # of sends the kernel took only in part */
+int pulse_overruns = 0;                         /* # of pulses run late, to catch up */
 int circle_shutdown = 0;                        /* clean shutdown */
 int circle_reboot = 0;                          /* reboot the game after a shutdown */
 int shutdown_signal = 0;                        /* signal that caused shutdown (0 if normal) */
@@ -116,7 +127,7 @@ socket_t mother_desc;
 int next_tick = SECS_PER_MUD_HOUR; /* Tick countdown */
 
 /* static local global variable declarations (current file scope only) */
-static struct txt_block *bufpool = 0; /* pool of large output buffers */
+static struct out_chunk *chunk_pool = NULL; /* pool of free output chunks */
 static int max_players = 0;           /* max descriptors available */
 static int tics_passed = 0;           /* for extern checkpointing */
 static struct timeval null_time;      /* zero-valued time structure */
@@ -125,6 +136,14 @@ static byte reread_wizlist;           /* signal: SIGUSR1 */
 static int dg_act_check; /* toggle for act_trigger */
 static bool fCopyOver;   /* Are we booting in copyover mode? */
 static char *last_act_message = NULL;
+static struct descriptor_data *io_ready_list = NULL; /* descs with socket events to handle */
+static struct timeval pass_start;                    /* when this pass of game_loop woke up */
+static int pulses_behind = 0;                        /* catch-up pulses still to run after this one */
+static int deferred_jobs = 0;                        /* DEFER_ jobs waiting for a pulse with time to spare */
+static unsigned long deferred_since[NUM_DEFER_JOBS]; /* pulse each waiting job was first put off */
+#ifdef CIRCLE_EPOLL
+static int epoll_desc = -1; /* epoll instance watching every socket */
+#endif
 
 /* static local function prototypes (current file scope only) */
 static RETSIGTYPE reread_wizlists(int sig);
@@ -135,6 +154,7 @@ static RETSIGTYPE checkpointing(int sig);
 static RETSIGTYPE hupsig(int sig);
 static ssize_t perform_socket_read(socket_t desc, char *read_point, size_t space_left);
 static ssize_t perform_socket_write(socket_t desc, const char *txt, size_t length);
+static ssize_t perform_socket_writev(socket_t desc, struct iovec *iov, int iovcnt);
 static void circle_sleep(struct timeval *timeout);
 static int get_from_q(struct txt_q *queue, char *dest, int *aliased);
 static void init_game(ush_int port);
@@ -151,14 +171,33 @@ static void nonblock(socket_t s);
 static int perform_subst(struct descriptor_data *t, char *orig, char *subst);
 static int is_valid_utf8_byte(struct descriptor_data *t, unsigned char byte, const char *next_bytes, int remaining);
 static void record_usage(void);
+static bool heartbeat_behind(void);
+static bool run_deferrable(int job, bool due, int max_delay);
 static char *make_prompt(struct descriptor_data *point);
 static void check_idle_passwords(void);
 static void init_descriptor(struct descriptor_data *newd, int desc);
+static void io_init(socket_t mother);
+static void io_register(struct descriptor_data *d);
+static void io_unregister(struct descriptor_data *d);
+static void io_mark_ready(struct descriptor_data *d, int events);
+static void io_clear_ready(struct descriptor_data *d, int events);
+static void io_wait_for_connection(socket_t mother);
+static int io_poll(socket_t mother);
 
 static struct in_addr *get_bind_addr(void);
 static int parse_ip(const char *addr, struct in_addr *inaddr);
 static int set_sendbuf(socket_t s);
-static void free_bufpool(void);
+static void free_chunk_pool(void);
+static struct out_chunk *chunk_get(void);
+static int output_trailers(struct descriptor_data *t, struct iovec *iov, char *prompt, size_t prompt_size);
+static size_t output_translate(struct descriptor_data *t, const char *text, int size);
+static void output_append(struct descriptor_data *t, const char *txt, size_t len);
+static void output_consume(struct descriptor_data *t, size_t len);
+static void output_clear(struct descriptor_data *t);
+#ifdef CIRCLE_NET_THREAD
+static int output_handoff(struct descriptor_data *t, bool framed);
+static void output_push_copy(struct descriptor_data *t, const char *txt, size_t len);
+#endif
 static void setup_log(const char *filename, int fd);
 static int open_logfile(const char *filename, FILE *stderr_fp);
 #if defined(POSIX)
@@ -388,7 +427,7 @@ int main(int argc, char **argv)
 
     if (!scheck) {
         log1("Clearing other memory.");
-        free_bufpool();                        /* comm.c */
+        free_chunk_pool();                     /* comm.c */
         free_player_index();                   /* players.c */
         free_messages();                       /* fight.c */
         free_text_files();                     /* db.c */
@@ -603,6 +642,10 @@ static void init_game(ush_int local_port)
     /* If we made it this far, we will be able to restart without problem. */
     remove(KILLSCRIPT_FILE);
 
+#ifdef CIRCLE_NET_THREAD
+    netio_start(max_players);
+#endif
+
     if (fCopyOver) /* reload players */
         copyover_recover();
 
@@ -616,6 +659,10 @@ static void init_game(ush_int local_port)
     while (descriptor_list)
         close_socket(descriptor_list);
 
+#ifdef CIRCLE_NET_THREAD
+    netio_stop();
+#endif
+
     CLOSE_SOCKET(mother_desc);
 
     if (circle_reboot != 2)
@@ -804,6 +851,214 @@ static int get_max_players(void)
 #endif /* CIRCLE_UNIX */
 }
 
+/* Socket polling.  Descriptors that the poller reports as readable (or in an
+   error state) are kept on io_ready_list so game_loop() only visits sockets
+   with something to do, and IO_WRITE in d->io_events tells it whether output
+   can be flushed.  With epoll the registration is made once per connection
+   and readiness is edge-triggered: IO_READ stays set until process_input()
+   drains the socket, IO_WRITE until a write returns EAGAIN.  The select()
+   fallback rebuilds its fd_sets every pulse exactly like it always did. */
+static void io_init(socket_t mother)
+{
+#ifdef CIRCLE_EPOLL
+    struct epoll_event ev;
+    struct descriptor_data *d;
+
+    if (epoll_desc < 0 && (epoll_desc = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+        perror("SYSERR: epoll_create1");
+        exit(1);
+    }
+
+    /* The mother socket is level-triggered: new_descriptor() accepts one
+       connection per pulse and the rest stay pending in the backlog. */
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    if (epoll_ctl(epoll_desc, EPOLL_CTL_ADD, mother, &ev) < 0) {
+        perror("SYSERR: epoll_ctl mother");
+        exit(1);
+    }
+
+    /* Descriptors restored by copyover_recover() exist before we do. */
+    for (d = descriptor_list; d; d = d->next)
+        io_register(d);
+
+    log1("Using epoll for socket polling.");
+#else
+    log1("Using select for socket polling.");
+#endif
+}
+
+static void io_register(struct descriptor_data *d)
+{
+#ifdef CIRCLE_EPOLL
+    struct epoll_event ev;
+
+    if (epoll_desc < 0) /* Not up yet, io_init() will pick it up. */
+        return;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLPRI | EPOLLOUT | EPOLLET;
+    ev.data.ptr = d;
+    if (epoll_ctl(epoll_desc, EPOLL_CTL_ADD, d->descriptor, &ev) < 0 && errno != EEXIST) {
+        perror("SYSERR: epoll_ctl add");
+        STATE(d) = CON_CLOSE;
+        return;
+    }
+#endif
+    /* A freshly accepted socket can always take the greeting. */
+    d->io_events |= IO_WRITE;
+}
+
+static void io_unregister(struct descriptor_data *d)
+{
+    struct descriptor_data *temp;
+
+    if (d->io_queued) {
+        REMOVE_FROM_LIST(d, io_ready_list, io_next);
+        d->io_queued = FALSE;
+    }
+    d->io_events = 0;
+
+#ifdef CIRCLE_EPOLL
+    if (epoll_desc >= 0)
+        epoll_ctl(epoll_desc, EPOLL_CTL_DEL, d->descriptor, NULL);
+#endif
+}
+
+static void io_mark_ready(struct descriptor_data *d, int events)
+{
+    d->io_events |= events;
+
+    if ((events & (IO_READ | IO_ERROR)) && !d->io_queued) {
+        d->io_next = io_ready_list;
+        io_ready_list = d;
+        d->io_queued = TRUE;
+    }
+}
+
+static void io_clear_ready(struct descriptor_data *d, int events)
+{
+    struct descriptor_data *temp;
+
+    d->io_events &= ~events;
+
+    if (d->io_queued && !(d->io_events & (IO_READ | IO_ERROR))) {
+        REMOVE_FROM_LIST(d, io_ready_list, io_next);
+        d->io_queued = FALSE;
+    }
+}
+
+/* Block until the mother socket has a connection waiting (or a signal). */
+static void io_wait_for_connection(socket_t mother)
+{
+#ifdef CIRCLE_EPOLL
+    struct epoll_event ev;
+    int n;
+
+    /* Nothing else is registered while descriptor_list is empty. */
+    n = epoll_wait(epoll_desc, &ev, 1, -1);
+#else
+    fd_set input_set;
+    int n;
+
+    FD_ZERO(&input_set);
+    FD_SET(mother, &input_set);
+    n = select(mother + 1, &input_set, (fd_set *)0, (fd_set *)0, NULL);
+#endif
+
+    if (n < 0) {
+        if (errno == EINTR)
+            log1("Waking up to process signal.");
+        else
+            perror("SYSERR: Select coma");
+    } else
+        log1("New connection.  Waking up.");
+}
+
+/* Poll without blocking.  Returns 1 if the mother socket has a connection
+   waiting, 0 if not, or -1 on a fatal polling error. */
+static int io_poll(socket_t mother)
+{
+#ifdef CIRCLE_EPOLL
+    struct epoll_event events[MAX_IO_EVENTS];
+    int i, n, flags, mother_ready = 0;
+
+    do {
+        if ((n = epoll_wait(epoll_desc, events, MAX_IO_EVENTS, 0)) < 0) {
+            if (errno == EINTR)
+                break;
+            perror("SYSERR: epoll_wait poll");
+            return (-1);
+        }
+
+        for (i = 0; i < n; i++) {
+            if (events[i].data.ptr == NULL) {
+                mother_ready = 1;
+                continue;
+            }
+
+            flags = 0;
+            if (events[i].events & (EPOLLIN | EPOLLPRI))
+                flags |= IO_READ;
+            if (events[i].events & EPOLLOUT)
+                flags |= IO_WRITE;
+            if (events[i].events & (EPOLLERR | EPOLLHUP))
+                flags |= IO_ERROR;
+
+            io_mark_ready((struct descriptor_data *)events[i].data.ptr, flags);
+        }
+    } while (n == MAX_IO_EVENTS);
+
+    return (mother_ready);
+#else
+    fd_set input_set, output_set, exc_set;
+    struct descriptor_data *d;
+    socket_t maxdesc = mother;
+    int flags;
+
+    /* select() gives a fresh snapshot every pulse, forget the last one. */
+    while (io_ready_list)
+        io_clear_ready(io_ready_list, IO_READ | IO_WRITE | IO_ERROR);
+
+    /* Set up the input, output, and exception sets for select(). */
+    FD_ZERO(&input_set);
+    FD_ZERO(&output_set);
+    FD_ZERO(&exc_set);
+    FD_SET(mother, &input_set);
+
+    for (d = descriptor_list; d; d = d->next) {
+#    ifndef CIRCLE_WINDOWS
+        if (d->descriptor > maxdesc)
+            maxdesc = d->descriptor;
+#    endif
+        FD_SET(d->descriptor, &input_set);
+        FD_SET(d->descriptor, &output_set);
+        FD_SET(d->descriptor, &exc_set);
+    }
+
+    if (select(maxdesc + 1, &input_set, &output_set, &exc_set, &null_time) < 0) {
+        perror("SYSERR: Select poll");
+        return (-1);
+    }
+
+    for (d = descriptor_list; d; d = d->next) {
+        flags = 0;
+        if (FD_ISSET(d->descriptor, &input_set))
+            flags |= IO_READ;
+        if (FD_ISSET(d->descriptor, &output_set))
+            flags |= IO_WRITE;
+        if (FD_ISSET(d->descriptor, &exc_set))
+            flags |= IO_ERROR;
+
+        d->io_events = 0;
+        io_mark_ready(d, flags);
+    }
+
+    return (FD_ISSET(mother, &input_set) ? 1 : 0);
+#endif
+}
+
 /* game_loop contains the main loop which drives the entire MUD.  It cycles
    once every 0.10 seconds and is responsible for accepting new new
    connections, polling existing connections for input, dequeueing output and
@@ -811,19 +1066,19 @@ static int get_max_players(void)
    mobile_activity(). */
 void game_loop(socket_t local_mother_desc)
 {
-    fd_set input_set, output_set, exc_set, null_set;
     struct timeval last_time, opt_time, process_time, temp_time;
     struct timeval before_sleep, now, timeout;
     char comm[MAX_INPUT_LENGTH];
     struct descriptor_data *d, *next_d;
-    int missed_pulses, maxdesc, aliased;
+    int missed_pulses, aliased, mother_ready, result;
 
     /* initialize various time values */
     null_time.tv_sec = 0;
     null_time.tv_usec = 0;
     opt_time.tv_usec = OPT_USEC;
     opt_time.tv_sec = 0;
-    FD_ZERO(&null_set);
+
+    io_init(local_mother_desc);
 
     gettimeofday(&last_time, (struct timezone *)0);
 
@@ -833,33 +1088,9 @@ void game_loop(socket_t local_mother_desc)
         /* Sleep if we don't have any connections */
         if (descriptor_list == NULL) {
             log1("No connections.  Going to sleep.");
-            FD_ZERO(&input_set);
-            FD_SET(local_mother_desc, &input_set);
-            if (select(local_mother_desc + 1, &input_set, (fd_set *)0, (fd_set *)0, NULL) < 0) {
-                if (errno == EINTR)
-                    log1("Waking up to process signal.");
-                else
-                    perror("SYSERR: Select coma");
-            } else
-                log1("New connection.  Waking up.");
+            io_wait_for_connection(local_mother_desc);
             gettimeofday(&last_time, (struct timezone *)0);
         }
-        /* Set up the input, output, and exception sets for select(). */
-        FD_ZERO(&input_set);
-        FD_ZERO(&output_set);
-        FD_ZERO(&exc_set);
-        FD_SET(local_mother_desc, &input_set);
-
-        maxdesc = local_mother_desc;
-        for (d = descriptor_list; d; d = d->next) {
-#ifndef CIRCLE_WINDOWS
-            if (d->descriptor > maxdesc)
-                maxdesc = d->descriptor;
-#endif
-            FD_SET(d->descriptor, &input_set);
-            FD_SET(d->descriptor, &output_set);
-            FD_SET(d->descriptor, &exc_set);
-        }
 
         /* At this point, we have completed all input, output and heartbeat
            activity from the previous iteration, so we have to put ourselves
@@ -876,9 +1107,12 @@ void game_loop(socket_t local_mother_desc)
         } else {
             missed_pulses = process_time.tv_sec * PASSES_PER_SEC;
             missed_pulses += process_time.tv_usec / OPT_USEC;
+            pulse_overruns += missed_pulses;
             process_time.tv_sec = 0;
             process_time.tv_usec = process_time.tv_usec % OPT_USEC;
         }
+        perf_loop_done(missed_pulses, before_sleep.tv_sec * 1000000L + before_sleep.tv_usec -
+                                          (last_time.tv_sec * 1000000L + last_time.tv_usec));
 
         /* Calculate the time we should wake up */
         timediff(&temp_time, &opt_time, &process_time);
@@ -894,40 +1128,44 @@ void game_loop(socket_t local_mother_desc)
             gettimeofday(&now, (struct timezone *)0);
             timediff(&timeout, &last_time, &now);
         } while (timeout.tv_usec || timeout.tv_sec);
+        pass_start = now;
 
         /* Poll (without blocking) for new input, output, and exceptions */
-        if (select(maxdesc + 1, &input_set, &output_set, &exc_set, &null_time) < 0) {
-            perror("SYSERR: Select poll");
+        if ((mother_ready = io_poll(local_mother_desc)) < 0)
             return;
-        }
+
         /* If there are new connections waiting, accept them. */
-        if (FD_ISSET(local_mother_desc, &input_set))
+        if (mother_ready)
             new_descriptor(local_mother_desc);
 
-        /* Kick out the freaky folks in the exception set and marked for close
-         */
-        for (d = descriptor_list; d; d = next_d) {
-            next_d = d->next;
-            if (FD_ISSET(d->descriptor, &exc_set)) {
-                FD_CLR(d->descriptor, &input_set);
-                FD_CLR(d->descriptor, &output_set);
+        /* Kick out the freaky folks in the exception set.  Only descriptors
+           the poller reported as ready are on io_ready_list, so idle
+           connections cost nothing here. */
+        for (d = io_ready_list; d; d = next_d) {
+            next_d = d->io_next;
+            if (d->io_events & IO_ERROR)
                 close_socket(d);
-            }
         }
 
         /* Process descriptors with input pending */
-        for (d = descriptor_list; d; d = next_d) {
-            next_d = d->next;
-            if (FD_ISSET(d->descriptor, &input_set)) {
-                if (d->pProtocol != NULL)       /* KaVir's plugin */
-                    d->pProtocol->WriteOOB = 0; /* KaVir's plugin */
+        perf_begin(PERF_INPUT);
+        for (d = io_ready_list; d; d = next_d) {
+            next_d = d->io_next;
+            if (!(d->io_events & IO_READ))
+                continue;
 
-                if (process_input(d) < 0)
-                    close_socket(d);
-            }
+            if (d->pProtocol != NULL)       /* KaVir's plugin */
+                d->pProtocol->WriteOOB = 0; /* KaVir's plugin */
+
+            if ((result = process_input(d)) < 0)
+                close_socket(d);
+            else if (result == 0) /* Socket drained, wait for the next event. */
+                io_clear_ready(d, IO_READ);
         }
+        perf_end(PERF_INPUT);
 
         /* Process commands we just read from process_input */
+        perf_begin(PERF_COMMANDS);
         for (d = descriptor_list; d; d = next_d) {
             next_d = d->next;
 
@@ -981,17 +1219,26 @@ void game_loop(socket_t local_mother_desc)
             }
         }
 
+        perf_end(PERF_COMMANDS);
+
         /* Send queued output out to the operating system (ultimately to
            user). */
+        perf_begin(PERF_OUTPUT);
         for (d = descriptor_list; d; d = next_d) {
             next_d = d->next;
-            if (*(d->output) && FD_ISSET(d->descriptor, &output_set)) {
+            if (d->output.total && (d->conn || (d->io_events & IO_WRITE))) {
                 /* Output for this player is ready */
                 if (process_output(d) < 0)
                     close_socket(d);
                 else
                     d->has_prompt = 1;
             }
+#ifdef CIRCLE_NET_THREAD
+            else if (d->conn && netio_error(d->conn)) {
+                log1("SYSERR: Write to socket: %s", strerror(netio_error(d->conn)));
+                close_socket(d);
+            }
+#endif
         }
 
         /* Print prompts for other descriptors who had no other output */
@@ -1001,6 +1248,7 @@ void game_loop(socket_t local_mother_desc)
                 d->has_prompt = TRUE;
             }
         }
+        perf_end(PERF_OUTPUT);
 
         /* Kick out folks in the CON_CLOSE or CON_DISCONNECT state */
         for (d = descriptor_list; d; d = next_d) {
@@ -1009,6 +1257,13 @@ void game_loop(socket_t local_mother_desc)
                 close_socket(d);
         }
 
+#ifdef CIRCLE_NET_THREAD
+        /* Wake the network thread for everything handed over above and take
+           back the chunks it has finished writing. */
+        netio_wake();
+        buf_partial_sends += netio_reclaim(&chunk_pool);
+#endif
+
         /* Now, we execute as many pulses as necessary--just one if we haven't
            missed any pulses, or make up for lost time if we missed a few
            pulses by sleeping for too long. */
@@ -1025,9 +1280,13 @@ void game_loop(socket_t local_mother_desc)
             missed_pulses = 30 RL_SEC;
         }
 
-        /* Now execute the heartbeat functions */
-        while (missed_pulses--)
+        /* Now execute the heartbeat functions.  heartbeat() knows how many
+           more are to follow, and puts off what it can while catching up. */
+        while (missed_pulses--) {
+            pulses_behind = missed_pulses;
             heartbeat(++pulse);
+        }
+        pulses_behind = 0;
 
         /* Check for any signals we may have received. */
         if (reread_wizlist) {
@@ -1047,86 +1306,182 @@ void game_loop(socket_t local_mother_desc)
 void heartbeat(int heart_pulse)
 {
     static int mins_since_crashsave = 0;
+    bool autosave_due = FALSE;
 
+    perf_begin(PERF_EVENTS);
     event_process();
+    perf_end(PERF_EVENTS);
 
-    if (!(heart_pulse % PULSE_DG_SCRIPT))
+    if (!(heart_pulse % PULSE_DG_SCRIPT)) {
+        perf_begin(PERF_SCRIPTS);
         script_trigger_check();
+        perf_end(PERF_SCRIPTS);
+    }
 
     if (!(heart_pulse % PASSES_PER_SEC)) { /* EVERY second */
+        perf_begin(PERF_MSDP);
         msdp_update();
+        perf_end(PERF_MSDP);
         next_tick--;
     }
 
-    if (!(heart_pulse % PULSE_ZONE))
+    if (!(heart_pulse % PULSE_ZONE)) {
+        perf_begin(PERF_ZONES);
         zone_update();
+        perf_end(PERF_ZONES);
+    }
 
     if (!(heart_pulse % PULSE_IDLEPWD)) /* 15 seconds */
     {
+        perf_begin(PERF_MISC);
         check_idle_passwords();
+        perf_end(PERF_MISC);
     }
 
-    if (!(heart_pulse % PULSE_MOB_EMOTION)) /* 4 seconds */
+    if (run_deferrable(DEFER_EMOTION, !(heart_pulse % PULSE_MOB_EMOTION), PULSE_MOB_EMOTION)) { /* 4 seconds */
+        perf_begin(PERF_MOB_EMOTION);
         mob_emotion_activity();
+        perf_end(PERF_MOB_EMOTION);
+    }
 
-    if (!(heart_pulse % PULSE_MOBILE))
-        mobile_activity();
+    /* Every pulse runs one PULSE_MOBILE'th of the mobiles.  When this slice
+       comes round again before we have caught up, it only needs to run then. */
+    if (pulses_behind >= PULSE_MOBILE)
+        perf_skipped(PERF_MOBILES);
+    else {
+        perf_begin(PERF_MOBILES);
+        mobile_activity(heart_pulse % PULSE_MOBILE);
+        perf_end(PERF_MOBILES);
+    }
 
-    if (!(heart_pulse % PULSE_VIOLENCE))
+    if (!(heart_pulse % PULSE_VIOLENCE)) {
+        perf_begin(PERF_VIOLENCE);
         perform_violence();
+        perf_end(PERF_VIOLENCE);
+    }
 
     /* Auction system updates - runs every 30 seconds when enabled */
-    if (CONFIG_NEW_AUCTION_SYSTEM && !(heart_pulse % (30 * PASSES_PER_SEC))) { /* Every 30 seconds */
+    if (run_deferrable(DEFER_AUCTIONS, CONFIG_NEW_AUCTION_SYSTEM && !(heart_pulse % (30 * PASSES_PER_SEC)),
+                       30 * PASSES_PER_SEC)) { /* Every 30 seconds */
+        perf_begin(PERF_AUCTIONS);
         update_auctions();
+        perf_end(PERF_AUCTIONS);
+    }
 
-        /* Save auctions every 5 minutes */
-        if (!(heart_pulse % (300 * PASSES_PER_SEC))) {
-            save_auctions();
-        }
+    /* Save auctions every 5 minutes */
+    if (run_deferrable(DEFER_AUCTION_SAVE, CONFIG_NEW_AUCTION_SYSTEM && !(heart_pulse % (300 * PASSES_PER_SEC)),
+                       300 * PASSES_PER_SEC)) {
+        perf_begin(PERF_AUCTIONS);
+        save_auctions();
+        perf_end(PERF_AUCTIONS);
     }
 
     if (!(heart_pulse % (SECS_PER_MUD_HOUR / 3))) {
+        perf_begin(PERF_WEATHER);
         beware_lightning();
+        perf_end(PERF_WEATHER);
     }
 
     if (!(heart_pulse % (SECS_PER_MUD_HOUR * PASSES_PER_SEC))) { /* Tick ! */
         next_tick = SECS_PER_MUD_HOUR;                           /* Reset tick coundown */
+        perf_begin(PERF_WEATHER);
         weather_and_time(1);
+        perf_end(PERF_WEATHER);
+        perf_begin(PERF_TIME_TRIGS);
         check_time_triggers();
+        perf_end(PERF_TIME_TRIGS);
+        perf_begin(PERF_AFFECTS);
         affect_update();
+        perf_end(PERF_AFFECTS);
+        perf_begin(PERF_POINTS);
         point_update();
+        perf_end(PERF_POINTS);
+        perf_begin(PERF_QUESTS);
         check_timed_quests();
+        perf_end(PERF_QUESTS);
     }
 
-    if (CONFIG_AUTO_SAVE && !(heart_pulse % PULSE_AUTOSAVE)) { /* 1 minute */
-        if (++mins_since_crashsave >= CONFIG_AUTOSAVE_TIME) {
-            mins_since_crashsave = 0;
-            Crash_save_all();
-            House_save_all();
-            /* Removed save_temp_quest_assignments() to reduce lag - only save on shutdown */
-        }
+    if (CONFIG_AUTO_SAVE && !(heart_pulse % PULSE_AUTOSAVE)) /* 1 minute */
+        autosave_due = (++mins_since_crashsave >= CONFIG_AUTOSAVE_TIME);
+    if (run_deferrable(DEFER_AUTOSAVE, autosave_due, PULSE_AUTOSAVE * MAX(1, CONFIG_AUTOSAVE_TIME))) {
+        mins_since_crashsave = 0;
+        perf_begin(PERF_AUTOSAVE);
+        Crash_save_all();
+        House_save_all();
+        perf_end(PERF_AUTOSAVE);
+        /* Removed save_temp_quest_assignments() to reduce lag - only save on shutdown */
     }
 
-    if (!(heart_pulse % PULSE_USAGE))
+    if (!(heart_pulse % PULSE_USAGE)) {
+        perf_begin(PERF_MISC);
         record_usage();
+        perf_end(PERF_MISC);
+    }
 
-    if (!(heart_pulse % PULSE_TIMESAVE))
+    if (!(heart_pulse % PULSE_TIMESAVE)) {
+        perf_begin(PERF_MISC);
         save_mud_time(&time_info);
+        perf_end(PERF_MISC);
+    }
 
     /* Every pulse! Don't want them to stink the place up... */
+    perf_begin(PERF_EXTRACT);
     extract_pending_chars();
+    perf_end(PERF_EXTRACT);
 
     /* Process deferred group cleanups to avoid blocking main loop during normal gameplay */
-    /* Use adaptive frequency: every 3 seconds normally, but more frequently when list is large */
-    if (needs_frequent_group_cleanup()) {
-        if (!(heart_pulse % PASSES_PER_SEC)) { /* Every 1 second when cleanup is needed */
-            process_deferred_cleanups();
-        }
-    } else {
-        if (!(heart_pulse % (2 * PASSES_PER_SEC))) { /* Every 2 seconds normally (improved from 3) */
-            process_deferred_cleanups();
+    /* Use adaptive frequency: every 1 second when the list is large, every 2 seconds normally */
+    if (run_deferrable(DEFER_CLEANUPS, !(heart_pulse % ((needs_frequent_group_cleanup() ? 1 : 2) * PASSES_PER_SEC)),
+                       2 * PASSES_PER_SEC)) {
+        perf_begin(PERF_CLEANUPS);
+        process_deferred_cleanups();
+        perf_end(PERF_CLEANUPS);
+    }
+}
+
+/* Is this pulse short of time?  It is when more pulses are waiting to be
+   caught up on, or when this pass of the game loop has used up its budget. */
+static bool heartbeat_behind(void)
+{
+    struct timeval now, spent;
+
+    if (pulses_behind > 0)
+        return (TRUE);
+
+    gettimeofday(&now, (struct timezone *)0);
+    timediff(&spent, &now, &pass_start);
+
+    return (spent.tv_sec > 0 || spent.tv_usec > PULSE_BUDGET_USEC);
+}
+
+/* Decides whether a deferrable job runs on this pulse.  A job that comes due
+   while the pulse is short of time is put off until a pulse that isn't; if it
+   comes due again in the meantime, the two runs are merged into one.  Under
+   sustained load there may never be such a pulse, so a job that has waited
+   max_delay pulses (one period of the job) runs anyway. */
+static bool run_deferrable(int job, bool due, int max_delay)
+{
+    bool pending = IS_SET(deferred_jobs, 1 << job);
+
+    if (!due && !pending)
+        return (FALSE);
+    if (due && pending)
+        perf_deferred(job, TRUE);
+
+    if (heartbeat_behind()) {
+        if (!pending) {
+            perf_deferred(job, FALSE);
+            deferred_since[job] = pulse;
+            SET_BIT(deferred_jobs, 1 << job);
+            return (FALSE);
         }
+        if (pulse - deferred_since[job] < (unsigned long)max_delay)
+            return (FALSE);
+        perf_forced(job);
     }
+
+    REMOVE_BIT(deferred_jobs, 1 << job);
+    return (TRUE);
 }
 
 /* new code to calculate time differences, which works on systems for which
@@ -1412,10 +1767,6 @@ static int get_from_q(struct txt_q *queue, char *dest, int *aliased)
 /* Empty the queues before closing connection */
 static void flush_queues(struct descriptor_data *d)
 {
-    if (d->large_outbuf) {
-        d->large_outbuf->next = bufpool;
-        bufpool = d->large_outbuf;
-    }
     while (d->input.head) {
         struct txt_block *tmp = d->input.head;
         d->input.head = d->input.head->next;
@@ -1437,95 +1788,201 @@ size_t write_to_output(struct descriptor_data *t, const char *txt, ...)
     return left;
 }
 
-/* Add a new string to a player's output queue. */
+/* Add a new string to a player's output queue.  The text is formatted and
+   run through the protocol plugin once, then appended to the descriptor's
+   output chunks; process_output() hands those chunks to the kernel as they
+   are.  Returns the number of bytes queued. */
 size_t vwrite_to_output(struct descriptor_data *t, const char *format, va_list args)
 {
-    const char *text_overflow = "\r\nOVERFLOW\r\n";
-    char txt[MAX_STRING_LENGTH];
+    char txt[MAX_STRING_LENGTH], *text = txt;
+    va_list args_copy;
     size_t wantsize;
     int size;
 
     /* if we're in the overflow state already, ignore this new output */
-    if (t->bufspace == 0)
+    if (t->output.overflow)
         return (0);
 
-    wantsize = size = vsnprintf(txt, sizeof(txt), format, args);
+    va_copy(args_copy, args);
+    size = vsnprintf(txt, sizeof(txt), format, args);
 
-    /* Use a temporary buffer for protocol processing to avoid self-modifying strcpy */
-    {
-        char protocol_buf[MAX_STRING_LENGTH];
-        ProtocolOutputToBuffer(t, txt, protocol_buf, sizeof(protocol_buf), (int *)&wantsize);
-        strncpy(txt, protocol_buf, sizeof(txt) - 1);
-        txt[sizeof(txt) - 1] = '\0';
+    if (size < 0) {
+        va_end(args_copy);
+        return (0);
+    }
+
+    /* Long pages (look, who, map, ...) get a buffer of their own instead of
+       being truncated. */
+    if ((size_t)size >= sizeof(txt)) {
+        CREATE(text, char, size + 1);
+        vsnprintf(text, size + 1, format, args_copy);
+    }
+    va_end(args_copy);
+
+    wantsize = output_translate(t, text, size);
+
+    if (text != txt)
+        free(text);
+
+    return (wantsize);
+}
+
+/* Run already formatted text through the protocol plugin and queue it. */
+static size_t output_translate(struct descriptor_data *t, const char *text, int size)
+{
+    char protocol_buf[MAX_STRING_LENGTH], *translated = protocol_buf;
+    size_t translated_size = sizeof(protocol_buf);
+    int wantsize = size;
+
+    /* Colour codes expand when translated, leave them plenty of room. */
+    if ((size_t)size >= sizeof(protocol_buf)) {
+        translated_size = (size + 1) * 4;
+        CREATE(translated, char, translated_size);
     }
-    size = wantsize;
+
+    ProtocolOutputToBuffer(t, text, translated, translated_size, &wantsize);
     if (t->pProtocol->WriteOOB > 0)
         --t->pProtocol->WriteOOB;
 
-    /* If exceeding the size of the buffer, truncate it for the overflow
-       message */
-    if (size < 0 || wantsize >= sizeof(txt)) {
-        size = sizeof(txt) - 1;
-        strcpy(txt + size - strlen(text_overflow),
-               text_overflow); /* strcpy:
-                                                                                          OK */
-    }
-
-    /* If the text is too big to fit into even a large buffer, truncate the
-       new text to make it fit.  (This will switch to the overflow state
-       automatically because t->bufspace will end up 0.) */
-    if (size + t->bufptr + 1 > LARGE_BUFSIZE) {
-        size = LARGE_BUFSIZE - t->bufptr - 1;
-        txt[size] = '\0';
+    output_append(t, translated, wantsize);
+
+    if (translated != protocol_buf)
+        free(translated);
+
+    return (wantsize);
+}
+
+/* Append already translated text to the tail of the output queue, taking
+   chunks from the pool as needed. */
+static void output_append(struct descriptor_data *t, const char *txt, size_t len)
+{
+    struct out_queue *q = &t->output;
+    struct out_chunk *chunk;
+    size_t n;
+
+    if (q->overflow || len == 0)
+        return;
+
+    /* A client that stops reading should not be able to eat all our memory. */
+    if (OUTPUT_BACKLOG(t) + len > MAX_OUTPUT_BACKLOG) {
+        q->overflow = TRUE;
         buf_overflows++;
+        return;
     }
 
-    /* If we have enough space, just write to buffer and that's it! If the
-       text just barely fits, then it's switched to a large buffer instead. */
-    if (t->bufspace > size) {
-        strcpy(t->output + t->bufptr, txt); /* strcpy: OK (size checked above)
-                                             */
-        t->bufspace -= size;
-        t->bufptr += size;
-        return (t->bufspace);
+    while (len > 0) {
+        /* Compressed and plain text never share a chunk. */
+        if (!q->tail || q->tail->len == OUTPUT_CHUNK_SIZE || q->tail->compressed != q->compress) {
+            chunk = chunk_get();
+            chunk->compressed = q->compress;
+            if (q->tail)
+                q->tail->next = chunk;
+            else
+                q->head = chunk;
+            q->tail = chunk;
+        }
+
+        n = MIN(len, OUTPUT_CHUNK_SIZE - q->tail->len);
+        memcpy(q->tail->data + q->tail->len, txt, n);
+        q->tail->len += n;
+        q->total += n;
+        txt += n;
+        len -= n;
     }
+}
+
+/* Drop 'len' bytes from the front of the output queue after they have been
+   sent.  Fully sent chunks go back to the pool; a partly sent one just moves
+   the cursor. */
+static void output_consume(struct descriptor_data *t, size_t len)
+{
+    struct out_queue *q = &t->output;
+    struct out_chunk *chunk;
+    size_t n;
 
-    buf_switches++;
+    while (len > 0 && q->head) {
+        chunk = q->head;
+        n = MIN(len, chunk->len - q->cursor);
 
-    /* if the pool has a buffer in it, grab it */
-    if (bufpool != NULL) {
-        t->large_outbuf = bufpool;
-        bufpool = bufpool->next;
-    } else { /* else create a new one */
-        CREATE(t->large_outbuf, struct txt_block, 1);
-        CREATE(t->large_outbuf->text, char, LARGE_BUFSIZE);
-        buf_largecount++;
+        /* Handle snooping: prepend "% " and send to snooper. */
+        if (t->snoop_by)
+            write_to_output(t->snoop_by, "%% %.*s%%%%", (int)n, chunk->data + q->cursor);
+
+        q->cursor += n;
+        q->total -= n;
+        len -= n;
+
+        if (q->cursor == chunk->len) {
+            q->head = chunk->next;
+            if (!q->head)
+                q->tail = NULL;
+            q->cursor = 0;
+            chunk->next = chunk_pool;
+            chunk_pool = chunk;
+        }
     }
+}
 
-    strcpy(t->large_outbuf->text, t->output); /* strcpy: OK (size checked
-                                                                                         previously) */
-    t->output = t->large_outbuf->text;        /* make big buffer primary */
-    strcat(t->output, txt);                   /* strcat: OK (size checked) */
+/* Can output to this descriptor be MCCP compressed?  The compressing is done
+   by the network threads, next to the socket writes. */
+bool output_compress_ok(struct descriptor_data *t)
+{
+#ifdef CIRCLE_NET_THREAD
+    return (t->conn != NULL);
+#else
+    return (FALSE);
+#endif
+}
 
-    /* set the pointer for the next write */
-    t->bufptr = strlen(t->output);
+/* Compress everything queued for this descriptor from here on, or stop.  The
+   network thread starts the zlib stream at the first compressed byte and
+   finishes it at the first plain one. */
+void output_compress(struct descriptor_data *t, bool on)
+{
+    t->output.compress = on && output_compress_ok(t);
+}
 
-    /* calculate how much space is left in the buffer */
-    t->bufspace = LARGE_BUFSIZE - 1 - t->bufptr;
+/* Throw away everything still queued for a descriptor. */
+static void output_clear(struct descriptor_data *t)
+{
+    struct out_queue *q = &t->output;
 
-    return (t->bufspace);
+    if (q->tail) {
+        q->tail->next = chunk_pool;
+        chunk_pool = q->head;
+    }
+    q->head = q->tail = NULL;
+    q->cursor = q->total = 0;
+    q->overflow = FALSE;
 }
 
-static void free_bufpool(void)
+/* Take an empty chunk from the pool, allocating one if it has run dry. */
+static struct out_chunk *chunk_get(void)
 {
-    struct txt_block *tmp;
+    struct out_chunk *chunk;
+
+    if (chunk_pool != NULL) {
+        chunk = chunk_pool;
+        chunk_pool = chunk_pool->next;
+    } else {
+        CREATE(chunk, struct out_chunk, 1);
+        buf_chunkcount++;
+    }
+    chunk->next = NULL;
+    chunk->len = 0;
+    chunk->compressed = FALSE;
 
-    while (bufpool) {
-        tmp = bufpool->next;
-        if (bufpool->text)
-            free(bufpool->text);
-        free(bufpool);
-        bufpool = tmp;
+    return (chunk);
+}
+
+static void free_chunk_pool(void)
+{
+    struct out_chunk *tmp;
+
+    while (chunk_pool) {
+        tmp = chunk_pool->next;
+        free(chunk_pool);
+        chunk_pool = tmp;
     }
 }
 
@@ -1615,11 +2072,7 @@ static void init_descriptor(struct descriptor_data *newd, int desc)
 
     newd->descriptor = desc;
     newd->idle_tics = 0;
-    newd->output = newd->small_outbuf;
-    newd->bufspace = SMALL_BUFSIZE - 1;
     newd->login_time = time(0);
-    *newd->output = '\0';
-    newd->bufptr = 0;
     newd->has_prompt = 1; /* prompt is part of greetings */
     STATE(newd) = CONFIG_PROTOCOL_NEGOTIATION ? CON_GET_PROTOCOL : CON_GET_NAME;
     CREATE(newd->history, char *, HISTORY_SIZE);
@@ -1627,11 +2080,17 @@ static void init_descriptor(struct descriptor_data *newd, int desc)
         last_desc = 1;
     newd->desc_num = last_desc;
     newd->pProtocol = ProtocolCreate(); /* KaVir's plugin */
+    newd->msdp_dirty = MSDP_DIRTY_ALL;
     newd->events = create_list();
 
     /* Initialize quest confirmation fields */
     newd->pending_quest_vnum = NOTHING;
     newd->pending_questmaster = NULL;
+
+    io_register(newd);
+#ifdef CIRCLE_NET_THREAD
+    newd->conn = netio_open(desc);
+#endif
 }
 
 static int new_descriptor(socket_t s)
@@ -1720,93 +2179,197 @@ static int new_descriptor(socket_t s)
     return (0);
 }
 
-/* Send all of the output that we've accumulated for a player out to the
-   player's descriptor. 32 byte GARBAGE_SPACE in MAX_SOCK_BUF used for: 2
-   bytes: prepended \r\n 14 bytes: overflow message 2 bytes: extra \r\n for
-   non-comapct 14 bytes: unused */
-static int process_output(struct descriptor_data *t)
+/* Fill 'iov' with what follows a complete send: the overflow notice, the
+   extra CRLF for non-compact mode and the prompt (translated into 'prompt').
+   Returns the number of vectors used, at most 3. */
+static int output_trailers(struct descriptor_data *t, struct iovec *iov, char *prompt, size_t prompt_size)
 {
-    char i[MAX_SOCK_BUF], *osb = i + 2;
-    int result;
-
-    /* we may need this \r\n for later -- see below */
-    strcpy(i, "\r\n"); /* strcpy: OK (for 'MAX_SOCK_BUF >= 3') */
-
-    /* now, append the 'real' output */
-    strcpy(osb, t->output); /* strcpy: OK (t->output:LARGE_BUFSIZE <
-                                                       osb:MAX_SOCK_BUF-2) */
+    static const char crlf[] = "\r\n";
+    static const char overflow_msg[] = "**OVERFLOW**\r\n";
+    int iovcnt = 0, prompt_len = 0;
 
     /* if we're in the overflow state, notify the user */
-    if (t->bufspace == 0)
-        strcat(osb, "**OVERFLOW**\r\n"); /* strcpy: OK (osb:MAX_SOCK_BUF-2
-                                                                            reserves space) */
+    if (t->output.overflow) {
+        iov[iovcnt].iov_base = (void *)overflow_msg;
+        iov[iovcnt++].iov_len = sizeof(overflow_msg) - 1;
+    }
 
     /* add the extra CRLF if the person isn't in compact mode */
-    if (STATE(t) == CON_PLAYING && t->character && !IS_NPC(t->character) && !PRF_FLAGGED(t->character, PRF_COMPACT))
-        if (!t->pProtocol->WriteOOB)
-            strcat(osb, "\r\n"); /* strcpy: OK (osb:MAX_SOCK_BUF-2 reserves
-                                                            space) */
+    if (STATE(t) == CON_PLAYING && t->character && !IS_NPC(t->character) && !PRF_FLAGGED(t->character, PRF_COMPACT) &&
+        !t->pProtocol->WriteOOB) {
+        iov[iovcnt].iov_base = (void *)crlf;
+        iov[iovcnt++].iov_len = 2;
+    }
 
-    if (!t->pProtocol->WriteOOB)   /* add a prompt */
-        strcat(i, make_prompt(t)); /* strcpy: OK (i:MAX_SOCK_BUF reserves
-                                                              space) */
+    /* add a prompt */
+    if (!t->pProtocol->WriteOOB) {
+        ProtocolOutputToBuffer(t, make_prompt(t), prompt, prompt_size, &prompt_len);
+        if (prompt_len > 0) {
+            iov[iovcnt].iov_base = prompt;
+            iov[iovcnt++].iov_len = prompt_len;
+        }
+    }
+
+    return (iovcnt);
+}
+
+/* Send all of the output that we've accumulated for a player out to the
+   player's descriptor.  The queued chunks, the overflow notice, the extra
+   CRLF for non-compact mode and the prompt each go out as their own vector
+   in a single writev(), so nothing is copied into a staging buffer.  When
+   the network thread is running the chunks are handed to it instead. */
+static int process_output(struct descriptor_data *t)
+{
+    static const char crlf[] = "\r\n";
+    struct iovec iov[MAX_OUTPUT_IOV + 4];
+    struct out_chunk *chunk;
+    char prompt[MAX_PROMPT_LENGTH * 4];
+    int iovcnt = 0, first_trailer, i, complete;
+    size_t queued = 0, lead = 0;
+    ssize_t result;
 
-    /* now, send the output.  If this is an 'interruption', use the prepended
-       CRLF, otherwise send the straight output sans CRLF. */
+#ifdef CIRCLE_NET_THREAD
+    if (t->conn)
+        return (output_handoff(t, TRUE));
+#endif
+
+    /* If this is an 'interruption', prepend a CRLF. */
     if (t->has_prompt && !t->pProtocol->WriteOOB) {
         t->has_prompt = FALSE;
+        iov[iovcnt].iov_base = (void *)crlf;
+        iov[iovcnt++].iov_len = lead = 2;
+    }
 
-        result = write_to_descriptor(t->descriptor, i);
-        if (result >= 2)
-            result -= 2;
-    } else
-        result = write_to_descriptor(t->descriptor, osb);
+    /* now, the 'real' output */
+    for (chunk = t->output.head; chunk && iovcnt < MAX_OUTPUT_IOV; chunk = chunk->next) {
+        size_t offset = (chunk == t->output.head) ? t->output.cursor : 0;
+
+        iov[iovcnt].iov_base = chunk->data + offset;
+        iov[iovcnt++].iov_len = chunk->len - offset;
+        queued += chunk->len - offset;
+    }
+    complete = (chunk == NULL);
+    first_trailer = iovcnt;
+
+    /* The trailers only go out once the whole queue fits in this send. */
+    if (complete)
+        iovcnt += output_trailers(t, iov + iovcnt, prompt, sizeof(prompt));
+
+    result = perform_socket_writev(t->descriptor, iov, iovcnt);
 
     if (result < 0) { /* Oops, fatal error. Bye! */
-                      //	close_socket(t); // close_socket is called after return of negative result
+        perror("SYSERR: Write to socket");
         return (-1);
-    } else if (result == 0) /* Socket buffer full. Try later. */
+    } else if (result == 0) { /* Socket buffer full. Try later. */
+        t->io_events &= ~IO_WRITE;
         return (0);
+    }
 
-    /* Handle snooping: prepend "% " and send to snooper. */
-    if (t->snoop_by)
-        write_to_output(t->snoop_by, "%% %*s%%%%", result, t->output);
+    /* The leading CRLF is not part of the queue. */
+    result = (result > (ssize_t)lead) ? result - lead : 0;
 
-    /* The common case: all saved output was handed off to the kernel buffer. */
-    if (result >= t->bufptr) {
-        /* If we were using a large buffer, put the large buffer on the buffer
-           pool and switch back to the small one. */
-        if (t->large_outbuf) {
-            t->large_outbuf->next = bufpool;
-            bufpool = t->large_outbuf;
-            t->large_outbuf = NULL;
-            t->output = t->small_outbuf;
+    if ((size_t)result < queued) {
+        /* Not all data in the queue was sent, just move the cursor. */
+        buf_partial_sends++;
+        output_consume(t, result);
+        return (result);
+    }
+
+    /* The common case: all saved output was handed off to the kernel. */
+    output_consume(t, queued);
+    if (complete)
+        t->output.overflow = FALSE;
+
+    /* If the overflow message or prompt were partially written, save the
+       rest for the next pass. */
+    result -= queued;
+    for (i = first_trailer; i < iovcnt; i++) {
+        if ((size_t)result >= iov[i].iov_len) {
+            result -= iov[i].iov_len;
+            continue;
         }
-        /* reset total bufspace back to that of a small buffer */
-        t->bufspace = SMALL_BUFSIZE - 1;
-        t->bufptr = 0;
-        *(t->output) = '\0';
+        output_append(t, (char *)iov[i].iov_base + result, iov[i].iov_len - result);
+        result = 0;
+    }
+
+    return (queued);
+}
+
+#ifdef CIRCLE_NET_THREAD
+/* Hand a descriptor's queued output to the network thread.  With 'framed' it
+   gets the same leading CRLF and trailers process_output() would have sent;
+   write_to_descriptor() passes FALSE to send its text as it is.  Returns the
+   number of queued bytes handed over, or -1 if the connection has failed. */
+static int output_handoff(struct descriptor_data *t, bool framed)
+{
+    struct out_queue *q = &t->output;
+    struct out_chunk *chunk;
+    struct iovec iov[3];
+    char prompt[MAX_PROMPT_LENGTH * 4];
+    int i, n, needed = 0, reserve, complete, err;
+    size_t handed = 0;
+
+    if ((err = netio_error(t->conn)) != 0) {
+        log1("SYSERR: Write to socket: %s", strerror(err));
+        return (-1);
+    }
+
+    /* Is there room for the whole queue, a leading CRLF and the trailers? */
+    for (chunk = q->head; chunk; chunk = chunk->next)
+        needed++;
+    complete = (needed + 4 <= netio_space(t->conn));
+    reserve = (framed && complete) ? 3 : 0;
 
-        /* If the overflow message or prompt were partially written, try to
-           save them. There will be enough space for them if this is true.
-           'result' is effectively unsigned here anyway. */
-        if ((unsigned int)result < strlen(osb)) {
-            size_t savetextlen = strlen(osb + result);
+    /* If this is an 'interruption', prepend a CRLF. */
+    if (framed && t->has_prompt && !t->pProtocol->WriteOOB && netio_space(t->conn) > reserve) {
+        t->has_prompt = FALSE;
+        output_push_copy(t, "\r\n", 2);
+    }
 
-            strcat(t->output, osb + result);
-            t->bufptr -= savetextlen;
-            t->bufspace += savetextlen;
+    while (q->head && netio_space(t->conn) > reserve) {
+        chunk = q->head;
+        if ((q->head = chunk->next) == NULL)
+            q->tail = NULL;
+        chunk->next = NULL;
+
+        /* Only left over from before the thread started. */
+        if (q->cursor) {
+            chunk->len -= q->cursor;
+            memmove(chunk->data, chunk->data + q->cursor, chunk->len);
+            q->cursor = 0;
         }
 
-    } else {
-        /* Not all data in buffer sent.  result < output buffersize. */
-        strcpy(t->output, t->output + result); /* strcpy: OK (overlap) */
-        t->bufptr -= result;
-        t->bufspace += result;
+        /* Handle snooping: prepend "% " and send to snooper. */
+        if (t->snoop_by)
+            write_to_output(t->snoop_by, "%% %.*s%%%%", (int)chunk->len, chunk->data);
+
+        q->total -= chunk->len;
+        handed += chunk->len;
+        netio_push(t->conn, chunk);
     }
 
-    return (result);
+    if (framed && complete) {
+        n = output_trailers(t, iov, prompt, sizeof(prompt));
+        for (i = 0; i < n; i++)
+            output_push_copy(t, iov[i].iov_base, iov[i].iov_len);
+        q->overflow = FALSE;
+    }
+
+    return (handed);
+}
+
+/* Copy a short piece of text (a CRLF, the prompt) into a chunk of its own and
+   hand it to the network thread. */
+static void output_push_copy(struct descriptor_data *t, const char *txt, size_t len)
+{
+    struct out_chunk *chunk = chunk_get();
+
+    chunk->len = MIN(len, OUTPUT_CHUNK_SIZE);
+    chunk->compressed = t->output.compress;
+    memcpy(chunk->data, txt, chunk->len);
+    netio_push(t->conn, chunk);
 }
+#endif /* CIRCLE_NET_THREAD */
 
 /* perform_socket_write: takes a descriptor, a pointer to text, and a text
    length, and tries once to send that text to the OS.  This is where we stuff
@@ -1894,6 +2457,57 @@ static ssize_t perform_socket_write(socket_t desc, const char *txt, size_t lengt
 }
 #endif /* CIRCLE_WINDOWS */
 
+/* perform_socket_writev: same contract as perform_socket_write(), but sends a
+   whole vector of buffers in one call where the platform has writev(). */
+#if defined(HAVE_SYS_UIO_H) && !defined(CIRCLE_WINDOWS)
+static ssize_t perform_socket_writev(socket_t desc, struct iovec *iov, int iovcnt)
+{
+    ssize_t result;
+
+    result = writev(desc, iov, iovcnt);
+
+    if (result > 0)
+        return (result);
+
+    if (result == 0) {
+        /* This should never happen! */
+        log1("SYSERR: Huh??  writev() returned 0???  Please report this!");
+        return (-1);
+    }
+
+#    ifdef EAGAIN /* POSIX */
+    if (errno == EAGAIN)
+        return (0);
+#    endif
+
+#    ifdef EWOULDBLOCK /* BSD */
+    if (errno == EWOULDBLOCK)
+        return (0);
+#    endif
+
+    /* Looks like the error was fatal.  Too bad. */
+    return (-1);
+}
+#else
+static ssize_t perform_socket_writev(socket_t desc, struct iovec *iov, int iovcnt)
+{
+    ssize_t result, total = 0;
+    int i;
+
+    for (i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len == 0)
+            continue;
+        if ((result = perform_socket_write(desc, iov[i].iov_base, iov[i].iov_len)) < 0)
+            return (total ? total : -1);
+        total += result;
+        if ((size_t)result < iov[i].iov_len)
+            break;
+    }
+
+    return (total);
+}
+#endif
+
 /* write_to_descriptor takes a descriptor, and text to write to the
    descriptor. It keeps calling the system-level write() until all the text
    has been delivered to the OS, or until an error is encountered. Returns:
@@ -1932,6 +2546,14 @@ int write_to_descriptor(socket_t desc, const char *txt)
     ProtocolOutputToBuffer(d, txt, buffer, sizeof(buffer), &wantsize);
     total = strlen(buffer);
 
+#ifdef CIRCLE_NET_THREAD
+    /* Go through the network thread so this stays in order with the rest. */
+    if (d->conn) {
+        output_append(d, buffer, total);
+        return (output_handoff(d, FALSE) < 0 ? -1 : (int)total);
+    }
+#endif
+
     /* Send the processed text to the client */
     while (total > 0) {
         bytes_written = perform_socket_write(desc, buffer + write_total, total);
@@ -1941,6 +2563,7 @@ int write_to_descriptor(socket_t desc, const char *txt)
             return -1; /* Fatal error, disconnect client */
         } else if (bytes_written == 0) {
             /* Temporary failure (buffer full), try again later */
+            d->io_events &= ~IO_WRITE;
             return write_total;
         } else {
             total -= bytes_written;
@@ -2052,9 +2675,15 @@ static int process_input(struct descriptor_data *t)
         /* Since we have recieved atleast 1 byte of data from the socket, lets
            run it through ProtocolInput() and rip out anything that is Out Of
            Band */
-        if (bytes_read > 0)
+        if (bytes_read > 0) {
             bytes_read = ProtocolInput(t, read_buf, bytes_read, t->inbuf);
 
+            /* Nothing but telnet negotiation: keep reading, an edge-triggered
+               poller will not tell us about data that is already waiting. */
+            if (bytes_read == 0)
+                continue;
+        }
+
         if (bytes_read < 0) /* Error, disconnect them. */
             return (-1);
         else if (bytes_read == 0) /* Just blocking, no problems. */
@@ -2296,8 +2925,17 @@ void close_socket(struct descriptor_data *d)
     struct descriptor_data *temp;
 
     REMOVE_FROM_LIST(d, descriptor_list, next);
+    io_unregister(d);
+#ifdef CIRCLE_NET_THREAD
+    if (d->conn) /* The network thread closes it once it is done with it. */
+        netio_close(d->conn);
+    else
+        CLOSE_SOCKET(d->descriptor);
+#else
     CLOSE_SOCKET(d->descriptor);
+#endif
     flush_queues(d);
+    output_clear(d);
 
     /* Forget snooping */
     if (d->snooping)
@@ -2311,6 +2949,7 @@ void close_socket(struct descriptor_data *d)
     if (d->character) {
         /* If we're switched, this resets the mobile taken. */
         d->character->desc = NULL;
+        update_zone_presence(d->character);
 
         /* Plug memory leak, from Eric Green. */
         if (!IS_NPC(d->character) && PLR_FLAGGED(d->character, PLR_MAILING) && d->str) {
@@ -2342,8 +2981,10 @@ void close_socket(struct descriptor_data *d)
         mudlog(CMP, LVL_IMMORT, TRUE, "Losing descriptor without char.");
 
     /* JE 2/22/95 -- part of my unending quest to make switch stable */
-    if (d->original && d->original->desc)
+    if (d->original && d->original->desc) {
         d->original->desc = NULL;
+        update_zone_presence(d->original);
+    }
 
     /* Clear the command history. */
     if (d->history) {
@@ -2642,23 +3283,24 @@ static void signal_setup(void)
 void game_info(const char *format, ...)
 {
     struct descriptor_data *i;
+    struct broadcast b;
     va_list args;
     char messg[MAX_STRING_LENGTH];
     if (format == NULL)
         return;
-    sprintf(messg, "\tcInfo: \ty");
+    va_start(args, format);
+    vsnprintf(messg, sizeof(messg), format, args);
+    va_end(args);
+    broadcast_init(&b, "\tcInfo: \ty%s\tn\r\n", messg);
     for (i = descriptor_list; i; i = i->next) {
         if (STATE(i) != CON_PLAYING)
             continue;
         if (!(i->character))
             continue;
 
-        write_to_output(i, "%s", messg);
-        va_start(args, format);
-        vwrite_to_output(i, format, args);
-        va_end(args);
-        write_to_output(i, "\tn\r\n");
+        broadcast_send(&b, i);
     }
+    broadcast_free(&b);
 }
 
 size_t send_to_char(struct char_data *ch, const char *messg, ...)
@@ -2675,32 +3317,129 @@ size_t send_to_char(struct char_data *ch, const char *messg, ...)
     return 0;
 }
 
+/* Broadcasts.  A message going to many descriptors is formatted once, and
+   translated by the protocol plugin once for each output class (colour mode,
+   UTF-8, MSP, ...) among its recipients.  Every other recipient of the same
+   class just gets the translated bytes appended to its queue. */
+void broadcast_init(struct broadcast *b, const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    vbroadcast_init(b, format, args);
+    va_end(args);
+}
+
+void vbroadcast_init(struct broadcast *b, const char *format, va_list args)
+{
+    char txt[MAX_STRING_LENGTH];
+    va_list args_copy;
+    int size;
+
+    memset(b, 0, sizeof(*b));
+
+    va_copy(args_copy, args);
+    size = vsnprintf(txt, sizeof(txt), format, args);
+    if (size < 0) {
+        size = 0;
+        *txt = '\0';
+    }
+
+    CREATE(b->text, char, size + 1);
+    if ((size_t)size >= sizeof(txt))
+        vsnprintf(b->text, size + 1, format, args_copy);
+    else
+        memcpy(b->text, txt, size + 1);
+    va_end(args_copy);
+
+    b->len = size;
+}
+
+void broadcast_send(struct broadcast *b, struct descriptor_data *d)
+{
+    char protocol_buf[MAX_STRING_LENGTH], *translated = protocol_buf;
+    size_t translated_size = sizeof(protocol_buf);
+    int class, len;
+
+    if (d->output.overflow || b->len == 0)
+        return;
+
+    /* Descriptors whose translation can't be shared get their own. */
+    if ((class = ProtocolOutputClass(d)) < 0) {
+        output_translate(d, b->text, b->len);
+        return;
+    }
+
+    if (!b->rendered[class]) {
+        if ((size_t)b->len >= sizeof(protocol_buf)) {
+            translated_size = (b->len + 1) * 4;
+            CREATE(translated, char, translated_size);
+        }
+
+        len = b->len;
+        ProtocolOutputToBuffer(d, b->text, translated, translated_size, &len);
+
+        CREATE(b->rendered[class], char, len + 1);
+        memcpy(b->rendered[class], translated, len + 1);
+        b->rendered_len[class] = len;
+
+        if (translated != protocol_buf)
+            free(translated);
+    }
+
+    if (d->pProtocol->WriteOOB > 0)
+        --d->pProtocol->WriteOOB;
+
+    output_append(d, b->rendered[class], b->rendered_len[class]);
+}
+
+void broadcast_free(struct broadcast *b)
+{
+    int i;
+
+    for (i = 0; i < PROTOCOL_OUTPUT_CLASSES; i++)
+        if (b->rendered[i])
+            free(b->rendered[i]);
+    if (b->text)
+        free(b->text);
+    memset(b, 0, sizeof(*b));
+}
+
 void send_to_all(const char *messg, ...)
 {
     struct descriptor_data *i;
+    struct broadcast b;
     va_list args;
 
     if (messg == NULL)
         return;
 
+    va_start(args, messg);
+    vbroadcast_init(&b, messg, args);
+    va_end(args);
+
     for (i = descriptor_list; i; i = i->next) {
         if (STATE(i) != CON_PLAYING)
             continue;
 
-        va_start(args, messg);
-        vwrite_to_output(i, messg, args);
-        va_end(args);
+        broadcast_send(&b, i);
     }
+    broadcast_free(&b);
 }
 
 void send_to_outdoor(const char *messg, ...)
 {
     struct descriptor_data *i;
+    struct broadcast b;
     va_list args;
 
     if (!messg || !*messg)
         return;
 
+    va_start(args, messg);
+    vbroadcast_init(&b, messg, args);
+    va_end(args);
+
     for (i = descriptor_list; i; i = i->next) {
 
         if (STATE(i) != CON_PLAYING || i->character == NULL)
@@ -2708,52 +3447,60 @@ void send_to_outdoor(const char *messg, ...)
         if (!AWAKE(i->character) || !OUTSIDE(i->character))
             continue;
 
-        va_start(args, messg);
-        vwrite_to_output(i, messg, args);
-        va_end(args);
+        broadcast_send(&b, i);
     }
+    broadcast_free(&b);
 }
 
 void send_to_room(room_rnum room, const char *messg, ...)
 {
     struct char_data *i;
+    struct broadcast b, framed;
     va_list args;
-    char buf[MAX_STRING_LENGTH];
 
     if (messg == NULL)
         return;
 
+    va_start(args, messg);
+    vbroadcast_init(&b, messg, args);
+    va_end(args);
+
     for (i = world[room].people; i; i = i->next_in_room) {
         if (!i->desc)
             continue;
 
-        va_start(args, messg);
-        vwrite_to_output(i->desc, messg, args);
-        va_end(args);
+        broadcast_send(&b, i->desc);
     }
 
     /* Send to listeners in adjacent rooms */
-    for (i = world[room].listeners; i; i = i->next_listener) {
-        if (!i->desc)
-            continue;
-
+    if (world[room].listeners) {
         /* Format the message with visual markers to differentiate eavesdropped content */
-        va_start(args, messg);
-        vsnprintf(buf, sizeof(buf), messg, args);
-        va_end(args);
+        broadcast_init(&framed, "----------\r\n%s----------\r\n", b.text);
+
+        for (i = world[room].listeners; i; i = i->next_listener) {
+            if (!i->desc)
+                continue;
 
-        write_to_output(i->desc, "----------\r\n%s----------\r\n", buf);
+            broadcast_send(&framed, i->desc);
+        }
+        broadcast_free(&framed);
     }
+    broadcast_free(&b);
 }
 
 void send_to_zone_outdoor(zone_rnum zone, const char *messg, ...)
 {
     struct descriptor_data *d;
+    struct broadcast b;
     va_list args;
 
-    if (!messg || !*messg)
+    if (!messg || !*messg || !zone_table[zone].connected)
         return;
 
+    va_start(args, messg);
+    vbroadcast_init(&b, messg, args);
+    va_end(args);
+
     for (d = descriptor_list; d; d = d->next) {
         if (STATE(d) != CON_PLAYING || d->character == NULL)
             continue;
@@ -2762,10 +3509,9 @@ void send_to_zone_outdoor(zone_rnum zone, const char *messg, ...)
         if (d->character->in_room == NOWHERE || world[d->character->in_room].zone != zone)
             continue;
 
-        va_start(args, messg);
-        vwrite_to_output(d, messg, args);
-        va_end(args);
+        broadcast_send(&b, d);
     }
+    broadcast_free(&b);
 }
 
 /* Sends a message to the entire group, except for ch. Send 'ch' as NULL, if
@@ -2773,26 +3519,31 @@ void send_to_zone_outdoor(zone_rnum zone, const char *messg, ...)
 void send_to_group(struct char_data *ch, struct group_data *group, const char *msg, ...)
 {
     struct char_data *tch;
+    struct broadcast b;
     va_list args;
 
     if (msg == NULL)
         return;
 
+    va_start(args, msg);
+    vbroadcast_init(&b, msg, args);
+    va_end(args);
+
     while ((tch = simple_list(group->members)) != NULL) {
         if (tch != ch && !IS_NPC(tch) && tch->desc && STATE(tch->desc) == CON_PLAYING) {
             write_to_output(tch->desc, "%s[%sGrupo%s]%s ", CCGRN(tch, C_NRM), CBGRN(tch, C_NRM), CCGRN(tch, C_NRM),
                             CCNRM(tch, C_NRM));
-            va_start(args, msg);
-            vwrite_to_output(tch->desc, msg, args);
-            va_end(args);
+            broadcast_send(&b, tch->desc);
         }
     }
+    broadcast_free(&b);
 }
 
 /* Thx to Jamie Nelson of 4D for this contribution */
 void send_to_range(room_vnum start, room_vnum finish, const char *messg, ...)
 {
     struct char_data *i;
+    struct broadcast b;
     va_list args;
     int j;
 
@@ -2803,18 +3554,21 @@ void send_to_range(room_vnum start, room_vnum finish, const char *messg, ...)
     if (messg == NULL)
         return;
 
+    va_start(args, messg);
+    vbroadcast_init(&b, messg, args);
+    va_end(args);
+
     for (j = 0; j < top_of_world; j++) {
         if (GET_ROOM_VNUM(j) >= start && GET_ROOM_VNUM(j) <= finish) {
             for (i = world[j].people; i; i = i->next_in_room) {
                 if (!i->desc)
                     continue;
 
-                va_start(args, messg);
-                vwrite_to_output(i->desc, messg, args);
-                va_end(args);
+                broadcast_send(&b, i->desc);
             }
         }
     }
+    broadcast_free(&b);
 }
 
 static const char *ACTNULL = "<NULL>";
@@ -3271,55 +4025,80 @@ static void circle_sleep(struct timeval *timeout)
 /* KaVir's plugin */
 static void msdp_update(void)
 {
+    static int refresh = 0;
     struct descriptor_data *d;
-    int PlayerCount = 0;
+    int PlayerCount = 0, dirty;
+    bool vitals, status;
     char buf[MAX_STRING_LENGTH];
     extern const char *pc_class_types[];
 
+    /* Anything a mutation point forgot to mark is picked up here, for each
+       descriptor on its own second of the cycle so the full resends of
+       everyone online are spread out rather than all sent in one pulse. */
+    if (++refresh >= MSDP_REFRESH_SECS)
+        refresh = 0;
+
     for (d = descriptor_list; d; d = d->next) {
         struct char_data *ch = d->character;
         if (ch && !IS_NPC(ch) && d->connected == CON_PLAYING) {
             struct char_data *pOpponent = FIGHTING(ch);
             ++PlayerCount;
 
-            MSDPSetString(d, eMSDP_CHARACTER_NAME, GET_NAME(ch));
-            MSDPSetNumber(d, eMSDP_ALIGNMENT, GET_ALIGNMENT(ch));
-            MSDPSetNumber(d, eMSDP_EXPERIENCE, GET_EXP(ch));
-
-            MSDPSetNumber(d, eMSDP_HEALTH, GET_HIT(ch));
-            MSDPSetNumber(d, eMSDP_HEALTH_MAX, GET_MAX_HIT(ch));
-            MSDPSetNumber(d, eMSDP_LEVEL, GET_LEVEL(ch));
-
-            sprinttype(ch->player.chclass, pc_class_types, buf, sizeof(buf));
-            MSDPSetString(d, eMSDP_CLASS, buf);
+            /* Nothing to report to a client without MSDP, ATCP or GMCP; its
+               dirty groups just wait until it negotiates one. */
+            if (!d->pProtocol->bMSDP && !d->pProtocol->bATCP && !d->pProtocol->bGMCP)
+                continue;
 
-            MSDPSetNumber(d, eMSDP_MANA, GET_MANA(ch));
-            MSDPSetNumber(d, eMSDP_MANA_MAX, GET_MAX_MANA(ch));
+            if ((refresh + d->desc_num) % MSDP_REFRESH_SECS == 0)
+                d->msdp_dirty = MSDP_DIRTY_ALL;
+            dirty = d->msdp_dirty;
+            d->msdp_dirty = 0;
+
+            /* Coalesced: however often these changed since the last update,
+               only the values that differ from what the client has are sent. */
+            vitals = FALSE;
+            vitals |= MSDPSetNumber(d, eMSDP_HEALTH, GET_HIT(ch));
+            vitals |= MSDPSetNumber(d, eMSDP_HEALTH_MAX, GET_MAX_HIT(ch));
+            vitals |= MSDPSetNumber(d, eMSDP_LEVEL, GET_LEVEL(ch));
+            vitals |= MSDPSetNumber(d, eMSDP_MANA, GET_MANA(ch));
+            vitals |= MSDPSetNumber(d, eMSDP_MANA_MAX, GET_MAX_MANA(ch));
+            vitals |= MSDPSetNumber(d, eMSDP_MOVEMENT, GET_MOVE(ch));
+            vitals |= MSDPSetNumber(d, eMSDP_MOVEMENT_MAX, GET_MAX_MOVE(ch));
+
+            status = MSDPSetNumber(d, eMSDP_ALIGNMENT, GET_ALIGNMENT(ch));
+            MSDPSetNumber(d, eMSDP_EXPERIENCE, GET_EXP(ch));
             MSDPSetNumber(d, eMSDP_WIMPY, GET_WIMP_LEV(ch));
             MSDPSetNumber(d, eMSDP_MONEY, GET_GOLD(ch));
-            MSDPSetNumber(d, eMSDP_MOVEMENT, GET_MOVE(ch));
-            MSDPSetNumber(d, eMSDP_MOVEMENT_MAX, GET_MAX_MOVE(ch));
-            MSDPSetNumber(d, eMSDP_AC, compute_armor_class(ch));
-
-            /* Extended character status */
-            MSDPSetNumber(d, eMSDP_HUNGER, GET_COND(ch, HUNGER));
-            MSDPSetNumber(d, eMSDP_THIRST, GET_COND(ch, THIRST));
-            MSDPSetNumber(d, eMSDP_DRUNK, GET_COND(ch, DRUNK));
             MSDPSetNumber(d, eMSDP_BREATH, GET_BREATH(ch));
             MSDPSetNumber(d, eMSDP_BREATH_MAX, GET_MAX_BREATH(ch));
-            MSDPSetNumber(d, eMSDP_CARRYING_CAPACITY, CAN_CARRY_N(ch));
-            MSDPSetNumber(d, eMSDP_CARRYING_CURRENT, IS_CARRYING_N(ch));
-            MSDPSetNumber(d, eMSDP_WEIGHT_CAPACITY, CAN_CARRY_W(ch));
-            MSDPSetNumber(d, eMSDP_WEIGHT_CURRENT, IS_CARRYING_W(ch));
 
-            /* This would be better moved elsewhere */
+            if (IS_SET(dirty, MSDP_DIRTY_CHAR)) {
+                MSDPSetString(d, eMSDP_CHARACTER_NAME, GET_NAME(ch));
+                sprinttype(ch->player.chclass, pc_class_types, buf, sizeof(buf));
+                status |= MSDPSetString(d, eMSDP_CLASS, buf);
+            }
+
+            /* Extended character status */
+            if (IS_SET(dirty, MSDP_DIRTY_STATUS)) {
+                MSDPSetNumber(d, eMSDP_AC, compute_armor_class(ch));
+                status |= MSDPSetNumber(d, eMSDP_HUNGER, GET_COND(ch, HUNGER));
+                status |= MSDPSetNumber(d, eMSDP_THIRST, GET_COND(ch, THIRST));
+                MSDPSetNumber(d, eMSDP_DRUNK, GET_COND(ch, DRUNK));
+                MSDPSetNumber(d, eMSDP_CARRYING_CAPACITY, CAN_CARRY_N(ch));
+                MSDPSetNumber(d, eMSDP_CARRYING_CURRENT, IS_CARRYING_N(ch));
+                MSDPSetNumber(d, eMSDP_WEIGHT_CAPACITY, CAN_CARRY_W(ch));
+                MSDPSetNumber(d, eMSDP_WEIGHT_CURRENT, IS_CARRYING_W(ch));
+            }
+
+            /* The opponent's health changes every round, so it is polled for
+               as long as the fight lasts. */
             if (pOpponent != NULL) {
                 int hit_points = (GET_HIT(pOpponent) * 100) / GET_MAX_HIT(pOpponent);
                 MSDPSetNumber(d, eMSDP_OPPONENT_HEALTH, hit_points);
                 MSDPSetNumber(d, eMSDP_OPPONENT_HEALTH_MAX, 100);
                 MSDPSetNumber(d, eMSDP_OPPONENT_LEVEL, GET_LEVEL(pOpponent));
                 MSDPSetString(d, eMSDP_OPPONENT_NAME, PERS(pOpponent, ch));
-            } else /* Clear the values */
+            } else if (IS_SET(dirty, MSDP_DIRTY_COMBAT)) /* Clear the values */
             {
                 MSDPSetNumber(d, eMSDP_OPPONENT_HEALTH, 0);
                 MSDPSetNumber(d, eMSDP_OPPONENT_LEVEL, 0);
@@ -3327,69 +4106,79 @@ static void msdp_update(void)
             }
 
             /* Room and world information */
-            if (IN_ROOM(ch) != NOWHERE) {
-                room_rnum room = IN_ROOM(ch);
-                zone_rnum zone = GET_ROOM_ZONE(room);
-
-                MSDPSetString(d, eMSDP_ROOM_NAME, world[room].name ? world[room].name : "");
-                MSDPSetNumber(d, eMSDP_ROOM_VNUM, GET_ROOM_VNUM(room));
-
-                /* Set room terrain/sector */
-                extern const char *sector_types[];
-                if (SECT(room) >= 0 && SECT(room) < NUM_ROOM_SECTORS)
-                    MSDPSetString(d, eMSDP_ROOM_TERRAIN, sector_types[SECT(room)]);
-                else
-                    MSDPSetString(d, eMSDP_ROOM_TERRAIN, "unknown");
-
-                /* Set zone information */
-                if (zone != NOWHERE) {
-                    MSDPSetString(d, eMSDP_ZONE_NAME, zone_table[zone].name ? zone_table[zone].name : "");
-                    MSDPSetString(d, eMSDP_AREA_NAME, zone_table[zone].name ? zone_table[zone].name : "");
+            if (IS_SET(dirty, MSDP_DIRTY_ROOM)) {
+                if (IN_ROOM(ch) != NOWHERE) {
+                    room_rnum room = IN_ROOM(ch);
+                    zone_rnum zone = GET_ROOM_ZONE(room);
+
+                    MSDPSetString(d, eMSDP_ROOM_NAME, world[room].name ? world[room].name : "");
+                    MSDPSetNumber(d, eMSDP_ROOM_VNUM, GET_ROOM_VNUM(room));
+
+                    /* Set room terrain/sector */
+                    extern const char *sector_types[];
+                    if (SECT(room) >= 0 && SECT(room) < NUM_ROOM_SECTORS)
+                        MSDPSetString(d, eMSDP_ROOM_TERRAIN, sector_types[SECT(room)]);
+                    else
+                        MSDPSetString(d, eMSDP_ROOM_TERRAIN, "unknown");
+
+                    /* Set zone information */
+                    if (zone != NOWHERE) {
+                        MSDPSetString(d, eMSDP_ZONE_NAME, zone_table[zone].name ? zone_table[zone].name : "");
+                        MSDPSetString(d, eMSDP_AREA_NAME, zone_table[zone].name ? zone_table[zone].name : "");
+                    } else {
+                        MSDPSetString(d, eMSDP_ZONE_NAME, "");
+                        MSDPSetString(d, eMSDP_AREA_NAME, "");
+                    }
                 } else {
+                    MSDPSetString(d, eMSDP_ROOM_NAME, "");
+                    MSDPSetNumber(d, eMSDP_ROOM_VNUM, 0);
+                    MSDPSetString(d, eMSDP_ROOM_TERRAIN, "");
                     MSDPSetString(d, eMSDP_ZONE_NAME, "");
                     MSDPSetString(d, eMSDP_AREA_NAME, "");
                 }
-            } else {
-                MSDPSetString(d, eMSDP_ROOM_NAME, "");
-                MSDPSetNumber(d, eMSDP_ROOM_VNUM, 0);
-                MSDPSetString(d, eMSDP_ROOM_TERRAIN, "");
-                MSDPSetString(d, eMSDP_ZONE_NAME, "");
-                MSDPSetString(d, eMSDP_AREA_NAME, "");
             }
 
             /* Group/following information */
-            if (ch->master) {
-                MSDPSetString(d, eMSDP_FOLLOWING, GET_NAME(ch->master));
-            } else {
-                MSDPSetString(d, eMSDP_FOLLOWING, "");
+            if (IS_SET(dirty, MSDP_DIRTY_GROUP)) {
+                if (ch->master) {
+                    MSDPSetString(d, eMSDP_FOLLOWING, GET_NAME(ch->master));
+                } else {
+                    MSDPSetString(d, eMSDP_FOLLOWING, "");
+                }
             }
 
-            /* Send GMCP character data if supported */
+            /* Send GMCP character data if supported, and only what changed
+               (everything, on a full refresh). */
             if (d->pProtocol->bGMCP) {
                 char gmcp_buffer[MAX_STRING_LENGTH];
 
                 /* Send basic character vitals */
-                sprintf(gmcp_buffer,
-                        "{ \"name\": \"%s\", \"level\": %d, \"hp\": %d, \"maxhp\": %d, \"mana\": %d, \"maxmana\": %d, "
-                        "\"moves\": %d, \"maxmoves\": %d }",
-                        GET_NAME(ch), GET_LEVEL(ch), GET_HIT(ch), GET_MAX_HIT(ch), GET_MANA(ch), GET_MAX_MANA(ch),
-                        GET_MOVE(ch), GET_MAX_MOVE(ch));
-                GMCPSendData(d, "Char.Vitals", gmcp_buffer);
+                if (vitals || !refresh) {
+                    sprintf(gmcp_buffer,
+                            "{ \"name\": \"%s\", \"level\": %d, \"hp\": %d, \"maxhp\": %d, \"mana\": %d, "
+                            "\"maxmana\": %d, \"moves\": %d, \"maxmoves\": %d }",
+                            GET_NAME(ch), GET_LEVEL(ch), GET_HIT(ch), GET_MAX_HIT(ch), GET_MANA(ch), GET_MAX_MANA(ch),
+                            GET_MOVE(ch), GET_MAX_MOVE(ch));
+                    GMCPSendData(d, "Char.Vitals", gmcp_buffer);
+                }
 
                 /* Send character status */
-                sprintf(gmcp_buffer,
-                        "{ \"class\": \"%s\", \"race\": \"%s\", \"alignment\": %d, \"hunger\": %d, \"thirst\": %d }",
-                        pc_class_types[ch->player.chclass], "Human", GET_ALIGNMENT(ch), GET_COND(ch, HUNGER),
-                        GET_COND(ch, THIRST));
-                GMCPSendData(d, "Char.Status", gmcp_buffer);
+                if (status || !refresh) {
+                    sprintf(gmcp_buffer,
+                            "{ \"class\": \"%s\", \"race\": \"%s\", \"alignment\": %d, \"hunger\": %d, "
+                            "\"thirst\": %d }",
+                            pc_class_types[ch->player.chclass], "Human", GET_ALIGNMENT(ch), GET_COND(ch, HUNGER),
+                            GET_COND(ch, THIRST));
+                    GMCPSendData(d, "Char.Status", gmcp_buffer);
+                }
             }
 
             MSDPUpdate(d);
         }
-
-        /* Ideally this should be called once at startup, and again whenever
-           someone leaves or joins the mud.  But this works, and it keeps the
-           snippet simple.  Optimise as you see fit. */
-        MSSPSetPlayers(PlayerCount);
     }
+
+    /* Ideally this should be called once at startup, and again whenever
+       someone leaves or joins the mud.  But this works, and it keeps the
+       snippet simple.  Optimise as you see fit. */
+    MSSPSetPlayers(PlayerCount);
 }
@@ -17,6 +17,29 @@
 #define COPYOVER_FILE "copyover.dat"
 #define MAX_DESC_NUM 999 /* Maximum descriptor number before cycling back to 1 */
 
+/* Socket readiness bits kept in descriptor_data.io_events */
+#define IO_READ (1 << 0)  /**< Socket has input waiting (or not yet drained) */
+#define IO_WRITE (1 << 1) /**< Socket can accept more output */
+#define IO_ERROR (1 << 2) /**< Socket is in an error or hangup state */
+#define MAX_IO_EVENTS 256 /**< Events fetched per epoll_wait() call */
+
+/* MSDP/GMCP variable groups recomputed by msdp_update().  Vitals change all
+   over the code and are cheap, so they are polled every update; the groups
+   below are only rebuilt after a mutation point marks them dirty. */
+#define MSDP_DIRTY_CHAR (1 << 0)   /**< Name and class */
+#define MSDP_DIRTY_STATUS (1 << 1) /**< AC, conditions, carried items and weight */
+#define MSDP_DIRTY_ROOM (1 << 2)   /**< Room, terrain and zone */
+#define MSDP_DIRTY_COMBAT (1 << 3) /**< Opponent */
+#define MSDP_DIRTY_GROUP (1 << 4)  /**< Leader being followed */
+#define MSDP_DIRTY_ALL ((1 << 5) - 1)
+#define MSDP_REFRESH_SECS 30 /**< Everything is recomputed this often anyway */
+
+#define MSDP_DIRTY(ch, bits)                                                                                           \
+    do {                                                                                                               \
+        if ((ch)->desc)                                                                                                \
+            (ch)->desc->msdp_dirty |= (bits);                                                                          \
+    } while (0)
+
 /* comm.c */
 void close_socket(struct descriptor_data *d);
 void game_info(const char *messg, ...) __attribute__((format(printf, 1, 2)));
@@ -30,6 +53,20 @@ void send_to_group(struct char_data *ch, struct group_data *group, const char *m
     __attribute__((format(printf, 3, 4)));
 void send_to_range(room_vnum start, room_vnum finish, const char *messg, ...) __attribute__((format(printf, 3, 4)));
 
+/* A message formatted once and translated once per protocol output class, for
+   sending the same text to many descriptors. */
+struct broadcast {
+    char *text;                                   /**< The formatted message */
+    int len;                                      /**< strlen(text) */
+    char *rendered[PROTOCOL_OUTPUT_CLASSES];      /**< Translated text, per class */
+    int rendered_len[PROTOCOL_OUTPUT_CLASSES];    /**< Length of each of those */
+};
+
+void broadcast_init(struct broadcast *b, const char *format, ...) __attribute__((format(printf, 2, 3)));
+void vbroadcast_init(struct broadcast *b, const char *format, va_list args);
+void broadcast_send(struct broadcast *b, struct descriptor_data *d);
+void broadcast_free(struct broadcast *b);
+
 /* Act type settings and flags */
 #define TO_ROOM 1    /**< act() type: to everyone in room, except ch. */
 #define TO_VICT 2    /**< act() type: to vict_obj. */
@@ -50,6 +87,8 @@ void write_to_q(const char *txt, struct txt_q *queue, int aliased);
 int write_to_descriptor(socket_t desc, const char *txt);
 size_t write_to_output(struct descriptor_data *d, const char *txt, ...) __attribute__((format(printf, 2, 3)));
 size_t vwrite_to_output(struct descriptor_data *d, const char *format, va_list args);
+bool output_compress_ok(struct descriptor_data *d);
+void output_compress(struct descriptor_data *d, bool on);
 
 typedef RETSIGTYPE sigfunc(int);
 
@@ -60,9 +99,10 @@ void heartbeat(int heart_pulse);
 void copyover_recover(void);
 
 extern struct descriptor_data *descriptor_list;
-extern int buf_largecount;
+extern int buf_chunkcount;
 extern int buf_overflows;
-extern int buf_switches;
+extern int buf_partial_sends;
+extern int pulse_overruns;
 extern int circle_shutdown;
 extern int circle_reboot;
 extern int shutdown_signal;
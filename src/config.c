@@ -360,6 +360,14 @@ int special_in_comm = YES;
 /* Current Debug Mode */
 int debug_mode = YES;
 
+/* Minutes a zone, and every zone next to it, must go without anyone
+ * connected before its mobs go dormant.  0 keeps every zone awake. */
+int zone_dormancy = 10;
+
+/* Mobs in dormant zones take one turn in this many.  0 freezes them and
+ * catches them up in one step when the zone wakes. */
+int dormant_mob_rate = 0;
+
 /* Big Five (OCEAN) Personality System - Phase 1: Neuroticism
  * Beta values stored as int * 100 (e.g., 0.40 = 40, 0.25 = 25, 0.20 = 20)
  * These control how much Neuroticism amplifies negative emotions
@@ -84,6 +84,8 @@ extern int disp_closed_doors;
 extern int protocol_negotiation;
 extern int special_in_comm;
 extern int debug_mode;
+extern int zone_dormancy;
+extern int dormant_mob_rate;
 extern int fit_evolve;
 extern int weather_affects_spells;
 extern int school_weather_affects;
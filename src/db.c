@@ -43,6 +43,7 @@
 #include <sys/stat.h>
 
 #include "spedit.h"
+#include "graph.h"
 
 /* */
 
@@ -69,6 +70,7 @@ obj_rnum top_of_objt = 0;            /* top of object index table */
 
 struct zone_data *zone_table;    /* zone table */
 zone_rnum top_of_zone_table = 0; /* top element of zone tab */
+bool dormant_zones_woken = FALSE; /* a dormant zone woke up, see mobile_activity() */
 
 /* begin previously located in players.c */
 struct player_index_element *player_table = NULL; /* index to plr file */
@@ -174,6 +176,11 @@ static void load_default_config(void);
 static void free_extra_descriptions(struct extra_descr_data *edesc);
 static bitvector_t asciiflag_conv_aff(char *flag);
 static int hsort(const void *a, const void *b);
+static int zone_pair_compare(const void *a, const void *b);
+static void build_zone_neighbours(void);
+static bool zone_is_quiet(zone_rnum zone, unsigned long quiet);
+static void wake_zone(zone_rnum zone);
+static void wake_zone_and_neighbours(zone_rnum zone);
 
 /*
  * Campos:
@@ -523,6 +530,7 @@ void boot_world(void)
 
     log1("Renumbering rooms.");
     renum_world();
+    register_world_scripts();
 
     log1("Checking start rooms.");
     check_start_rooms();
@@ -836,9 +844,6 @@ void boot_db(void)
     log1("Sorting command list.");
     sort_commands();
 
-    log1("Initializing disabled commands system.");
-    init_disabled_commands();
-
     log1("Booting mail system.");
     if (!scan_file()) {
         log1("    Mail boot failed -- Mail system disabled");
@@ -1529,7 +1534,7 @@ void parse_room(FILE *fl, int virtual_nr)
                 if (rnum != NOTHING) {
                     if (!(world[room_nr].script))
                         CREATE(world[room_nr].script, struct script_data, 1);
-                    add_trigger(SCRIPT(&world[room_nr]), read_trigger(rnum), -1);
+                    add_trigger(&world[room_nr], WLD_TRIGGER, read_trigger(rnum), -1);
                 }
                 break;
             }
@@ -2250,6 +2255,7 @@ void parse_mobile(FILE *mob_f, int nr)
     mob_index[i].vnum = nr;
     mob_index[i].number = 0;
     mob_index[i].func = NULL;
+    mob_index[i].mobs = NULL;
 
     clear_char(mob_proto + i);
 
@@ -2404,6 +2410,7 @@ char *parse_object(FILE *obj_f, int nr)
     obj_index[i].vnum = nr;
     obj_index[i].number = 0;
     obj_index[i].func = NULL;
+    obj_index[i].objs = NULL;
 
     clear_object(obj_proto + i);
     obj_proto[i].item_number = i;
@@ -2958,6 +2965,8 @@ struct char_data *read_mobile(mob_vnum nr, int type) /* and mob_rnum */
     clear_char(mob);
 
     *mob = mob_proto[i];
+    mob->presence_zone = NOWHERE;
+    mob->presence_counted = FALSE;
 
     /* Cria uma cópia única da "ficha de IA" para esta instância. */
     CREATE(mob->ai_data, struct mob_ai_data, 1);
@@ -3012,8 +3021,11 @@ struct char_data *read_mobile(mob_vnum nr, int type) /* and mob_rnum */
     mob->player.time.logon = time(0);
 
     mob_index[i].number++;
+    mob_instance_link(mob);
+    name_index_add(mob);
 
     mob->script_id = 0;   // this is set later by char_script_id
+    mob_slice_link(mob); /* assigns the script id */
 
     copy_proto_script(&mob_proto[i], mob, MOB_TRIGGER);
     assign_triggers(mob, MOB_TRIGGER);
@@ -3058,6 +3070,7 @@ struct obj_data *read_object(obj_vnum nr, int type) /* and obj_rnum */
     obj->events = NULL;
 
     obj_index[i].number++;
+    obj_instance_link(obj);
 
     obj->script_id = 0;   // this is set later by obj_script_id
 
@@ -3076,6 +3089,9 @@ void zone_update(void)
     struct reset_q_element *update_u, *temp;
     static int timer = 0;
 
+    check_zone_presence();
+    zone_dormancy_update();
+
     /* jelson 10/22/92 */
     if (((++timer * PULSE_ZONE) / PASSES_PER_SEC) >= 60) {
         /* one minute has passed NOT accurate unless PULSE_ZONE is a multiple
@@ -3388,7 +3404,9 @@ void reset_zone(zone_rnum zone)
                              world[ZCMD.arg1].number, ZCMD.arg2);
                     ZONE_ERROR(error);
                     ZCMD.command = '*';
-                } else
+                } else {
+                    int was_closed = EXIT_FLAGGED(world[ZCMD.arg1].dir_option[ZCMD.arg2], EX_CLOSED);
+
                     switch (ZCMD.arg3) {
                         case 0:
                             REMOVE_BIT(world[ZCMD.arg1].dir_option[ZCMD.arg2]->exit_info, EX_LOCKED);
@@ -3406,6 +3424,9 @@ void reset_zone(zone_rnum zone)
                             REMOVE_BIT(world[ZCMD.arg1].dir_option[ZCMD.arg2]->exit_info, EX_JAMMED);
                             break;
                     }
+                    if (was_closed != EXIT_FLAGGED(world[ZCMD.arg1].dir_option[ZCMD.arg2], EX_CLOSED))
+                        pathfind_door_changed(ZCMD.arg1);
+                }
                 last_cmd = 1;
                 tmob = NULL;
                 tobj = NULL;
@@ -3415,12 +3436,12 @@ void reset_zone(zone_rnum zone)
                 if (ZCMD.arg1 == MOB_TRIGGER && tmob) {
                     if (!SCRIPT(tmob))
                         CREATE(SCRIPT(tmob), struct script_data, 1);
-                    add_trigger(SCRIPT(tmob), read_trigger(ZCMD.arg2), -1);
+                    add_trigger(tmob, MOB_TRIGGER, read_trigger(ZCMD.arg2), -1);
                     last_cmd = 1;
                 } else if (ZCMD.arg1 == OBJ_TRIGGER && tobj) {
                     if (!SCRIPT(tobj))
                         CREATE(SCRIPT(tobj), struct script_data, 1);
-                    add_trigger(SCRIPT(tobj), read_trigger(ZCMD.arg2), -1);
+                    add_trigger(tobj, OBJ_TRIGGER, read_trigger(ZCMD.arg2), -1);
                     last_cmd = 1;
                 } else if (ZCMD.arg1 == WLD_TRIGGER) {
                     if (ZCMD.arg3 == NOWHERE || ZCMD.arg3 > top_of_world) {
@@ -3428,7 +3449,7 @@ void reset_zone(zone_rnum zone)
                     }
                     if (!world[ZCMD.arg3].script)
                         CREATE(world[ZCMD.arg3].script, struct script_data, 1);
-                    add_trigger(world[ZCMD.arg3].script, read_trigger(ZCMD.arg2), -1);
+                    add_trigger(&world[ZCMD.arg3], WLD_TRIGGER, read_trigger(ZCMD.arg2), -1);
                     last_cmd = 1;
                 }
 
@@ -3479,28 +3500,209 @@ void reset_zone(zone_rnum zone)
     }
 }
 
-/* for use in reset_zone; return TRUE if zone 'nr' is free of PC's */
-int is_empty(zone_rnum zone_nr)
+/* Zone occupancy.  Every zone counts the characters in it that have a
+ * connection (players, and the mobs immortals have switched into), and of
+ * those, the ones that count as present for is_empty(): immortals with
+ * nohassle on are left out, so they can watch zone reset triggers.  Each
+ * character remembers the zone it was last counted in, and
+ * update_zone_presence() moves it between counts whenever its room,
+ * connection, level or nohassle changes. */
+static bool counts_as_present(struct char_data *ch)
 {
-    struct descriptor_data *i;
+    /* If an immortal has nohassle off, he counts as present. Added for
+       testing zone reset triggers -Welcor */
+    return (IS_NPC(ch) || GET_LEVEL(ch) < LVL_IMMORT || !PRF_FLAGGED(ch, PRF_NOHASSLE));
+}
 
-    for (i = descriptor_list; i; i = i->next) {
-        if (STATE(i) != CON_PLAYING)
-            continue;
-        if (IN_ROOM(i->character) == NOWHERE)
-            continue;
-        if (world[IN_ROOM(i->character)].zone != zone_nr)
-            continue;
-        /* If an immortal has nohassle off, he counts as present. Added for
-           testing zone reset triggers -Welcor */
-        if ((!IS_NPC(i->character)) && (GET_LEVEL(i->character) >= LVL_IMMORT) &&
-            (PRF_FLAGGED(i->character, PRF_NOHASSLE)))
-            continue;
+void update_zone_presence(struct char_data *ch)
+{
+    zone_rnum zone = (ch->desc && IN_ROOM(ch) != NOWHERE) ? world[IN_ROOM(ch)].zone : NOWHERE;
+    bool present = (zone != NOWHERE && counts_as_present(ch));
+
+    if (zone == ch->presence_zone && present == ch->presence_counted)
+        return;
+    if (ch->presence_zone != NOWHERE) {
+        if (!--zone_table[ch->presence_zone].connected)
+            zone_table[ch->presence_zone].empty_since = pulse;
+        if (ch->presence_counted)
+            zone_table[ch->presence_zone].players--;
+    }
+    if (zone != NOWHERE) {
+        if (!zone_table[zone].connected++)
+            wake_zone_and_neighbours(zone);
+        if (present)
+            zone_table[zone].players++;
+    }
+    ch->presence_zone = zone;
+    ch->presence_counted = present;
+}
+
+/* Recounts every zone from scratch.  The counts are kept up to date as
+ * characters move, so this only catches a missed update; it is cheap enough
+ * to run every PULSE_ZONE. */
+void check_zone_presence(void)
+{
+    struct char_data *ch;
+    zone_rnum zone;
+    bool counted;
+    int *counts;
+
+    /* counts[2 * zone] is players, counts[2 * zone + 1] is connected. */
+    CREATE(counts, int, 2 * (top_of_zone_table + 1));
+    for (ch = character_list; ch; ch = ch->next) {
+        zone = ch->presence_zone;
+        counted = ch->presence_counted;
+        update_zone_presence(ch);
+        if (zone != ch->presence_zone || counted != ch->presence_counted)
+            log1("SYSERR: %s was counted in zone %d instead of %d.", GET_NAME(ch),
+                 zone == NOWHERE ? -1 : zone_table[zone].number,
+                 ch->presence_zone == NOWHERE ? -1 : zone_table[ch->presence_zone].number);
+        if (ch->presence_zone != NOWHERE) {
+            counts[2 * ch->presence_zone + 1]++;
+            if (ch->presence_counted)
+                counts[2 * ch->presence_zone]++;
+        }
+    }
 
+    for (zone = 0; zone <= top_of_zone_table; zone++)
+        if (zone_table[zone].players != counts[2 * zone] || zone_table[zone].connected != counts[2 * zone + 1]) {
+            log1("SYSERR: Zone %d had %d/%d players/connections counted instead of %d/%d.", zone_table[zone].number,
+                 zone_table[zone].players, zone_table[zone].connected, counts[2 * zone], counts[2 * zone + 1]);
+            zone_table[zone].players = counts[2 * zone];
+            zone_table[zone].connected = counts[2 * zone + 1];
+        }
+
+    free(counts);
+}
+
+/* Returns how many characters count as present in a zone. */
+int zone_player_count(zone_rnum zone_nr)
+{
+    if (zone_nr == NOWHERE || zone_nr > top_of_zone_table)
         return (0);
+    return (zone_table[zone_nr].players);
+}
+
+/* for use in reset_zone; return TRUE if zone 'nr' is free of PC's */
+int is_empty(zone_rnum zone_nr) { return (zone_player_count(zone_nr) == 0); }
+
+/* Zone dormancy.  A zone goes dormant once it and every zone next to it
+ * have had nobody connected in them for CONFIG_ZONE_DORMANCY minutes, and
+ * then its mobs only take one in CONFIG_DORMANT_MOB_RATE of their turns, or
+ * with a rate of 0 stop altogether and are caught up in one step when the
+ * zone wakes (see mobact.c).  Someone connecting in the zone or next to it
+ * wakes it at once; zone_dormancy_update() also wakes any dormant zone that
+ * no longer qualifies.  Zones are next to each other when an exit leads
+ * from one to the other, either way round. */
+static bool zone_neighbours_dirty = TRUE;
+
+static int zone_pair_compare(const void *a, const void *b)
+{
+    const zone_rnum *x = (const zone_rnum *)a, *y = (const zone_rnum *)b;
+
+    if (x[0] != y[0])
+        return (x[0] - y[0]);
+    return (x[1] - y[1]);
+}
+
+/* Rebuilds every zone's neighbour list from the exits in the world. */
+static void build_zone_neighbours(void)
+{
+    zone_rnum *pairs, zone, other;
+    room_rnum room, to;
+    int num = 0, max = 256, i, j, dir;
+
+    for (zone = 0; zone <= top_of_zone_table; zone++) {
+        if (zone_table[zone].neighbours)
+            free(zone_table[zone].neighbours);
+        zone_table[zone].neighbours = NULL;
+        zone_table[zone].num_neighbours = 0;
     }
 
-    return (1);
+    /* Collect each zone to zone exit as a pair both ways round, then sort
+       the pairs so each zone's neighbours come together. */
+    CREATE(pairs, zone_rnum, 2 * max);
+    for (room = 0; room <= top_of_world; room++)
+        for (dir = 0; dir < NUM_OF_DIRS; dir++) {
+            if (!world[room].dir_option[dir] || (to = world[room].dir_option[dir]->to_room) == NOWHERE ||
+                to > top_of_world || world[to].zone == world[room].zone)
+                continue;
+            if (num + 2 > max) {
+                max *= 2;
+                RECREATE(pairs, zone_rnum, 2 * max);
+            }
+            pairs[2 * num] = pairs[2 * num + 3] = world[room].zone;
+            pairs[2 * num + 1] = pairs[2 * num + 2] = world[to].zone;
+            num += 2;
+        }
+    qsort(pairs, num, 2 * sizeof(zone_rnum), zone_pair_compare);
+
+    for (i = 0; i < num; i = j) {
+        zone = pairs[2 * i];
+        for (j = i; j < num && pairs[2 * j] == zone; j++)
+            ;
+        CREATE(zone_table[zone].neighbours, zone_rnum, j - i);
+        for (other = NOWHERE; i < j; i++)
+            if (pairs[2 * i + 1] != other)
+                zone_table[zone].neighbours[zone_table[zone].num_neighbours++] = other = pairs[2 * i + 1];
+    }
+
+    free(pairs);
+    zone_neighbours_dirty = FALSE;
+}
+
+/* Call when an exit between rooms (or the zone table) has changed; the
+ * neighbour lists are rebuilt on the next dormancy update. */
+void invalidate_zone_neighbours(void) { zone_neighbours_dirty = TRUE; }
+
+static bool zone_is_quiet(zone_rnum zone, unsigned long quiet)
+{
+    return (!zone_table[zone].connected && pulse - zone_table[zone].empty_since >= quiet);
+}
+
+static void wake_zone(zone_rnum zone)
+{
+    if (zone_table[zone].dormant) {
+        zone_table[zone].dormant = FALSE;
+        dormant_zones_woken = TRUE;
+    }
+}
+
+/* Someone just connected in an empty zone.  Its neighbour lists may be a
+ * few seconds out of date after OLC, which zone_dormancy_update() puts
+ * right; they are not rebuilt here since this can run while rooms are
+ * being moved about. */
+static void wake_zone_and_neighbours(zone_rnum zone)
+{
+    int i;
+
+    wake_zone(zone);
+    for (i = 0; i < zone_table[zone].num_neighbours; i++)
+        if (zone_table[zone].neighbours[i] <= top_of_zone_table)
+            wake_zone(zone_table[zone].neighbours[i]);
+}
+
+/* Puts quiet zones to sleep and wakes the ones that are not; every PULSE_ZONE. */
+void zone_dormancy_update(void)
+{
+    unsigned long quiet = (unsigned long)CONFIG_ZONE_DORMANCY * 60 * PASSES_PER_SEC;
+    zone_rnum zone;
+    bool sleep;
+    int i;
+
+    if (zone_neighbours_dirty)
+        build_zone_neighbours();
+
+    for (zone = 0; zone <= top_of_zone_table; zone++) {
+        sleep = (CONFIG_ZONE_DORMANCY > 0 && zone_is_quiet(zone, quiet));
+        for (i = 0; sleep && i < zone_table[zone].num_neighbours; i++)
+            sleep = zone_is_quiet(zone_table[zone].neighbours[i], quiet);
+
+        if (!sleep)
+            wake_zone(zone);
+        else
+            zone_table[zone].dormant = TRUE;
+    }
 }
 
 /* Functions of a general utility nature. */
@@ -3858,6 +4060,8 @@ void free_char(struct char_data *ch)
     int i;
     struct alias_data *a;
 
+    name_index_remove(ch);
+
     if (ch->player_specials != NULL && ch->player_specials != &dummy_mob) {
         while ((a = GET_ALIASES(ch)) != NULL) {
             GET_ALIASES(ch) = (GET_ALIASES(ch))->next;
@@ -4130,6 +4334,7 @@ void clear_char(struct char_data *ch)
      * Fim do Bloco de Genética                                              *
      *************************************************************************/
     IN_ROOM(ch) = NOWHERE;
+    ch->presence_zone = NOWHERE;
     GET_PFILEPOS(ch) = -1;
     GET_MOB_RNUM(ch) = NOBODY;
     GET_WAS_IN(ch) = NOWHERE;
@@ -4552,6 +4757,8 @@ static void load_default_config(void)
     CONFIG_MINIMAP_SIZE = default_minimap_size;
     CONFIG_SCRIPT_PLAYERS = script_players;
     CONFIG_DEBUG_MODE = debug_mode;
+    CONFIG_ZONE_DORMANCY = zone_dormancy;
+    CONFIG_DORMANT_MOB_RATE = dormant_mob_rate;
     CONFIG_FIT_EVOLVE = fit_evolve;
     CONFIG_WEATHER_AFFECTS_SPELLS = weather_affects_spells;
     CONFIG_SCHOOL_WEATHER_AFFECTS = school_weather_affects;
@@ -4853,6 +5060,8 @@ void load_config(void)
             case 'd':
                 if (!str_cmp(tag, "debug_mode"))
                     CONFIG_DEBUG_MODE = num;
+                else if (!str_cmp(tag, "dormant_mob_rate"))
+                    CONFIG_DORMANT_MOB_RATE = MAX(num, 0);
                 else if (!str_cmp(tag, "dead_start_room"))
                     if (num == -1)
                         CONFIG_DEAD_START = NOWHERE;
@@ -5394,8 +5603,10 @@ void load_config(void)
             case 't':
                 if (!str_cmp(tag, "tunnel_size"))
                     CONFIG_TUNNEL_SIZE = num;
-                else if (!str_cmp(tag, "track_through_doors"))
+                else if (!str_cmp(tag, "track_through_doors") && CONFIG_TRACK_T_DOORS != num) {
                     CONFIG_TRACK_T_DOORS = num;
+                    invalidate_pathfind_cache(NOWHERE);
+                }
                 break;
 
             case 'u':
@@ -5425,6 +5636,11 @@ void load_config(void)
                     CONFIG_MOB_4D_DEBUG = num;
                 break;
 
+            case 'z':
+                if (!str_cmp(tag, "zone_dormancy"))
+                    CONFIG_ZONE_DORMANCY = MAX(num, 0);
+                break;
+
             default:
                 break;
         }
@@ -131,6 +131,7 @@
 #define BADPWS_LOGFILE PREFIX_LOGFILE "badpws"
 #define OLC_LOGFILE PREFIX_LOGFILE "olc"
 #define TRIGGER_LOGFILE PREFIX_LOGFILE "trigger"
+#define PERF_LOGFILE PREFIX_LOGFILE "perf.csv"
 /**/
 /* END: Assumed default locations for logfiles, mainly used in do_file. */
 
@@ -207,6 +208,17 @@ struct zone_data {
 
     int climate;                  /* zone climate				 */
     struct weather_data *weather; /* zone weather (if climate != default)	 */
+
+    int players;   /* characters counted as present, see is_empty() */
+    int connected; /* characters with a connection, nohassle or not */
+
+    bool dormant;              /* mobs here are idle, see zone_dormancy_update() */
+    unsigned long empty_since; /* pulse the last connection left */
+    zone_rnum *neighbours;     /* zones an exit leads to or from */
+    int num_neighbours;
+
+    struct script_data *random_scripts; /* registered random triggers here */
+    struct script_data *time_scripts;   /* and time triggers; see dg_handler.c */
 };
 
 /* for queueing zones for update   */
@@ -311,6 +323,7 @@ long get_ptable_by_name(const char *name);
 void remove_player(int pfilepos);
 void clean_pfiles(void);
 void build_player_index(void);
+void hash_player_index(void);
 
 struct obj_data *create_obj(void);
 void clear_object(struct obj_data *obj);
@@ -327,6 +340,11 @@ void parse_room(FILE *fl, int virtual_nr);
 void parse_mobile(FILE *mob_f, int nr);
 char *parse_object(FILE *obj_f, int nr);
 int is_empty(zone_rnum zone_nr);
+int zone_player_count(zone_rnum zone_nr);
+void update_zone_presence(struct char_data *ch);
+void check_zone_presence(void);
+void zone_dormancy_update(void);
+void invalidate_zone_neighbours(void);
 void reset_zone(zone_rnum zone);
 void reboot_wizlists(void);
 ACMD(do_reboot);
@@ -393,6 +411,7 @@ extern room_rnum top_of_world;
 
 extern struct zone_data *zone_table;
 extern zone_rnum top_of_zone_table;
+extern bool dormant_zones_woken;
 
 extern struct char_data *character_list;
 
@@ -192,12 +192,15 @@ void sub_write(char *arg, char_data *ch, byte find_invis, int targets)
 void send_to_zone(char *messg, zone_rnum zone)
 {
     struct descriptor_data *i;
+    struct broadcast b;
 
-    if (!messg || !*messg)
+    if (!messg || !*messg || !zone_table[zone].connected)
         return;
 
+    broadcast_init(&b, "%s", messg);
     for (i = descriptor_list; i; i = i->next)
         if (!i->connected && i->character && AWAKE(i->character) && (IN_ROOM(i->character) != NOWHERE) &&
             (world[IN_ROOM(i->character)].zone == zone))
-            write_to_output(i, "%s", messg);
+            broadcast_send(&b, i);
+    broadcast_free(&b);
 }
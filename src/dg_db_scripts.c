@@ -209,7 +209,7 @@ void dg_read_trigger(FILE *fp, void *proto, int type)
             if (rnum != NOTHING) {
                 if (!(room->script))
                     CREATE(room->script, struct script_data, 1);
-                add_trigger(SCRIPT(room), read_trigger(rnum), -1);
+                add_trigger(room, WLD_TRIGGER, read_trigger(rnum), -1);
             } else {
                 mudlog(BRF, LVL_BUILDER, TRUE, "SYSERR: non-existant trigger #%d assigned to room #%d", vnum,
                        room->number);
@@ -274,7 +274,7 @@ void assign_triggers(void *i, int type)
                 } else {
                     if (!SCRIPT(mob))
                         CREATE(SCRIPT(mob), struct script_data, 1);
-                    add_trigger(SCRIPT(mob), read_trigger(rnum), -1);
+                    add_trigger(mob, MOB_TRIGGER, read_trigger(rnum), -1);
                 }
                 trg_proto = trg_proto->next;
             }
@@ -290,7 +290,7 @@ void assign_triggers(void *i, int type)
                 } else {
                     if (!SCRIPT(obj))
                         CREATE(SCRIPT(obj), struct script_data, 1);
-                    add_trigger(SCRIPT(obj), read_trigger(rnum), -1);
+                    add_trigger(obj, OBJ_TRIGGER, read_trigger(rnum), -1);
                 }
                 trg_proto = trg_proto->next;
             }
@@ -306,7 +306,7 @@ void assign_triggers(void *i, int type)
                 } else {
                     if (!SCRIPT(room))
                         CREATE(SCRIPT(room), struct script_data, 1);
-                    add_trigger(SCRIPT(room), read_trigger(rnum), -1);
+                    add_trigger(room, WLD_TRIGGER, read_trigger(rnum), -1);
                 }
                 trg_proto = trg_proto->next;
             }
@@ -32,6 +32,65 @@
 /** The mud specific queue of events. */
 static struct dg_queue *event_q;
 
+/** Blocks of events and queue elements handed out by the pools below. */
+struct event_block {
+    struct event_block *next;
+    struct event events[EVENT_POOL_BLOCK];
+};
+
+struct q_element_block {
+    struct q_element_block *next;
+    struct q_element elements[EVENT_POOL_BLOCK];
+};
+
+static struct event_block *event_blocks = NULL;
+static struct q_element_block *q_element_blocks = NULL;
+static struct event *free_events = NULL;         /* Chained through event_obj */
+static struct q_element *free_q_elements = NULL; /* Chained through next */
+
+/* Local functions */
+static struct event *event_alloc(void);
+static void event_release(struct event *event);
+static struct q_element *q_element_alloc(void);
+static void q_element_release(struct q_element *qe);
+static struct q_slot *queue_slot(struct dg_queue *q, long key);
+static void queue_link(struct dg_queue *q, struct q_element *qe, long when);
+static void queue_unlink(struct q_element *qe);
+static void queue_cascade(struct dg_queue *q, struct q_slot *slot);
+static void queue_advance(struct dg_queue *q, long when);
+
+/** Takes an event from the pool, allocating another block if it is empty.
+ * @retval event * A zeroed event. */
+static struct event *event_alloc(void)
+{
+    struct event_block *block;
+    struct event *event;
+    int i;
+
+    if (!free_events) {
+        CREATE(block, struct event_block, 1);
+        block->next = event_blocks;
+        event_blocks = block;
+        for (i = 0; i < EVENT_POOL_BLOCK; i++) {
+            block->events[i].event_obj = free_events;
+            free_events = &block->events[i];
+        }
+    }
+
+    event = free_events;
+    free_events = (struct event *)event->event_obj;
+    memset(event, 0, sizeof(struct event));
+
+    return event;
+}
+
+/** Returns an event to the pool.  Its event_obj must have been dealt with. */
+static void event_release(struct event *event)
+{
+    event->event_obj = free_events;
+    free_events = event;
+}
+
 /** Initializes the main event queue event_q.
  * @post The main event queue, event_q, has been created and initialized.
  */
@@ -55,7 +114,7 @@ struct event *event_create(EVENTFUNC(*func), void *event_obj, long when)
     if (when < 1) /* make sure its in the future */
         when = 1;
 
-    CREATE(new_event, struct event, 1);
+    new_event = event_alloc();
     new_event->func = func;
     new_event->event_obj = event_obj;
     new_event->q_el = queue_enq(event_q, new_event, when + pulse);
@@ -82,7 +141,7 @@ void event_cancel(struct event *event)
     if (event->event_obj)
         cleanup_event_obj(event);
 
-    free(event);
+    event_release(event);
 }
 
 /* The memory freeing routine tied into the mud event system */
@@ -123,7 +182,7 @@ void event_process(void)
             if (the_event->isMudEvent && the_event->event_obj != NULL)
                 free_mud_event((struct mud_event_data *)the_event->event_obj);
             /* It is assumed that the_event will already have freed ->event_obj. */
-            free(the_event);
+            event_release(the_event);
         }
     }
 }
@@ -140,11 +199,26 @@ long event_time(struct event *event)
     return (when - pulse);
 }
 
-/** Frees all events from event_q. */
+/** Frees all events from event_q, and the pools they came from. */
 void event_free_all(void)
 {
+    struct event_block *eb;
+    struct q_element_block *qb;
+
     if (event_q != NULL)
         queue_free(event_q);
+    event_q = NULL;
+
+    while ((eb = event_blocks) != NULL) {
+        event_blocks = eb->next;
+        free(eb);
+    }
+    while ((qb = q_element_blocks) != NULL) {
+        q_element_blocks = qb->next;
+        free(qb);
+    }
+    free_events = NULL;
+    free_q_elements = NULL;
 }
 
 /** Boolean function to tell whether an event is queued or not. Does this by
@@ -165,6 +239,137 @@ int event_is_queued(struct event *event)
 /***************************************************************************
  * Begin generic (abstract) priority queue functions
  **************************************************************************/
+/* Pulses covered by one slot of each level of the wheel, and by a whole
+ * level 3 turn. */
+#define WHEEL_SECOND (WHEEL_PULSE_SLOTS)
+#define WHEEL_MINUTE (WHEEL_SECOND * WHEEL_SECOND_SLOTS)
+#define WHEEL_HOUR (WHEEL_MINUTE * WHEEL_MINUTE_SLOTS)
+#define WHEEL_DAY (WHEEL_HOUR * WHEEL_HOUR_SLOTS)
+
+/* Where each level starts in dg_queue.slot[] */
+#define WHEEL_LEVEL1 (WHEEL_PULSE_SLOTS)
+#define WHEEL_LEVEL2 (WHEEL_LEVEL1 + WHEEL_SECOND_SLOTS)
+#define WHEEL_LEVEL3 (WHEEL_LEVEL2 + WHEEL_MINUTE_SLOTS)
+
+/** Takes a queue element from the pool, allocating another block if needed.
+ * @retval q_element * A zeroed queue element. */
+static struct q_element *q_element_alloc(void)
+{
+    struct q_element_block *block;
+    struct q_element *qe;
+    int i;
+
+    if (!free_q_elements) {
+        CREATE(block, struct q_element_block, 1);
+        block->next = q_element_blocks;
+        q_element_blocks = block;
+        for (i = 0; i < EVENT_POOL_BLOCK; i++) {
+            block->elements[i].next = free_q_elements;
+            free_q_elements = &block->elements[i];
+        }
+    }
+
+    qe = free_q_elements;
+    free_q_elements = qe->next;
+    memset(qe, 0, sizeof(struct q_element));
+
+    return qe;
+}
+
+/** Returns a queue element to the pool. */
+static void q_element_release(struct q_element *qe)
+{
+    qe->next = free_q_elements;
+    free_q_elements = qe;
+}
+
+/** Picks the slot for a key: the lowest level whose current span the key
+ * falls in.  Keys in the past go in the current pulse's slot.
+ * @param q The queue.
+ * @param key When the element should come up.
+ * @retval q_slot * The slot. */
+static struct q_slot *queue_slot(struct dg_queue *q, long key)
+{
+    if (key < q->now)
+        key = q->now;
+
+    if (key / WHEEL_SECOND == q->now / WHEEL_SECOND)
+        return &q->slot[key % WHEEL_PULSE_SLOTS];
+    if (key / WHEEL_MINUTE == q->now / WHEEL_MINUTE)
+        return &q->slot[WHEEL_LEVEL1 + (key / WHEEL_SECOND) % WHEEL_SECOND_SLOTS];
+    if (key / WHEEL_HOUR == q->now / WHEEL_HOUR)
+        return &q->slot[WHEEL_LEVEL2 + (key / WHEEL_MINUTE) % WHEEL_MINUTE_SLOTS];
+    if (key / WHEEL_DAY == q->now / WHEEL_DAY)
+        return &q->slot[WHEEL_LEVEL3 + (key / WHEEL_HOUR) % WHEEL_HOUR_SLOTS];
+
+    return &q->overflow;
+}
+
+/** Puts qe at the back of the slot for the pulse 'when'. */
+static void queue_link(struct dg_queue *q, struct q_element *qe, long when)
+{
+    qe->slot = queue_slot(q, when);
+    qe->next = NULL;
+    if ((qe->prev = qe->slot->tail) != NULL)
+        qe->prev->next = qe;
+    else
+        qe->slot->head = qe;
+    qe->slot->tail = qe;
+}
+
+/** Takes qe out of whichever slot it is in. */
+static void queue_unlink(struct q_element *qe)
+{
+    if (qe->prev == NULL)
+        qe->slot->head = qe->next;
+    else
+        qe->prev->next = qe->next;
+
+    if (qe->next == NULL)
+        qe->slot->tail = qe->prev;
+    else
+        qe->next->prev = qe->prev;
+
+    qe->prev = qe->next = NULL;
+}
+
+/** Empties a slot whose time has come into the levels below it.  Walking
+ * from the head and appending keeps the queued order within each pulse. */
+static void queue_cascade(struct dg_queue *q, struct q_slot *slot)
+{
+    struct q_element *qe, *next_qe;
+
+    qe = slot->head;
+    slot->head = slot->tail = NULL;
+
+    for (; qe; qe = next_qe) {
+        next_qe = qe->next;
+        queue_link(q, qe, qe->key);
+    }
+}
+
+/** Turns the wheel forward to the pulse 'when', one pulse at a time,
+ * cascading each higher level slot as its second, minute, hour or day
+ * begins.  Afterwards the level 0 slot for 'when' holds everything due. */
+static void queue_advance(struct dg_queue *q, long when)
+{
+    while (q->now < when) {
+        q->now++;
+
+        if (q->now % WHEEL_SECOND)
+            continue;
+        if (!(q->now % WHEEL_MINUTE)) {
+            if (!(q->now % WHEEL_HOUR)) {
+                if (!(q->now % WHEEL_DAY))
+                    queue_cascade(q, &q->overflow);
+                queue_cascade(q, &q->slot[WHEEL_LEVEL3 + (q->now / WHEEL_HOUR) % WHEEL_HOUR_SLOTS]);
+            }
+            queue_cascade(q, &q->slot[WHEEL_LEVEL2 + (q->now / WHEEL_MINUTE) % WHEEL_MINUTE_SLOTS]);
+        }
+        queue_cascade(q, &q->slot[WHEEL_LEVEL1 + (q->now / WHEEL_SECOND) % WHEEL_SECOND_SLOTS]);
+    }
+}
+
 /** Create a new, empty, priority queue and return it.
  * @retval dg_queue * Pointer to the newly created queue structure. */
 struct dg_queue *queue_init(void)
@@ -172,6 +377,7 @@ struct dg_queue *queue_init(void)
     struct dg_queue *q;
 
     CREATE(q, struct dg_queue, 1);
+    q->now = pulse;
 
     return q;
 }
@@ -188,110 +394,69 @@ struct dg_queue *queue_init(void)
  * the data. */
 struct q_element *queue_enq(struct dg_queue *q, void *data, long key)
 {
-    struct q_element *qe, *i;
-    int bucket;
+    struct q_element *qe;
 
-    CREATE(qe, struct q_element, 1);
+    qe = q_element_alloc();
     qe->data = data;
     qe->key = key;
 
-    bucket = key % NUM_EVENT_QUEUES; /* which queue does this go in */
-
-    if (!q->head[bucket]) { /* queue is empty */
-        q->head[bucket] = qe;
-        q->tail[bucket] = qe;
-    }
-
-    else {
-        for (i = q->tail[bucket]; i; i = i->prev) {
-
-            if (i->key < key) { /* found insertion point */
-                if (i == q->tail[bucket])
-                    q->tail[bucket] = qe;
-                else {
-                    qe->next = i->next;
-                    i->next->prev = qe;
-                }
-
-                qe->prev = i;
-                i->next = qe;
-                break;
-            }
-        }
-
-        if (i == NULL) { /* insertion point is front of list */
-            qe->next = q->head[bucket];
-            q->head[bucket] = qe;
-            qe->next->prev = qe;
-        }
-    }
+    /* The current pulse's slot may already have been run; anything due now
+       or earlier comes up on the next pulse. */
+    queue_link(q, qe, key > q->now ? key : q->now + 1);
 
     return qe;
 }
 
 /** Remove queue element qe from the priority queue q.
  * @pre qe->data has been dealt with in some way.
- * @post qe has been freed.
+ * @post qe has been returned to the pool.
  * @param q Pointer to the queue containing qe.
  * @param qe Pointer to the q_element to remove from q.
  */
 void queue_deq(struct dg_queue *q, struct q_element *qe)
 {
-    int i;
-
     assert(qe);
 
-    i = qe->key % NUM_EVENT_QUEUES;
-
-    if (qe->prev == NULL)
-        q->head[i] = qe->next;
-    else
-        qe->prev->next = qe->next;
-
-    if (qe->next == NULL)
-        q->tail[i] = qe->prev;
-    else
-        qe->next->prev = qe->prev;
-
-    free(qe);
+    queue_unlink(qe);
+    q_element_release(qe);
 }
 
 /** Removes and returns the data of the first element of the priority queue q.
- * @pre pulse must be defined. This is a multi-headed queue, the current
- * head is determined by the current pulse.
+ * @pre pulse must be defined. The wheel is turned to the current pulse
+ * first, and the head is taken from that pulse's slot.
  * @post the q->head is dequeued.
  * @param q The queue to return the head of.
  * @retval void * NULL if there is not a currently available head, pointer
  * to any data object associated with the queue element. */
 void *queue_head(struct dg_queue *q)
 {
+    struct q_element *qe;
     void *dg_data;
-    int i;
 
-    i = pulse % NUM_EVENT_QUEUES;
+    queue_advance(q, pulse);
 
-    if (!q->head[i])
+    if (!(qe = q->slot[q->now % WHEEL_PULSE_SLOTS].head))
         return NULL;
 
-    dg_data = q->head[i]->data;
-    queue_deq(q, q->head[i]);
+    dg_data = qe->data;
+    queue_deq(q, qe);
     return dg_data;
 }
 
 /** Returns the key of the head element of the priority queue.
- * @pre pulse must be defined. This is a multi-headed queue, the current
- * head is determined by the current pulse.
+ * @pre pulse must be defined. The wheel is turned to the current pulse
+ * first, and the head is taken from that pulse's slot.
  * @param q Queue to check for.
  * @retval long Return the key element of the head q_element. If no head
  * q_element is available, return LONG_MAX. */
 long queue_key(struct dg_queue *q)
 {
-    int i;
+    struct q_element *qe;
 
-    i = pulse % NUM_EVENT_QUEUES;
+    queue_advance(q, pulse);
 
-    if (q->head[i])
-        return q->head[i]->key;
+    if ((qe = q->slot[q->now % WHEEL_PULSE_SLOTS].head) != NULL)
+        return qe->key;
     else
         return LONG_MAX;
 }
@@ -308,22 +473,25 @@ long queue_elmt_key(struct q_element *qe) { return qe->key; }
  */
 void queue_free(struct dg_queue *q)
 {
-    int i;
     struct q_element *qe, *next_qe;
+    struct q_slot *slot;
     struct event *event;
+    int i;
 
-    for (i = 0; i < NUM_EVENT_QUEUES; i++) {
-        for (qe = q->head[i]; qe; qe = next_qe) {
+    for (i = 0; i <= EVENT_WHEEL_SLOTS; i++) {
+        slot = (i < EVENT_WHEEL_SLOTS) ? &q->slot[i] : &q->overflow;
+        for (qe = slot->head; qe; qe = next_qe) {
             next_qe = qe->next;
             if ((event = (struct event *)qe->data) != NULL) {
                 if (event->event_obj)
                     cleanup_event_obj(event);
 
-                free(event);
+                event_release(event);
             }
-            free(qe);
+            q_element_release(qe);
         }
+        slot->head = slot->tail = NULL;
     }
 
     free(q);
-}
\ No newline at end of file
+}
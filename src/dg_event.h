@@ -42,20 +42,42 @@ struct event {
 /**************************************************************************
  * Begin priority queue structures and defines.
  **************************************************************************/
-/** Number of buckets available in each queue. Reduces enqueue cost. */
-#define NUM_EVENT_QUEUES 10
+/* The queue is a hierarchical timing wheel.  Level 0 has a slot for each
+ * pulse of the current second, level 1 a slot for each second of the current
+ * minute, level 2 one for each minute of the hour and level 3 one for each
+ * hour of the day.  Events further away than that wait on an overflow list.
+ * Whenever a second (minute, hour, day) begins, the slot for it is emptied
+ * into the level below, so insert and cancel are O(1) and each event is only
+ * ever moved a handful of times before it fires. */
+#define WHEEL_PULSE_SLOTS PASSES_PER_SEC /**< Pulses in a second */
+#define WHEEL_SECOND_SLOTS 60            /**< Seconds in a minute */
+#define WHEEL_MINUTE_SLOTS 60            /**< Minutes in an hour */
+#define WHEEL_HOUR_SLOTS 24              /**< Hours in a day */
+#define EVENT_WHEEL_SLOTS (WHEEL_PULSE_SLOTS + WHEEL_SECOND_SLOTS + WHEEL_MINUTE_SLOTS + WHEEL_HOUR_SLOTS)
+
+/** Events and queue elements are allocated this many at a time. */
+#define EVENT_POOL_BLOCK 256
+
+/** One slot of the wheel.  Elements are appended at the tail, so events due
+ * on the same pulse fire in the order they were queued. */
+struct q_slot {
+    struct q_element *head; /**< Comes up first. */
+    struct q_element *tail; /**< Queued last. */
+};
 
 /** The priority queue. */
 struct dg_queue {
-    struct q_element *head[NUM_EVENT_QUEUES]; /**< Front of each queue bucket. */
-    struct q_element *tail[NUM_EVENT_QUEUES]; /**< Rear of each queue bucket. */
+    struct q_slot slot[EVENT_WHEEL_SLOTS]; /**< All four levels, one after the other. */
+    struct q_slot overflow;                /**< Events more than a day away. */
+    long now;                              /**< The pulse the wheel has been turned to. */
 };
 
 /** Queued elements. */
 struct q_element {
     void *data;                    /**< The event to be handled. */
     long key;                      /**< When the event should be handled. */
-    struct q_element *prev, *next; /**< Points to other q_elements in line. */
+    struct q_element *prev, *next; /**< Points to other q_elements in the same slot. */
+    struct q_slot *slot;           /**< The slot this element is in. */
 };
 /**************************************************************************
  * End priority queue structures and defines.
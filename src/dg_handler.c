@@ -108,6 +108,164 @@ void extract_trigger(struct trig_data *trig)
     free_trigger(trig);
 }
 
+/* Script registries.  script_trigger_check() and check_time_triggers() used
+ * to walk every mob, every object and every room looking for the few that
+ * have random or time triggers.  Instead, each script with such a trigger is
+ * linked into a registry list: scripts that run whatever the zone (objects,
+ * and mob or room scripts with a global trigger) go in the always list, the
+ * rest in a list kept by the zone they are in, so the zones nobody is in can
+ * be skipped as a whole.  add_trigger() and remove_trigger() keep this up to
+ * date, char_to_room() moves mob scripts between zones, and extract_script()
+ * takes scripts out.  Room scripts read with the world are registered once
+ * it is loaded, see register_world_scripts(). */
+static struct script_data *always_scripts[NUM_SCRIPT_REGS];
+static struct script_data *registry_cursor[NUM_SCRIPT_REGS]; /* next to visit */
+static unsigned long registry_pass[NUM_SCRIPT_REGS];
+
+static const long registry_types[NUM_SCRIPT_REGS] = {MTRIG_RANDOM, MTRIG_TIME};
+
+static struct script_data **registry_head(int reg, zone_rnum zone)
+{
+    if (zone == NOWHERE)
+        return (&always_scripts[reg]);
+    if (reg == SCRIPT_REG_RANDOM)
+        return (&zone_table[zone].random_scripts);
+    return (&zone_table[zone].time_scripts);
+}
+
+static void registry_unlink(struct script_data *sc, int reg)
+{
+    if (!IS_SET(sc->registered, 1 << reg))
+        return;
+
+    if (registry_cursor[reg] == sc)
+        registry_cursor[reg] = sc->reg_next[reg];
+    if (sc->reg_prev[reg])
+        sc->reg_prev[reg]->reg_next[reg] = sc->reg_next[reg];
+    else
+        *registry_head(reg, sc->reg_zone[reg]) = sc->reg_next[reg];
+    if (sc->reg_next[reg])
+        sc->reg_next[reg]->reg_prev[reg] = sc->reg_prev[reg];
+
+    sc->reg_prev[reg] = sc->reg_next[reg] = NULL;
+    REMOVE_BIT(sc->registered, 1 << reg);
+}
+
+static void registry_link(struct script_data *sc, int reg, zone_rnum zone)
+{
+    struct script_data **head = registry_head(reg, zone);
+
+    sc->reg_zone[reg] = zone;
+    sc->reg_prev[reg] = NULL;
+    sc->reg_next[reg] = *head;
+    if (*head)
+        (*head)->reg_prev[reg] = sc;
+    *head = sc;
+    SET_BIT(sc->registered, 1 << reg);
+}
+
+/* Returns the mob, object or room holding a script, or NULL. */
+static void *script_owner(struct script_data *sc)
+{
+    room_rnum rnum;
+
+    if (sc->attach_type != WLD_TRIGGER)
+        return (sc->attached);
+    if ((rnum = real_room(sc->attached_room)) == NOWHERE)
+        return (NULL);
+    return (&world[rnum]);
+}
+
+/* Puts a script in the registry lists its triggers and place call for. */
+void update_script_registry(struct script_data *sc)
+{
+    room_rnum room = NOWHERE;
+    zone_rnum zone = NOWHERE;
+    bool placed = TRUE;
+    int reg;
+
+    if (sc->attach_type != OBJ_TRIGGER && !IS_SET(SCRIPT_TYPES(sc), MTRIG_GLOBAL)) {
+        if (sc->attach_type == MOB_TRIGGER)
+            room = sc->attached ? IN_ROOM((struct char_data *)sc->attached) : NOWHERE;
+        else
+            room = real_room(sc->attached_room);
+        if (room == NOWHERE || (zone = world[room].zone) == NOWHERE)
+            placed = FALSE;
+    }
+
+    for (reg = 0; reg < NUM_SCRIPT_REGS; reg++) {
+        if (!placed || !IS_SET(SCRIPT_TYPES(sc), registry_types[reg])) {
+            registry_unlink(sc, reg);
+            continue;
+        }
+        if (IS_SET(sc->registered, 1 << reg) && sc->reg_zone[reg] == zone)
+            continue;
+        registry_unlink(sc, reg);
+        registry_link(sc, reg, zone);
+    }
+}
+
+/* Triggers read with a room are attached before the room is in world[], so
+ * add_trigger() could not find the room to place them; boot_world() calls
+ * this once the rooms are all in and numbered. */
+void register_world_scripts(void)
+{
+    room_rnum rnum;
+
+    for (rnum = 0; rnum <= top_of_world; rnum++)
+        if (SCRIPT(&world[rnum]))
+            update_script_registry(SCRIPT(&world[rnum]));
+}
+
+/* The cursor lets func extract anything, including the script it was called
+ * for; the pass number keeps a mob that walks into a zone still to come
+ * from being run twice. */
+static void run_registry_list(int reg, struct script_data *sc, void (*func)(void *go, int type))
+{
+    void *go;
+
+    for (; sc; sc = registry_cursor[reg]) {
+        registry_cursor[reg] = sc->reg_next[reg];
+        if (sc->reg_pass[reg] == registry_pass[reg])
+            continue;
+        sc->reg_pass[reg] = registry_pass[reg];
+        if ((go = script_owner(sc)) == NULL)
+            continue;
+        if (sc->attach_type == MOB_TRIGGER && IN_ROOM((struct char_data *)go) == NOWHERE)
+            continue;
+        func(go, sc->attach_type);
+    }
+    registry_cursor[reg] = NULL;
+}
+
+/* Calls func for every script in the always list and in the lists of the
+ * zones with players in them. */
+void run_script_registry(int reg, void (*func)(void *go, int type))
+{
+    zone_rnum zone;
+
+    registry_pass[reg]++;
+
+    run_registry_list(reg, always_scripts[reg], func);
+    for (zone = 0; zone <= top_of_zone_table; zone++)
+        if (!is_empty(zone))
+            run_registry_list(reg, *registry_head(reg, zone), func);
+}
+
+/* After a new zone moved the later zones up a slot, their lists came along
+ * with them; point their scripts at the new slots. */
+void renum_script_registry(void)
+{
+    struct script_data *sc;
+    zone_rnum zone;
+    int reg;
+
+    for (zone = 0; zone <= top_of_zone_table; zone++)
+        for (reg = 0; reg < NUM_SCRIPT_REGS; reg++)
+            for (sc = *registry_head(reg, zone); sc; sc = sc->reg_next[reg])
+                sc->reg_zone[reg] = zone;
+}
+
 /* remove all triggers from a mob/obj/room */
 void extract_script(void *thing, int type)
 {
@@ -152,11 +310,16 @@ void extract_script(void *thing, int type)
         }
     }
 #endif
+    if (!sc)
+        return;
+
     for (trig = TRIGGERS(sc); trig; trig = next_trig) {
         next_trig = trig->next;
         extract_trigger(trig);
     }
     TRIGGERS(sc) = NULL;
+    SCRIPT_TYPES(sc) = 0;
+    update_script_registry(sc);
 
     /* Thanks to James Long for tracking down this memory leak */
     free_varlist(sc->global_vars);
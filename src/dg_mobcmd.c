@@ -22,6 +22,7 @@
 #include "genzon.h" /* for real_zone_by_thing */
 #include "act.h"
 #include "fight.h"
+#include "graph.h"
 
 /* Local file scope functions. */
 static void mob_log(char_data *mob, const char *format, ...);
@@ -986,6 +987,11 @@ ACMD(do_mtransform)
         tmpmob.next_in_room = ch->next_in_room;
         tmpmob.next = ch->next;
         tmpmob.next_fighting = ch->next_fighting;
+        tmpmob.next_instance = ch->next_instance;
+        tmpmob.prev_instance = ch->prev_instance;
+        tmpmob.next_in_slice = ch->next_in_slice;
+        tmpmob.prev_in_slice = ch->prev_in_slice;
+        tmpmob.name_keys = NULL; /* m's own, freed when it is extracted */
         tmpmob.followers = ch->followers;
         tmpmob.master = ch->master;
         tmpmob.group = ch->group;
@@ -1002,7 +1008,9 @@ ACMD(do_mtransform)
         IS_CARRYING_N(&tmpmob) = IS_CARRYING_N(ch);
         FIGHTING(&tmpmob) = FIGHTING(ch);
         HUNTING(&tmpmob) = HUNTING(ch);
+        name_index_remove(ch);
         memcpy(ch, &tmpmob, sizeof(*ch));
+        name_index_add(ch);
 
         for (pos = 0; pos < NUM_WEARS; pos++) {
             if (obj[pos])
@@ -1020,7 +1028,7 @@ ACMD(do_mdoor)
     char field[MAX_INPUT_LENGTH], *value;
     room_data *rm;
     struct room_direction_data *newexit;
-    int dir, fd, to_room;
+    int dir, fd, to_room, old_to;
 
     const char *door_field[] = {"purge", "description", "flags", "key", "name", "room", "\n"};
 
@@ -1057,6 +1065,7 @@ ACMD(do_mdoor)
     }
 
     newexit = rm->dir_option[dir];
+    old_to = newexit ? newexit->to_room : NOWHERE;
 
     /* purge exit */
     if (fd == 0) {
@@ -1104,6 +1113,10 @@ ACMD(do_mdoor)
                 break;
         }
     }
+    /* Purging, creating or retargeting the exit can change which zones touch. */
+    if ((rm->dir_option[dir] ? rm->dir_option[dir]->to_room : NOWHERE) != old_to)
+        invalidate_zone_neighbours();
+    invalidate_pathfind_cache(real_room(rm->number));
 }
 
 ACMD(do_mfollow)
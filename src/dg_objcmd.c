@@ -20,6 +20,7 @@
 #include "constants.h"
 #include "genzon.h" /* for access to real_zone_by_thing */
 #include "fight.h"  /* for die() */
+#include "graph.h"
 
 /* Local functions */
 #define OCMD(name) void(name)(obj_data * obj, char *argument, int cmd, int subcmd)
@@ -302,7 +303,9 @@ static OCMD(do_otransform)
             unequip_char(obj->worn_by, pos);
         }
 
-        /* move new obj info over to old object and delete new obj */
+        /* move new obj info over to old object and delete new obj; it now
+         * belongs on the new prototype's list of instances */
+        obj_instance_unlink(obj);
         memcpy(&tmpobj, o, sizeof(*o));
         tmpobj.in_room = IN_ROOM(obj);
         tmpobj.carried_by = obj->carried_by;
@@ -316,6 +319,7 @@ static OCMD(do_otransform)
         tmpobj.next_content = obj->next_content;
         tmpobj.next = obj->next;
         memcpy(obj, &tmpobj, sizeof(*obj));
+        obj_instance_link(obj);
 
         if (wearer) {
             equip_char(wearer, obj, pos);
@@ -576,7 +580,7 @@ static OCMD(do_odoor)
     char field[MAX_INPUT_LENGTH], *value;
     room_data *rm;
     struct room_direction_data *newexit;
-    int dir, fd, to_room;
+    int dir, fd, to_room, old_to;
 
     const char *door_field[] = {"purge", "description", "flags", "key", "name", "room", "\n"};
 
@@ -605,6 +609,7 @@ static OCMD(do_odoor)
     }
 
     newexit = rm->dir_option[dir];
+    old_to = newexit ? newexit->to_room : NOWHERE;
 
     /* purge exit */
     if (fd == 0) {
@@ -652,6 +657,10 @@ static OCMD(do_odoor)
                 break;
         }
     }
+    /* Purging, creating or retargeting the exit can change which zones touch. */
+    if ((rm->dir_option[dir] ? rm->dir_option[dir]->to_room : NOWHERE) != old_to)
+        invalidate_zone_neighbours();
+    invalidate_pathfind_cache(real_room(rm->number));
 }
 
 static OCMD(do_osetval)
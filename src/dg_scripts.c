@@ -38,6 +38,8 @@ static room_data *find_room(long n);
 static void do_stat_trigger(struct char_data *ch, trig_data *trig);
 static void script_stat(char_data *ch, struct script_data *sc);
 static int remove_trigger(struct script_data *sc, char *name);
+static void random_trigger(void *go, int type);
+static void time_trigger(void *go, int type);
 static int is_num(char *arg);
 static void eval_op(char *op, char *lhs, char *rhs, char *result, void *go, struct script_data *sc, trig_data *trig);
 static char *matching_paren(char *p);
@@ -342,6 +344,7 @@ static room_data *find_room(long n)
 char_data *get_char(char *name)
 {
     char_data *i;
+    struct name_cursor cur;
 
     if (*name == UID_CHAR) {
         i = find_char(atoi(name + 1));
@@ -349,8 +352,8 @@ char_data *get_char(char *name)
         if (i && valid_dg_target(i, DG_ALLOW_GODS))
             return i;
     } else {
-        for (i = character_list; i; i = i->next)
-            if (isname(name, i->player.name) && valid_dg_target(i, DG_ALLOW_GODS))
+        for (i = first_char_named(name, &cur); i; i = next_char_named(&cur))
+            if (valid_dg_target(i, DG_ALLOW_GODS))
                 return i;
     }
 
@@ -497,6 +500,7 @@ room_data *get_room(char *name)
 char_data *get_char_by_obj(obj_data *obj, char *name)
 {
     char_data *ch;
+    struct name_cursor cur;
 
     if (*name == UID_CHAR) {
         ch = find_char(atoi(name + 1));
@@ -511,8 +515,8 @@ char_data *get_char_by_obj(obj_data *obj, char *name)
         if (obj->worn_by && isname(name, obj->worn_by->player.name) && valid_dg_target(obj->worn_by, DG_ALLOW_GODS))
             return obj->worn_by;
 
-        for (ch = character_list; ch; ch = ch->next)
-            if (isname(name, ch->player.name) && valid_dg_target(ch, DG_ALLOW_GODS))
+        for (ch = first_char_named(name, &cur); ch; ch = next_char_named(&cur))
+            if (valid_dg_target(ch, DG_ALLOW_GODS))
                 return ch;
     }
 
@@ -524,6 +528,7 @@ char_data *get_char_by_obj(obj_data *obj, char *name)
 char_data *get_char_by_room(room_data *room, char *name)
 {
     char_data *ch;
+    struct name_cursor cur;
 
     if (*name == UID_CHAR) {
         ch = find_char(atoi(name + 1));
@@ -535,8 +540,8 @@ char_data *get_char_by_room(room_data *room, char *name)
             if (isname(name, ch->player.name) && valid_dg_target(ch, DG_ALLOW_GODS))
                 return ch;
 
-        for (ch = character_list; ch; ch = ch->next)
-            if (isname(name, ch->player.name) && valid_dg_target(ch, DG_ALLOW_GODS))
+        for (ch = first_char_named(name, &cur); ch; ch = next_char_named(&cur))
+            if (valid_dg_target(ch, DG_ALLOW_GODS))
                 return ch;
     }
 
@@ -614,84 +619,32 @@ obj_data *get_obj_by_room(room_data *room, char *name)
 }
 
 /* checks every PULSE_SCRIPT for random triggers */
-void script_trigger_check(void)
+static void random_trigger(void *go, int type)
 {
-    char_data *ch;
-    obj_data *obj;
-    struct room_data *room = NULL;
-    room_rnum nr;
-    struct script_data *sc;
-
-    for (ch = character_list; ch; ch = ch->next) {
-        if (SCRIPT(ch)) {
-            sc = SCRIPT(ch);
-
-            if (IS_SET(SCRIPT_TYPES(sc), WTRIG_RANDOM) &&
-                (!is_empty(world[IN_ROOM(ch)].zone) || IS_SET(SCRIPT_TYPES(sc), WTRIG_GLOBAL)))
-                random_mtrigger(ch);
-        }
-    }
-
-    for (obj = object_list; obj; obj = obj->next) {
-        if (SCRIPT(obj)) {
-            sc = SCRIPT(obj);
-
-            if (IS_SET(SCRIPT_TYPES(sc), OTRIG_RANDOM))
-                random_otrigger(obj);
-        }
-    }
-
-    for (nr = 0; nr <= top_of_world; nr++) {
-        if (SCRIPT(&world[nr])) {
-            room = &world[nr];
-            sc = SCRIPT(room);
-
-            if (IS_SET(SCRIPT_TYPES(sc), WTRIG_RANDOM) &&
-                (!is_empty(room->zone) || IS_SET(SCRIPT_TYPES(sc), WTRIG_GLOBAL)))
-                random_wtrigger(room);
-        }
-    }
+    if (type == MOB_TRIGGER)
+        random_mtrigger((char_data *)go);
+    else if (type == OBJ_TRIGGER)
+        random_otrigger((obj_data *)go);
+    else
+        random_wtrigger((room_data *)go);
 }
 
-void check_time_triggers(void)
-{
-    char_data *ch;
-    obj_data *obj;
-    struct room_data *room = NULL;
-    int nr;
-    struct script_data *sc;
-
-    for (ch = character_list; ch; ch = ch->next) {
-        if (SCRIPT(ch)) {
-            sc = SCRIPT(ch);
-
-            if (IS_SET(SCRIPT_TYPES(sc), WTRIG_TIME) &&
-                (!is_empty(world[IN_ROOM(ch)].zone) || IS_SET(SCRIPT_TYPES(sc), WTRIG_GLOBAL)))
-                time_mtrigger(ch);
-        }
-    }
-
-    for (obj = object_list; obj; obj = obj->next) {
-        if (SCRIPT(obj)) {
-            sc = SCRIPT(obj);
-
-            if (IS_SET(SCRIPT_TYPES(sc), OTRIG_TIME))
-                time_otrigger(obj);
-        }
-    }
-
-    for (nr = 0; nr <= top_of_world; nr++) {
-        if (SCRIPT(&world[nr])) {
-            room = &world[nr];
-            sc = SCRIPT(room);
+/* Only the scripts registered with a random trigger are visited; mob and
+ * room scripts in empty zones are skipped unless they are global. */
+void script_trigger_check(void) { run_script_registry(SCRIPT_REG_RANDOM, random_trigger); }
 
-            if (IS_SET(SCRIPT_TYPES(sc), WTRIG_TIME) &&
-                (!is_empty(room->zone) || IS_SET(SCRIPT_TYPES(sc), WTRIG_GLOBAL)))
-                time_wtrigger(room);
-        }
-    }
+static void time_trigger(void *go, int type)
+{
+    if (type == MOB_TRIGGER)
+        time_mtrigger((char_data *)go);
+    else if (type == OBJ_TRIGGER)
+        time_otrigger((obj_data *)go);
+    else
+        time_wtrigger((room_data *)go);
 }
 
+void check_time_triggers(void) { run_script_registry(SCRIPT_REG_TIME, time_trigger); }
+
 static EVENTFUNC(trig_wait_event)
 {
     struct wait_event_data *wait_event_obj = (struct wait_event_data *)event_obj;
@@ -890,13 +843,22 @@ void do_sstat_character(char_data *ch, char_data *k)
     script_stat(ch, SCRIPT(k));
 }
 
-/* Adds the trigger t to script sc in in location loc.  loc = -1 means add to
- * the end, loc = 0 means add before all other triggers. */
-void add_trigger(struct script_data *sc, trig_data *t, int loc)
+/* Adds the trigger t to the script of go (a mob, obj or room, by type) in
+ * location loc.  loc = -1 means add to the end, loc = 0 means add before all
+ * other triggers.  The script must already exist. */
+void add_trigger(void *go, int type, trig_data *t, int loc)
 {
+    struct script_data *sc;
     trig_data *i;
     int n;
 
+    if (type == MOB_TRIGGER)
+        sc = SCRIPT((char_data *)go);
+    else if (type == OBJ_TRIGGER)
+        sc = SCRIPT((obj_data *)go);
+    else
+        sc = SCRIPT((room_data *)go);
+
     for (n = loc, i = TRIGGERS(sc); i && i->next && (n != 0); n--, i = i->next)
         ;
 
@@ -914,6 +876,13 @@ void add_trigger(struct script_data *sc, trig_data *t, int loc)
 
     t->next_in_world = trigger_list;
     trigger_list = t;
+
+    sc->attach_type = type;
+    if (type == WLD_TRIGGER)
+        sc->attached_room = ((room_data *)go)->number;
+    else
+        sc->attached = go;
+    update_script_registry(sc);
 }
 
 ACMD(do_attach)
@@ -968,7 +937,7 @@ ACMD(do_attach)
 
         if (!SCRIPT(victim))
             CREATE(SCRIPT(victim), struct script_data, 1);
-        add_trigger(SCRIPT(victim), trig, loc);
+        add_trigger(victim, MOB_TRIGGER, trig, loc);
 
         if (IS_NPC(victim))
             send_to_char(ch, "Trigger %d (%s) attached to %s [%d].\r\n", tn, GET_TRIG_NAME(trig), GET_SHORT(victim),
@@ -1010,7 +979,7 @@ ACMD(do_attach)
 
         if (!SCRIPT(object))
             CREATE(SCRIPT(object), struct script_data, 1);
-        add_trigger(SCRIPT(object), trig, loc);
+        add_trigger(object, OBJ_TRIGGER, trig, loc);
 
         send_to_char(ch, "Trigger %d (%s) attached to %s [%d].\r\n", tn, GET_TRIG_NAME(trig),
                      (object->short_description ? object->short_description : object->name), GET_OBJ_VNUM(object));
@@ -1044,7 +1013,7 @@ ACMD(do_attach)
 
         if (!SCRIPT(room))
             CREATE(SCRIPT(room), struct script_data, 1);
-        add_trigger(SCRIPT(room), trig, loc);
+        add_trigger(room, WLD_TRIGGER, trig, loc);
 
         send_to_char(ch, "Trigger %d (%s) attached to room %d.\r\n", tn, GET_TRIG_NAME(trig), world[rnum].number);
     }
@@ -1109,6 +1078,7 @@ static int remove_trigger(struct script_data *sc, char *name)
         SCRIPT_TYPES(sc) = 0;
         for (i = TRIGGERS(sc); i; i = i->next)
             SCRIPT_TYPES(sc) |= GET_TRIG_TYPE(i);
+        update_script_registry(sc);
 
         return 1;
     } else
@@ -1800,21 +1770,21 @@ static void process_attach(void *go, struct script_data *sc, trig_data *trig, in
         }
         if (!SCRIPT(c))
             CREATE(SCRIPT(c), struct script_data, 1);
-        add_trigger(SCRIPT(c), newtrig, -1);
+        add_trigger(c, MOB_TRIGGER, newtrig, -1);
         return;
     }
 
     if (o) {
         if (!SCRIPT(o))
             CREATE(SCRIPT(o), struct script_data, 1);
-        add_trigger(SCRIPT(o), newtrig, -1);
+        add_trigger(o, OBJ_TRIGGER, newtrig, -1);
         return;
     }
 
     if (r) {
         if (!SCRIPT(r))
             CREATE(SCRIPT(r), struct script_data, 1);
-        add_trigger(SCRIPT(r), newtrig, -1);
+        add_trigger(r, WLD_TRIGGER, newtrig, -1);
         return;
     }
 }
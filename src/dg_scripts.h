@@ -169,6 +169,12 @@ struct trig_data {
     struct trig_data *next_in_world; /**< next in the global trigger list */
 };
 
+/* Registries of the scripts that script_trigger_check() and
+ * check_time_triggers() have to visit, see dg_handler.c. */
+#define SCRIPT_REG_RANDOM 0 /**< scripts with a random trigger */
+#define SCRIPT_REG_TIME 1   /**< scripts with a time trigger   */
+#define NUM_SCRIPT_REGS 2
+
 /** a complete script (composed of several triggers) */
 struct script_data {
     long types;                        /**< bitvector of trigger types */
@@ -178,6 +184,16 @@ struct script_data {
     long context;                      /**< current context for statics */
 
     struct script_data *next; /**< used for purged_scripts    */
+
+    int attach_type;         /**< MOB_TRIGGER, OBJ_TRIGGER or WLD_TRIGGER */
+    void *attached;          /**< mob or obj holding the script          */
+    room_vnum attached_room; /**< room holding it; world[] entries move   */
+
+    ubyte registered;                              /**< bit per registry it is linked into */
+    zone_rnum reg_zone[NUM_SCRIPT_REGS];           /**< zone list, or NOWHERE for always */
+    unsigned long reg_pass[NUM_SCRIPT_REGS];       /**< last pass that visited it         */
+    struct script_data *reg_prev[NUM_SCRIPT_REGS]; /**< registry links                    */
+    struct script_data *reg_next[NUM_SCRIPT_REGS];
 };
 
 /* The event data for the wait command */
@@ -291,7 +307,7 @@ void find_uid_name(char *uid, char *name, size_t nlen);
 void do_sstat_room(struct char_data *ch, room_data *r);
 void do_sstat_object(char_data *ch, obj_data *j);
 void do_sstat_character(char_data *ch, char_data *k);
-void add_trigger(struct script_data *sc, trig_data *t, int loc);
+void add_trigger(void *go, int type, trig_data *t, int loc);
 void script_vlog(const char *format, va_list args);
 void script_log(const char *format, ...) __attribute__((format(printf, 1, 2)));
 char *matching_quote(char *p);
@@ -338,6 +354,10 @@ int remove_var(struct trig_var_data **var_list, char *name);
 void free_trigger(trig_data *trig);
 void extract_trigger(struct trig_data *trig);
 void extract_script(void *thing, int type);
+void update_script_registry(struct script_data *sc);
+void register_world_scripts(void);
+void run_script_registry(int reg, void (*func)(void *go, int type));
+void renum_script_registry(void);
 void extract_script_mem(struct script_memory *sc);
 void free_proto_script(void *thing, int type);
 void copy_proto_script(void *source, void *dest, int type);
@@ -23,6 +23,7 @@
 #include "shop.h"   /* for END_OF macro */
 #include "quest.h"
 #include "act.h" /* for look_at_room */
+#include "graph.h"
 
 /* Local functions, macros, defines and structs */
 
@@ -199,7 +200,7 @@ WCMD(do_wdoor)
     char field[MAX_INPUT_LENGTH], *value;
     room_data *rm;
     struct room_direction_data *newexit;
-    int dir, fd, to_room;
+    int dir, fd, to_room, old_to;
 
     const char *door_field[] = {"purge", "description", "flags", "key", "name", "room", "\n"};
 
@@ -228,6 +229,7 @@ WCMD(do_wdoor)
     }
 
     newexit = rm->dir_option[dir];
+    old_to = newexit ? newexit->to_room : NOWHERE;
 
     /* purge exit */
     if (fd == 0) {
@@ -275,6 +277,10 @@ WCMD(do_wdoor)
                 break;
         }
     }
+    /* Purging, creating or retargeting the exit can change which zones touch. */
+    if ((rm->dir_option[dir] ? rm->dir_option[dir]->to_room : NOWHERE) != old_to)
+        invalidate_zone_neighbours();
+    invalidate_pathfind_cache(real_room(rm->number));
 }
 
 WCMD(do_wteleport)
@@ -1074,6 +1074,7 @@ void set_fighting(struct char_data *ch, struct char_data *vict)
 
     FIGHTING(ch) = vict;
     GET_POS(ch) = POS_FIGHTING;
+    MSDP_DIRTY(ch, MSDP_DIRTY_COMBAT);
 
     if (!CONFIG_PK_ALLOWED)
         check_killer(ch, vict);
@@ -1090,6 +1091,7 @@ void stop_fighting(struct char_data *ch)
     REMOVE_FROM_LIST(ch, combat_list, next_fighting);
     ch->next_fighting = NULL;
     FIGHTING(ch) = NULL;
+    MSDP_DIRTY(ch, MSDP_DIRTY_COMBAT);
     GET_POS(ch) = POS_STANDING;
     update_pos(ch);
 }
@@ -32,9 +32,10 @@ int add_mobile(struct char_data *mob, mob_vnum vnum)
         copy_mobile(&mob_proto[rnum], mob);
 
         /* Now re-point all existing mobile strings to here. */
-        for (live_mob = character_list; live_mob; live_mob = live_mob->next)
-            if (rnum == live_mob->nr)
-                update_mobile_strings(live_mob, &mob_proto[rnum]);
+        for (live_mob = first_mob_instance(rnum); live_mob; live_mob = live_mob->next_instance) {
+            update_mobile_strings(live_mob, &mob_proto[rnum]);
+            name_index_update(live_mob);
+        }
 
         add_to_save_list(zone_table[real_zone_by_thing(vnum)].number, SL_MOB);
         log1("GenOLC: add_mobile: Updated existing mobile #%d.", vnum);
@@ -53,6 +54,7 @@ int add_mobile(struct char_data *mob, mob_vnum vnum)
             mob_index[i].vnum = vnum;
             mob_index[i].number = 0;
             mob_index[i].func = 0;
+            mob_index[i].mobs = NULL;
             found = i;
             break;
         }
@@ -67,6 +69,7 @@ int add_mobile(struct char_data *mob, mob_vnum vnum)
         mob_index[0].vnum = vnum;
         mob_index[0].number = 0;
         mob_index[0].func = 0;
+        mob_index[0].mobs = NULL;
     }
 
     log1("GenOLC: add_mobile: Added mobile %d at index #%d.", vnum, found);
@@ -133,6 +136,8 @@ static void extract_mobile_all(mob_vnum vnum)
                     free_proto_script(ch, MOB_TRIGGER);
                 ch->proto_script = NULL;
             }
+            /* The prototype's slot is about to be reused. */
+            mob_instance_unlink(ch);
             extract_char(ch);
         }
     }
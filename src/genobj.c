@@ -64,6 +64,7 @@ static int update_all_objects(struct obj_data *refobj)
 
         /* Copy game-time dependent variables over. */
         obj->script_id = swap.script_id;
+        SCRIPT(obj) = SCRIPT(&swap);
         IN_ROOM(obj) = swap.in_room;
         obj->carried_by = swap.carried_by;
         obj->worn_by = swap.worn_by;
@@ -72,6 +73,8 @@ static int update_all_objects(struct obj_data *refobj)
         obj->contains = swap.contains;
         obj->next_content = swap.next_content;
         obj->next = swap.next;
+        obj->next_instance = swap.next_instance;
+        obj->prev_instance = swap.prev_instance;
         obj->sitting_here = swap.sitting_here;
     }
 
@@ -168,6 +171,7 @@ obj_rnum index_object(struct obj_data *obj, obj_vnum ovnum, obj_rnum ornum)
     obj_index[ornum].vnum = ovnum;
     obj_index[ornum].number = 0;
     obj_index[ornum].func = NULL;
+    obj_index[ornum].objs = NULL;
 
     copy_object_preserve(&obj_proto[ornum], obj);
     obj_proto[ornum].in_room = NOWHERE;
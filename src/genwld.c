@@ -18,6 +18,8 @@
 #include "shop.h"
 #include "dg_olc.h"
 #include "mud_event.h"
+#include "interpreter.h"
+#include "graph.h"
 
 /* This function will copy the strings so be sure you free your own copies of
  * the description, title, and such. */
@@ -39,6 +41,8 @@ room_rnum add_room(struct room_data *room)
         copy_room(&world[i], room);
         world[i].people = tch;
         world[i].contents = tobj;
+        invalidate_zone_neighbours();
+        invalidate_pathfind_cache(i);
         add_to_save_list(zone_table[room->zone].number, SL_WLD);
         log1("GenOLC: add_room: Updated existing room #%d.", room->number);
         return i;
@@ -120,6 +124,8 @@ room_rnum add_room(struct room_data *room)
             if (W_EXIT(i, j) && W_EXIT(i, j)->to_room != NOWHERE)
                 W_EXIT(i, j)->to_room += (W_EXIT(i, j)->to_room >= found);
     } while (i > 0);
+    invalidate_zone_neighbours();
+    invalidate_pathfind_cache(NOWHERE);
 
     add_to_save_list(zone_table[room->zone].number, SL_WLD);
 
@@ -221,6 +227,8 @@ int delete_room(room_rnum rnum)
 
     /* Change any exit going to this room to go the void. Also fix all the exits
      * pointing to rooms above this. */
+    invalidate_zone_neighbours();
+    invalidate_pathfind_cache(NOWHERE);
     i = top_of_world + 1;
     do {
         i--;
@@ -10,9 +10,12 @@
 #include "structs.h"
 #include "utils.h"
 #include "db.h"
+#include "comm.h"
 #include "genolc.h"
 #include "genzon.h"
 #include "dg_scripts.h"
+#include "interpreter.h"
+#include "graph.h"
 
 /* local functions */
 static void remove_cmd_from_list(struct reset_com **list, int pos);
@@ -51,6 +54,7 @@ zone_rnum create_new_zone(zone_vnum vzone_num, room_vnum bottom, room_vnum top,
 {
     FILE *fp;
     struct zone_data *zone;
+    struct char_data *ch;
     int i, max_zone;
     zone_rnum rznum;
     char buf[MAX_STRING_LENGTH];
@@ -213,6 +217,21 @@ zone_rnum create_new_zone(zone_vnum vzone_num, room_vnum bottom, room_vnum top,
 
     top_of_zone_table++;
 
+    /* Zones after the new one moved up a slot; so do the player counts and
+     * the script registry lists, and the neighbour lists need rebuilding. */
+    zone->players = zone->connected = 0;
+    for (ch = character_list; ch; ch = ch->next)
+        if (ch->presence_zone != NOWHERE && ch->presence_zone >= rznum)
+            ch->presence_zone++;
+    zone->random_scripts = zone->time_scripts = NULL;
+    renum_script_registry();
+    zone->dormant = FALSE;
+    zone->empty_since = pulse;
+    zone->neighbours = NULL;
+    zone->num_neighbours = 0;
+    invalidate_zone_neighbours();
+    invalidate_pathfind_cache(NOWHERE);
+
     add_to_save_list(zone->number, SL_ZON);
     return rznum;
 }
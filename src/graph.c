@@ -23,10 +23,21 @@
 #include "fight.h"
 
 /* local functions */
+static int TRACKABLE_EDGE(room_rnum x, int y);
 static int VALID_EDGE(room_rnum x, int y);
+static void bfs_begin(void);
 static void bfs_enqueue(room_rnum room, int dir);
-static void bfs_dequeue(void);
-static void bfs_clear_queue(void);
+static void build_zone_paths(void);
+static void zone_paths_ready(void);
+static void zone_bfs(room_rnum start);
+static void zone_paths_need_hops(zone_rnum z);
+static int zone_path_search(room_rnum src, room_rnum target, int *first_dir);
+static void landmark_bfs(room_rnum start, ush_int *hops, bool reverse);
+static void build_landmarks(void);
+static int landmark_bound(room_rnum room, room_rnum target);
+static void forget_paths_through(room_rnum room);
+static void landmarks_ready(void);
+static bool flow_field_lookup(room_rnum src, room_rnum target, int *dir, int *hops);
 
 /** Helper function to validate room numbers for pathfinding operations.
  * @param room The room number to validate
@@ -112,21 +123,49 @@ struct path_state {
     int first_dir;                          /* First direction taken from start */
 };
 
-struct state_queue_struct {
-    struct path_state state;
-    struct state_queue_struct *next;
-};
-
 struct bfs_queue_struct {
     room_rnum room;
-    char dir;
-    struct bfs_queue_struct *next;
+    int dir; /* first step, or hop count for bfs_distance() */
+};
+
+/* Workspace for the key-aware search. At most MAX_VISITED_STATES states are
+   expanded and each queues one state per exit, so the queue is allocated once
+   at that size and never freed. Expanded states are found again through an
+   open addressing table of queue indexes keyed by (room, key set); like
+   bfs_stamp, an entry only counts when its stamp is the current generation. */
+#define STATE_QUEUE_SIZE (MAX_VISITED_STATES * NUM_OF_DIRS + 1)
+#define STATE_HASH_SIZE 2048 /* power of two, over twice MAX_VISITED_STATES */
+
+static struct path_state *state_queue = NULL;
+static int state_head = 0, state_tail = 0;
+static int state_visited[STATE_HASH_SIZE];
+static unsigned int state_visited_stamp[STATE_HASH_SIZE];
+static unsigned int state_generation = 0;
+
+/* Room searches share one workspace. A room counts as visited when its stamp
+   equals the current generation, so starting a search is a counter bump rather
+   than a pass over the world, and the queue is reused since no room is queued
+   twice in the same search. */
+static unsigned int *bfs_stamp = NULL;
+static unsigned int bfs_generation = 0;
+static struct bfs_queue_struct *bfs_queue = NULL;
+static int bfs_capacity = 0, bfs_head = 0, bfs_tail = 0;
+static int *bfs_hops = NULL, *bfs_first = NULL; /* per marked room: hop count or path cost, and first step */
+
+/* Binary heap shared by the weighted searches, ordered by dist. cost is the
+   node's path cost when it was pushed, so entries overtaken by a cheaper path
+   can be recognised and skipped when they surface. */
+struct path_heap_entry {
+    int dist;
+    int cost;
+    int node;
 };
 
-/* Static queues for advanced pathfinding */
-static struct state_queue_struct *state_queue_head = NULL, *state_queue_tail = NULL;
+static struct path_heap_entry *path_heap = NULL;
+static int path_heap_size = 0, path_heap_capacity = 0;
 
-static struct bfs_queue_struct *queue_head = 0, *queue_tail = 0;
+/* Bumped whenever the room graph changes; anything derived from it earlier is stale. */
+static unsigned int pathfind_cache_epoch = 0;
 
 /* Global pathfinding statistics for monitoring */
 static long pathfind_calls_total = 0;
@@ -134,19 +173,17 @@ static long pathfind_cache_hits = 0;
 static long advanced_pathfind_calls = 0;
 static long zone_optimized_calls = 0;
 static long keys_optimized_total = 0;
-
-/* Cache the current time to reduce system calls during pulse processing */
-static time_t cached_time = 0;
-static int cached_time_pulse = -1;
+static long astar_searches = 0;
+static long astar_rooms_expanded = 0;
 
 /* Advanced pathfinding function declarations */
+static void state_begin(void);
 static void state_enqueue(struct path_state *state);
 static struct path_state *state_dequeue(void);
-static void state_clear_queue(void);
 static int has_key_in_state(struct path_state *state, obj_vnum key);
 static void add_key_to_state(struct path_state *state, obj_vnum key);
 static int can_pass_door(struct char_data *ch, struct path_state *state, room_rnum from, int dir);
-static int is_state_visited(struct path_state *state, struct path_state **visited_states, int num_visited);
+static int state_mark_visited(struct path_state *state);
 static struct obj_data *find_key_in_room(room_rnum room, obj_vnum key_vnum) __attribute__((unused));
 
 /* Zone-based optimization functions */
@@ -157,126 +194,652 @@ static int get_required_keys_for_path(struct char_data *ch, room_rnum src, room_
 static int zone_has_connection_to(zone_rnum from_zone, zone_rnum to_zone);
 
 /* Cache function declarations */
+static struct pathfind_cache_entry *pathfind_cache_set(room_rnum src, room_rnum target);
 static void cache_pathfind_result_priority(room_rnum src, room_rnum target, int direction, int priority);
 
-/* Get cached time to reduce system calls - updates once per pulse */
-static time_t get_cached_time(void)
-{
-    extern unsigned long pulse; /* From comm.c */
-    if (cached_time_pulse != (int)pulse) {
-        cached_time = time(NULL);
-        cached_time_pulse = (int)pulse;
-    }
-    return cached_time;
-}
-
 /* Utility macros */
-#define MARK(room) (SET_BIT_AR(ROOM_FLAGS(room), ROOM_BFS_MARK))
-#define UNMARK(room) (REMOVE_BIT_AR(ROOM_FLAGS(room), ROOM_BFS_MARK))
-#define IS_MARKED(room) (ROOM_FLAGGED(room, ROOM_BFS_MARK))
+#define MARK(room) (bfs_stamp[(room)] = bfs_generation)
+#define IS_MARKED(room) (bfs_stamp[(room)] == bfs_generation)
 #define TOROOM(x, y) (world[(x)].dir_option[(y)]->to_room)
 #define IS_CLOSED(x, y) (EXIT_FLAGGED(world[(x)].dir_option[(y)], EX_CLOSED))
 
-static int VALID_EDGE(room_rnum x, int y)
+/* Whether tracking may follow exit y out of room x at all. */
+static int TRACKABLE_EDGE(room_rnum x, int y)
 {
     if (world[x].dir_option[y] == NULL || TOROOM(x, y) == NOWHERE)
         return 0;
     if (CONFIG_TRACK_T_DOORS == FALSE && IS_CLOSED(x, y))
         return 0;
-    if (ROOM_FLAGGED(TOROOM(x, y), ROOM_NOTRACK) || IS_MARKED(TOROOM(x, y)))
+    if (ROOM_FLAGGED(TOROOM(x, y), ROOM_NOTRACK))
         return 0;
 
     return 1;
 }
 
+static int VALID_EDGE(room_rnum x, int y) { return TRACKABLE_EDGE(x, y) && !IS_MARKED(TOROOM(x, y)); }
+
+/* Start a new room search: grow the workspace if the world grew and forget
+   every previous mark. */
+static void bfs_begin(void)
+{
+    if (top_of_world + 1 > bfs_capacity) {
+        RECREATE(bfs_stamp, unsigned int, top_of_world + 1);
+        RECREATE(bfs_queue, struct bfs_queue_struct, top_of_world + 1);
+        RECREATE(bfs_hops, int, top_of_world + 1);
+        RECREATE(bfs_first, int, top_of_world + 1);
+        memset(bfs_stamp + bfs_capacity, 0, sizeof(unsigned int) * (top_of_world + 1 - bfs_capacity));
+        bfs_capacity = top_of_world + 1;
+    }
+
+    if (++bfs_generation == 0) {
+        memset(bfs_stamp, 0, sizeof(unsigned int) * bfs_capacity);
+        bfs_generation = 1;
+    }
+
+    bfs_head = bfs_tail = 0;
+}
+
 static void bfs_enqueue(room_rnum room, int dir)
 {
-    struct bfs_queue_struct *curr;
-
-    CREATE(curr, struct bfs_queue_struct, 1);
-    curr->room = room;
-    curr->dir = dir;
-    curr->next = 0;
-
-    if (queue_tail) {
-        queue_tail->next = curr;
-        queue_tail = curr;
-    } else
-        queue_head = queue_tail = curr;
+    if (bfs_tail >= bfs_capacity) {
+        log1("SYSERR: bfs_enqueue overflow at room %d, search workspace holds %d rooms", room, bfs_capacity);
+        return;
+    }
+    bfs_queue[bfs_tail].room = room;
+    bfs_queue[bfs_tail++].dir = dir;
 }
 
-static void bfs_dequeue(void)
+/* Zone-level path abstraction. Border rooms - those with an exit into another
+   zone or reached by one - are the nodes of an abstract graph whose edges are
+   the cross-zone exits plus, inside each zone, the hop counts between its
+   borders. For every border a zone caches the hop count to each of its rooms
+   without leaving the zone, so a query between two zones runs one room search
+   inside the source zone and then Dijkstra over the borders alone. Since every
+   path splits into in-zone stretches between borders, the hop counts match a
+   plain room search exactly. */
+struct zone_paths {
+    room_rnum first, last; /* rnum range holding the zone's rooms */
+    int num_borders;
+    room_rnum *borders; /* in rnum order */
+    int node_base;      /* abstract node of borders[0] */
+    int *hops;          /* num_borders rows over first..last, -1 when unreachable; NULL until needed */
+};
+
+static struct zone_paths *zone_paths = NULL;
+static int num_zone_paths = 0;
+static int zone_paths_rooms = 0;     /* top_of_world + 1 when the borders were collected */
+static bool zone_paths_stale = TRUE; /* border sets need collecting again */
+static int *room_path_node = NULL;   /* abstract node of each room, -1 when not a border */
+static room_rnum *path_node_room = NULL;
+static int num_path_nodes = 0;
+
+/* Dijkstra workspace over the abstract nodes, with one extra node for the target. */
+static int *path_node_dist = NULL, *path_node_first = NULL;
+
+/* Collect every zone's border rooms and number them as abstract nodes. Zones
+   whose border set is unchanged keep their cached hop counts. */
+static void build_zone_paths(void)
 {
-    struct bfs_queue_struct *curr;
+    struct zone_paths *old = zone_paths;
+    int num_old = num_zone_paths, rooms = top_of_world + 1;
+    room_rnum r, to;
+    zone_rnum z;
+    int dir, n;
+
+    if (num_old != top_of_zone_table + 1 || zone_paths_rooms != rooms) {
+        for (z = 0; z < num_old; z++) {
+            free(old[z].borders);
+            free(old[z].hops);
+        }
+        free(old);
+        old = NULL;
+        num_old = 0;
+    }
+
+    num_zone_paths = top_of_zone_table + 1;
+    CREATE(zone_paths, struct zone_paths, MAX(num_zone_paths, 1));
+    for (z = 0; z < num_zone_paths; z++)
+        zone_paths[z].first = zone_paths[z].last = NOWHERE;
+
+    RECREATE(room_path_node, int, MAX(rooms, 1));
+    memset(room_path_node, 0, sizeof(int) * MAX(rooms, 1));
+
+    /* Flag both ends of each cross-zone exit, whether or not it can be tracked right now. */
+    for (r = 0; r < rooms; r++) {
+        z = world[r].zone;
+        if (z == NOWHERE || z >= num_zone_paths)
+            continue;
+        if (zone_paths[z].first == NOWHERE)
+            zone_paths[z].first = r;
+        zone_paths[z].last = r;
+        for (dir = 0; dir < DIR_COUNT; dir++)
+            if (world[r].dir_option[dir] && (to = TOROOM(r, dir)) != NOWHERE && to < rooms && world[to].zone != z)
+                room_path_node[r] = room_path_node[to] = 1;
+    }
+
+    for (z = 0; z < num_zone_paths; z++) {
+        n = 0;
+        if (zone_paths[z].first != NOWHERE)
+            for (r = zone_paths[z].first; r <= zone_paths[z].last; r++)
+                if (room_path_node[r] && world[r].zone == z)
+                    n++;
+        zone_paths[z].num_borders = n;
+        if (n)
+            CREATE(zone_paths[z].borders, room_rnum, n);
+        n = 0;
+        if (zone_paths[z].first != NOWHERE)
+            for (r = zone_paths[z].first; r <= zone_paths[z].last; r++)
+                if (room_path_node[r] && world[r].zone == z)
+                    zone_paths[z].borders[n++] = r;
+
+        if (z < num_old && old[z].hops && old[z].num_borders == n && old[z].first == zone_paths[z].first &&
+            old[z].last == zone_paths[z].last && !memcmp(old[z].borders, zone_paths[z].borders, sizeof(room_rnum) * n)) {
+            zone_paths[z].hops = old[z].hops;
+            old[z].hops = NULL;
+        }
+    }
 
-    curr = queue_head;
+    for (z = 0; z < num_old; z++) {
+        free(old[z].borders);
+        free(old[z].hops);
+    }
+    free(old);
+
+    for (num_path_nodes = 0, z = 0; z < num_zone_paths; z++) {
+        zone_paths[z].node_base = num_path_nodes;
+        num_path_nodes += zone_paths[z].num_borders;
+    }
+    RECREATE(path_node_room, room_rnum, MAX(num_path_nodes, 1));
+    RECREATE(path_node_dist, int, num_path_nodes + 1);
+    RECREATE(path_node_first, int, num_path_nodes + 1);
+
+    for (r = 0; r < rooms; r++)
+        room_path_node[r] = -1;
+    for (z = 0; z < num_zone_paths; z++)
+        for (n = 0; n < zone_paths[z].num_borders; n++) {
+            r = zone_paths[z].borders[n];
+            room_path_node[r] = zone_paths[z].node_base + n;
+            path_node_room[zone_paths[z].node_base + n] = r;
+        }
+
+    zone_paths_rooms = rooms;
+    zone_paths_stale = FALSE;
+}
 
-    if (!(queue_head = queue_head->next))
-        queue_tail = 0;
-    free(curr);
+static void zone_paths_ready(void)
+{
+    if (zone_paths_stale || zone_paths_rooms != top_of_world + 1 || num_zone_paths != top_of_zone_table + 1)
+        build_zone_paths();
 }
 
-static void bfs_clear_queue(void)
+/* Room search from start that never leaves its zone, leaving the hop count
+   and first step of every room it reaches in bfs_hops and bfs_first. */
+static void zone_bfs(room_rnum start)
 {
-    int cleared = 0;
-    while (queue_head && cleared < 10000) { /* Safety limit to prevent infinite loops */
-        bfs_dequeue();
-        cleared++;
+    zone_rnum zone = world[start].zone;
+    room_rnum room, to;
+    int dir;
+
+    bfs_begin();
+    MARK(start);
+    bfs_hops[start] = 0;
+    bfs_first[start] = -1;
+    bfs_enqueue(start, -1);
+
+    while (bfs_head < bfs_tail) {
+        room = bfs_queue[bfs_head++].room;
+        for (dir = 0; dir < DIR_COUNT; dir++) {
+            if (!VALID_EDGE(room, dir))
+                continue;
+            to = TOROOM(room, dir);
+            if (world[to].zone != zone)
+                continue;
+            MARK(to);
+            bfs_hops[to] = bfs_hops[room] + 1;
+            bfs_first[to] = room == start ? dir : bfs_first[room];
+            bfs_enqueue(to, dir);
+        }
     }
-    if (cleared >= 10000) {
-        log1("SYSERR: bfs_clear_queue exceeded safety limit, possible memory corruption");
+}
+
+/* Fill in a zone's border-to-room hop counts if an exit change dropped them. */
+static void zone_paths_need_hops(zone_rnum z)
+{
+    struct zone_paths *zp = &zone_paths[z];
+    int span, i;
+    room_rnum r;
+
+    if (zp->hops || !zp->num_borders)
+        return;
+
+    span = zp->last - zp->first + 1;
+    CREATE(zp->hops, int, zp->num_borders * span);
+    for (i = 0; i < zp->num_borders; i++) {
+        zone_bfs(zp->borders[i]);
+        for (r = zp->first; r <= zp->last; r++)
+            zp->hops[i * span + (r - zp->first)] = IS_MARKED(r) ? bfs_hops[r] : -1;
     }
 }
 
-/* Advanced state-based pathfinding functions */
+static void path_heap_push(int dist, int cost, int node)
+{
+    int i, parent;
 
-static void state_enqueue(struct path_state *state)
+    if (path_heap_size >= path_heap_capacity) {
+        path_heap_capacity = MAX(path_heap_capacity * 2, 64);
+        RECREATE(path_heap, struct path_heap_entry, path_heap_capacity);
+    }
+
+    for (i = path_heap_size++; i > 0; i = parent) {
+        parent = (i - 1) / 2;
+        if (path_heap[parent].dist <= dist)
+            break;
+        path_heap[i] = path_heap[parent];
+    }
+    path_heap[i].dist = dist;
+    path_heap[i].cost = cost;
+    path_heap[i].node = node;
+}
+
+static struct path_heap_entry path_heap_pop(void)
 {
-    struct state_queue_struct *curr;
+    struct path_heap_entry top = path_heap[0], last = path_heap[--path_heap_size];
+    int i = 0, child;
 
-    CREATE(curr, struct state_queue_struct, 1);
-    curr->state = *state; /* Copy the state */
-    curr->next = NULL;
+    while ((child = 2 * i + 1) < path_heap_size) {
+        if (child + 1 < path_heap_size && path_heap[child + 1].dist < path_heap[child].dist)
+            child++;
+        if (last.dist <= path_heap[child].dist)
+            break;
+        path_heap[i] = path_heap[child];
+        i = child;
+    }
+    if (path_heap_size)
+        path_heap[i] = last;
 
-    if (state_queue_tail) {
-        state_queue_tail->next = curr;
-        state_queue_tail = curr;
-    } else {
-        state_queue_head = state_queue_tail = curr;
+    return top;
+}
+
+static void zone_path_relax(int node, int dist, int first)
+{
+    if (path_node_dist[node] >= 0 && path_node_dist[node] <= dist)
+        return;
+    path_node_dist[node] = dist;
+    path_node_first[node] = first;
+    path_heap_push(dist, dist, node);
+}
+
+/* Shortest path between rooms of different zones over the border graph.
+   Returns the hop count and sets *first_dir, or BFS_NO_PATH. */
+static int zone_path_search(room_rnum src, room_rnum target, int *first_dir)
+{
+    struct path_heap_entry top;
+    struct zone_paths *zp, *goal_zone;
+    zone_rnum zs = world[src].zone, zt = world[target].zone, z;
+    int goal, i, h, dir, span, first;
+    room_rnum room, to;
+
+    zone_paths_ready();
+    if (zs == NOWHERE || zt == NOWHERE || zs >= num_zone_paths || zt >= num_zone_paths)
+        return BFS_NO_PATH;
+
+    goal_zone = &zone_paths[zt];
+    zone_paths_need_hops(zt);
+    if (!goal_zone->num_borders || !zone_paths[zs].num_borders)
+        return BFS_NO_PATH;
+
+    goal = num_path_nodes;
+    for (i = 0; i <= goal; i++)
+        path_node_dist[i] = -1;
+    path_heap_size = 0;
+
+    /* Seed every border of the source zone with its in-zone distance from src. */
+    zone_bfs(src);
+    zp = &zone_paths[zs];
+    for (i = 0; i < zp->num_borders; i++)
+        if (IS_MARKED(zp->borders[i]))
+            zone_path_relax(zp->node_base + i, bfs_hops[zp->borders[i]], bfs_first[zp->borders[i]]);
+
+    while (path_heap_size) {
+        top = path_heap_pop();
+        if (top.node == goal) {
+            *first_dir = path_node_first[goal];
+            return top.dist;
+        }
+        if (top.dist > path_node_dist[top.node])
+            continue;
+
+        room = path_node_room[top.node];
+        z = world[room].zone;
+        zp = &zone_paths[z];
+        zone_paths_need_hops(z);
+        span = zp->last - zp->first + 1;
+        i = top.node - zp->node_base;
+
+        if (z == zt && (h = goal_zone->hops[i * span + (target - zp->first)]) >= 0)
+            zone_path_relax(goal, top.dist + h, path_node_first[top.node]);
+
+        for (dir = 0; dir < DIR_COUNT; dir++) {
+            if (!TRACKABLE_EDGE(room, dir) || world[to = TOROOM(room, dir)].zone == z || room_path_node[to] < 0)
+                continue;
+            first = path_node_first[top.node] < 0 ? dir : path_node_first[top.node];
+            zone_path_relax(room_path_node[to], top.dist + 1, first);
+        }
+
+        /* Leaving src itself through its own zone is already covered by the seeds. */
+        if (path_node_first[top.node] < 0)
+            continue;
+        for (h = 0; h < zp->num_borders; h++)
+            if (h != i && zp->hops[i * span + (zp->borders[h] - zp->first)] > 0)
+                zone_path_relax(zp->node_base + h, top.dist + zp->hops[i * span + (zp->borders[h] - zp->first)],
+                                path_node_first[top.node]);
     }
+
+    return BFS_NO_PATH;
 }
 
-static struct path_state *state_dequeue(void)
+/* Landmark (ALT) lower bounds for the A* search. Hop counts to and from a few
+   spread-out landmark rooms are taken over every exit into a trackable room,
+   ignoring doors, so by the triangle inequality they bound the hops between
+   any two rooms whatever state the doors are in, and only go stale when exits
+   or NOTRACK flags change. */
+#define PATH_LANDMARKS 16
+#define LANDMARK_UNREACHED USHRT_MAX
+
+static ush_int *landmark_from[PATH_LANDMARKS]; /* hops from the landmark to each room */
+static ush_int *landmark_to[PATH_LANDMARKS];   /* hops from each room to the landmark */
+static int num_landmarks = 0, landmark_rooms = 0;
+static bool landmarks_stale = TRUE;
+static int *room_pred_start = NULL; /* rooms with an exit into room r are room_preds[start[r] .. start[r + 1]) */
+static room_rnum *room_preds = NULL;
+
+/* Hop counts over exits into trackable rooms from start, or into start when reverse is set. */
+static void landmark_bfs(room_rnum start, ush_int *hops, bool reverse)
 {
-    struct state_queue_struct *curr;
-    static struct path_state result;
+    room_rnum room, to;
+    int i, end;
+
+    for (i = 0; i < landmark_rooms; i++)
+        hops[i] = LANDMARK_UNREACHED;
+
+    bfs_begin();
+    MARK(start);
+    hops[start] = 0;
+    bfs_enqueue(start, 0);
+
+    while (bfs_head < bfs_tail) {
+        room = bfs_queue[bfs_head++].room;
+        end = reverse ? room_pred_start[room + 1] : DIR_COUNT;
+        for (i = reverse ? room_pred_start[room] : 0; i < end; i++) {
+            if (reverse)
+                to = room_preds[i];
+            else if (!world[room].dir_option[i] || (to = TOROOM(room, i)) == NOWHERE || to > top_of_world ||
+                     ROOM_FLAGGED(to, ROOM_NOTRACK))
+                continue;
+            if (IS_MARKED(to))
+                continue;
+            MARK(to);
+            hops[to] = MIN(hops[room] + 1, LANDMARK_UNREACHED - 1);
+            bfs_enqueue(to, 0);
+        }
+    }
+}
 
-    if (!state_queue_head)
-        return NULL;
+/* Pick landmarks by farthest-point selection, treating rooms no landmark
+   reaches yet as farthest so that every part of a split world gets one. */
+static void build_landmarks(void)
+{
+    int rooms = top_of_world + 1, i, best, *nearest;
+    room_rnum r, to;
+    int dir;
+
+    if (rooms != landmark_rooms)
+        for (i = 0; i < PATH_LANDMARKS; i++) {
+            free(landmark_from[i]);
+            free(landmark_to[i]);
+            landmark_from[i] = landmark_to[i] = NULL;
+        }
+    landmark_rooms = rooms;
+
+    RECREATE(room_pred_start, int, rooms + 1);
+    memset(room_pred_start, 0, sizeof(int) * (rooms + 1));
+    for (r = 0; r < rooms; r++)
+        for (dir = 0; dir < DIR_COUNT; dir++)
+            if (world[r].dir_option[dir] && (to = TOROOM(r, dir)) != NOWHERE && to < rooms &&
+                !ROOM_FLAGGED(to, ROOM_NOTRACK))
+                room_pred_start[to + 1]++;
+    for (r = 0; r < rooms; r++)
+        room_pred_start[r + 1] += room_pred_start[r];
+    RECREATE(room_preds, room_rnum, MAX(room_pred_start[rooms], 1));
+    CREATE(nearest, int, MAX(rooms, 1));
+    for (r = 0; r < rooms; r++)
+        for (dir = 0; dir < DIR_COUNT; dir++)
+            if (world[r].dir_option[dir] && (to = TOROOM(r, dir)) != NOWHERE && to < rooms &&
+                !ROOM_FLAGGED(to, ROOM_NOTRACK))
+                room_preds[room_pred_start[to] + nearest[to]++] = r;
+
+    for (r = 0; r < rooms; r++)
+        nearest[r] = INT_MAX;
+
+    for (num_landmarks = 0; num_landmarks < PATH_LANDMARKS && rooms > 0; num_landmarks++) {
+        for (best = 0, r = 1; r < rooms; r++)
+            if (nearest[r] > nearest[best])
+                best = r;
+        if (!nearest[best])
+            break;
+
+        if (!landmark_from[num_landmarks]) {
+            CREATE(landmark_from[num_landmarks], ush_int, rooms);
+            CREATE(landmark_to[num_landmarks], ush_int, rooms);
+        }
+        landmark_bfs(best, landmark_from[num_landmarks], FALSE);
+        landmark_bfs(best, landmark_to[num_landmarks], TRUE);
+        nearest[best] = 0;
+        for (r = 0; r < rooms; r++)
+            if (landmark_from[num_landmarks][r] != LANDMARK_UNREACHED)
+                nearest[r] = MIN(nearest[r], landmark_from[num_landmarks][r]);
+    }
+
+    free(nearest);
+    landmarks_stale = FALSE;
+}
+
+/* Lower bound on the hops from room to target, or -1 when the landmarks
+   prove that room cannot reach target at all. */
+static int landmark_bound(room_rnum room, room_rnum target)
+{
+    int i, a, b, bound = 0;
+
+    for (i = 0; i < num_landmarks; i++) {
+        a = landmark_from[i][room];
+        b = landmark_from[i][target];
+        if (a != LANDMARK_UNREACHED) {
+            if (b == LANDMARK_UNREACHED)
+                return -1;
+            bound = MAX(bound, b - a);
+        }
+        a = landmark_to[i][room];
+        b = landmark_to[i][target];
+        if (b != LANDMARK_UNREACHED) {
+            if (a == LANDMARK_UNREACHED)
+                return -1;
+            bound = MAX(bound, a - b);
+        }
+    }
+
+    return bound;
+}
+
+static void landmarks_ready(void)
+{
+    if (landmarks_stale || landmark_rooms != top_of_world + 1)
+        build_landmarks();
+}
+
+/* Flow fields. Many mobs head for the same few rooms - posts, banks,
+   questmasters, whoever is being hunted - so once a target is asked for often
+   enough, one reverse BFS from it records every room's next step and hop count
+   toward it, and find_first_step()/bfs_distance() answer from that for any
+   source. Targets are counted with a heavy-hitter sketch: a query takes over
+   its counter slot only after wearing down the target holding it. Fields are
+   shared by every mob asking, carry the number of queries they served, and are
+   rebuilt on their next use once the room graph changes. A full invalidation
+   (renumbered world or a new track_through_doors value) frees every slot. */
+struct flow_field {
+    room_rnum target;       /* NOWHERE for a free slot */
+    unsigned int epoch;     /* pathfind_cache_epoch when built */
+    unsigned int last_used; /* flow_field_clock at the last query */
+    long uses;              /* queries served since the field was claimed */
+    int rooms;              /* top_of_world + 1 when built */
+    sbyte *dir;             /* next step toward target, -1 when it cannot be reached */
+    ush_int *hops;          /* hop count to target */
+};
+
+struct flow_counter {
+    room_rnum target;
+    int count;
+};
+
+static struct flow_field flow_fields[FLOW_FIELDS];
+static struct flow_counter flow_counters[FLOW_COUNTERS];
+static bool flow_fields_initialised = FALSE;
+static unsigned int flow_field_clock = 0;
+static long flow_field_hits = 0;
+
+/* Reverse BFS from the field's target over the exits tracking may follow. */
+static void build_flow_field(struct flow_field *field)
+{
+    room_rnum room, from, target = field->target;
+    int i, dir, rooms = top_of_world + 1;
+
+    landmarks_ready();
+    if (field->rooms != rooms) {
+        RECREATE(field->dir, sbyte, rooms);
+        RECREATE(field->hops, ush_int, rooms);
+        field->rooms = rooms;
+    }
+    memset(field->dir, -1, sizeof(sbyte) * rooms);
+
+    bfs_begin();
+    MARK(target);
+    field->hops[target] = 0;
+    bfs_enqueue(target, 0);
+
+    while (bfs_head < bfs_tail) {
+        room = bfs_queue[bfs_head++].room;
+        for (i = room_pred_start[room]; i < room_pred_start[room + 1]; i++) {
+            if (IS_MARKED(from = room_preds[i]))
+                continue;
+            for (dir = 0; dir < DIR_COUNT; dir++)
+                if (TRACKABLE_EDGE(from, dir) && TOROOM(from, dir) == room)
+                    break;
+            if (dir == DIR_COUNT)
+                continue;
+            MARK(from);
+            field->dir[from] = dir;
+            field->hops[from] = MIN(field->hops[room] + 1, USHRT_MAX);
+            bfs_enqueue(from, 0);
+        }
+    }
+
+    field->epoch = pathfind_cache_epoch;
+}
+
+/* Count a query for target and answer it from a flow field if target is hot.
+   Returns FALSE when the caller has to search; otherwise *dir is the first
+   step or BFS_NO_PATH, and *hops (if given) the distance. */
+static bool flow_field_lookup(room_rnum src, room_rnum target, int *dir, int *hops)
+{
+    struct flow_counter *counter;
+    struct flow_field *field = NULL;
+    int i;
 
-    curr = state_queue_head;
-    result = curr->state; /* Copy the state */
+    if (!flow_fields_initialised) {
+        for (i = 0; i < FLOW_FIELDS; i++)
+            flow_fields[i].target = NOWHERE;
+        for (i = 0; i < FLOW_COUNTERS; i++)
+            flow_counters[i].target = NOWHERE;
+        flow_fields_initialised = TRUE;
+    }
 
-    if (!(state_queue_head = state_queue_head->next))
-        state_queue_tail = NULL;
+    for (i = 0; i < FLOW_FIELDS; i++)
+        if (flow_fields[i].target == target) {
+            field = flow_fields + i;
+            break;
+        }
 
-    free(curr);
-    return &result;
+    if (!field) {
+        counter = flow_counters + (target & (FLOW_COUNTERS - 1));
+        if (counter->target == target)
+            counter->count++;
+        else if (counter->count > 0)
+            counter->count--;
+        else {
+            counter->target = target;
+            counter->count = 1;
+        }
+        if (counter->target != target || counter->count < FLOW_FIELD_HOT)
+            return FALSE;
+
+        /* Hot: take over the least recently used field. */
+        counter->count = 0;
+        for (field = flow_fields, i = 1; i < FLOW_FIELDS; i++)
+            if (flow_fields[i].target == NOWHERE ||
+                (field->target != NOWHERE && flow_fields[i].last_used < field->last_used))
+                field = flow_fields + i;
+        field->target = target;
+        field->uses = 0;
+        build_flow_field(field);
+    } else if (field->epoch != pathfind_cache_epoch || field->rooms != top_of_world + 1)
+        build_flow_field(field);
+
+    field->last_used = ++flow_field_clock;
+    field->uses++;
+    flow_field_hits++;
+
+    if (field->dir[src] < 0) {
+        *dir = BFS_NO_PATH;
+        return TRUE;
+    }
+    *dir = field->dir[src];
+    if (hops)
+        *hops = field->hops[src];
+    return TRUE;
 }
 
-static void state_clear_queue(void)
+/* Advanced state-based pathfinding functions */
+
+/* Start a key-aware search: empty the queue and forget every expanded state. */
+static void state_begin(void)
 {
-    int cleared = 0;
-    while (state_queue_head && cleared < 10000) { /* Safety limit to prevent infinite loops */
-        struct state_queue_struct *curr = state_queue_head;
-        state_queue_head = state_queue_head->next;
-        free(curr);
-        cleared++;
+    if (!state_queue)
+        CREATE(state_queue, struct path_state, STATE_QUEUE_SIZE);
+
+    if (++state_generation == 0) {
+        memset(state_visited_stamp, 0, sizeof(state_visited_stamp));
+        state_generation = 1;
     }
-    if (cleared >= 10000) {
-        log1("SYSERR: state_clear_queue exceeded safety limit, possible memory corruption");
+
+    state_head = state_tail = 0;
+}
+
+static void state_enqueue(struct path_state *state)
+{
+    if (state_tail >= STATE_QUEUE_SIZE) {
+        log1("SYSERR: state_enqueue overflow at room %d, queue holds %d states", state->room, STATE_QUEUE_SIZE);
+        return;
     }
-    state_queue_tail = NULL;
+    state_queue[state_tail++] = *state;
+}
+
+/* The state stays in the queue until the next search, so the pointer can be
+   kept and the visited table can refer to it. */
+static struct path_state *state_dequeue(void)
+{
+    if (state_head >= state_tail)
+        return NULL;
+
+    return &state_queue[state_head++];
 }
 
 static int has_key_in_state(struct path_state *state, obj_vnum key)
@@ -289,15 +852,22 @@ static int has_key_in_state(struct path_state *state, obj_vnum key)
     return 0;
 }
 
+/* Keys are kept sorted, so two states hold the same key set exactly when
+   their key arrays match. */
 static void add_key_to_state(struct path_state *state, obj_vnum key)
 {
+    int i;
+
     if (state->num_keys >= MAX_COLLECTED_KEYS)
         return; /* Cannot add more keys */
 
-    if (!has_key_in_state(state, key)) {
-        state->collected_keys[state->num_keys] = key;
-        state->num_keys++;
-    }
+    if (has_key_in_state(state, key))
+        return;
+
+    for (i = state->num_keys; i > 0 && state->collected_keys[i - 1] > key; i--)
+        state->collected_keys[i] = state->collected_keys[i - 1];
+    state->collected_keys[i] = key;
+    state->num_keys++;
 }
 
 static int can_pass_door(struct char_data *ch, struct path_state *state, room_rnum from, int dir)
@@ -325,25 +895,28 @@ static int can_pass_door(struct char_data *ch, struct path_state *state, room_rn
     return has_key_in_state(state, exit->key);
 }
 
-static int is_state_visited(struct path_state *state, struct path_state **visited_states, int num_visited)
+/* Returns 1 if a state in the same room with the same keys was already
+   expanded in this search, otherwise records state, which must be in the
+   queue, and returns 0. */
+static int state_mark_visited(struct path_state *state)
 {
-    int i, j;
-
-    for (i = 0; i < num_visited; i++) {
-        if (visited_states[i]->room == state->room && visited_states[i]->num_keys == state->num_keys) {
-
-            /* Check if key sets are the same */
-            int keys_match = 1;
-            for (j = 0; j < state->num_keys; j++) {
-                if (!has_key_in_state(visited_states[i], state->collected_keys[j])) {
-                    keys_match = 0;
-                    break;
-                }
-            }
-            if (keys_match)
-                return 1;
-        }
+    struct path_state *seen;
+    unsigned int hash = (unsigned int)state->room * 2654435761u;
+    int i, slot;
+
+    for (i = 0; i < state->num_keys; i++)
+        hash = (hash ^ (unsigned int)state->collected_keys[i]) * 16777619u;
+
+    for (slot = hash & (STATE_HASH_SIZE - 1); state_visited_stamp[slot] == state_generation;
+         slot = (slot + 1) & (STATE_HASH_SIZE - 1)) {
+        seen = &state_queue[state_visited[slot]];
+        if (seen->room == state->room && seen->num_keys == state->num_keys &&
+            !memcmp(seen->collected_keys, state->collected_keys, sizeof(int) * state->num_keys))
+            return 1;
     }
+
+    state_visited_stamp[slot] = state_generation;
+    state_visited[slot] = state - state_queue;
     return 0;
 }
 
@@ -369,8 +942,9 @@ static struct obj_data *find_key_in_room(room_rnum room, obj_vnum key_vnum)
  */
 static int zone_has_connection_to(zone_rnum from_zone, zone_rnum to_zone)
 {
-    room_rnum nr, to_room;
-    int first, last, j;
+    struct zone_paths *zp;
+    room_rnum to_room;
+    int i, j;
 
     if (from_zone == NOWHERE || to_zone == NOWHERE || from_zone > top_of_zone_table || to_zone > top_of_zone_table)
         return 0;
@@ -382,23 +956,16 @@ static int zone_has_connection_to(zone_rnum from_zone, zone_rnum to_zone)
     if (from_zone == to_zone)
         return 1; /* Same zone is always connected */
 
-    /* Get room range for the source zone */
-    first = zone_table[from_zone].bot;
-    last = zone_table[from_zone].top;
-
-    /* Check all rooms in the source zone for exits to target zone */
-    for (nr = 0; nr <= top_of_world && (GET_ROOM_VNUM(nr) <= last); nr++) {
-        if (GET_ROOM_VNUM(nr) >= first) {
-            for (j = 0; j < DIR_COUNT; j++) {
-                if (world[nr].dir_option[j]) {
-                    to_room = world[nr].dir_option[j]->to_room;
-                    if (to_room != NOWHERE && world[to_room].zone == to_zone) {
-                        return 1; /* Found direct connection */
-                    }
-                }
+    /* Only the source zone's border rooms can have exits into another zone */
+    zone_paths_ready();
+    zp = &zone_paths[from_zone];
+    for (i = 0; i < zp->num_borders; i++)
+        for (j = 0; j < DIR_COUNT; j++)
+            if (world[zp->borders[i]].dir_option[j]) {
+                to_room = world[zp->borders[i]].dir_option[j]->to_room;
+                if (to_room != NOWHERE && to_room <= top_of_world && world[to_room].zone == to_zone)
+                    return 1; /* Found direct connection */
             }
-        }
-    }
 
     return 0; /* No direct connection found */
 }
@@ -565,10 +1132,8 @@ static int count_keys_in_zones(zone_rnum *zones, int num_zones)
 static int get_required_keys_for_path(struct char_data *ch, room_rnum src, room_rnum target, obj_vnum *required_keys,
                                       int max_keys)
 {
-    static room_rnum visited[1000];
-    static room_rnum queue[1000];
     static obj_vnum found_keys[MAX_COLLECTED_KEYS];
-    int visited_count = 0, queue_head = 0, queue_tail = 0;
+    int visited_count = 0;
     int key_count = 0;
     room_rnum current_room;
     int i, dir;
@@ -580,17 +1145,17 @@ static int get_required_keys_for_path(struct char_data *ch, room_rnum src, room_
         return 0;
 
     /* Initialize */
-    for (i = 0; i < 1000; i++)
-        visited[i] = NOWHERE;
+    bfs_begin();
     for (i = 0; i < MAX_COLLECTED_KEYS; i++)
         found_keys[i] = NOTHING;
 
     /* Start BFS */
-    queue[queue_tail++] = src;
-    visited[visited_count++] = src;
+    bfs_enqueue(src, 0);
+    MARK(src);
+    visited_count++;
 
-    while (queue_head < queue_tail && visited_count < 1000 && key_count < max_keys) {
-        current_room = queue[queue_head++];
+    while (bfs_head < bfs_tail && visited_count < 1000 && key_count < max_keys) {
+        current_room = bfs_queue[bfs_head++].room;
 
         if (current_room == target) {
             /* Found target, copy found keys */
@@ -610,14 +1175,7 @@ static int get_required_keys_for_path(struct char_data *ch, room_rnum src, room_
                 continue;
 
             /* Check if already visited */
-            int already_visited = 0;
-            for (i = 0; i < visited_count; i++) {
-                if (visited[i] == next_room) {
-                    already_visited = 1;
-                    break;
-                }
-            }
-            if (already_visited)
+            if (IS_MARKED(next_room))
                 continue;
 
             struct room_direction_data *exit = world[current_room].dir_option[dir];
@@ -650,9 +1208,10 @@ static int get_required_keys_for_path(struct char_data *ch, room_rnum src, room_
             if (!IS_SET(exit->exit_info, EX_CLOSED) || !IS_SET(exit->exit_info, EX_LOCKED) ||
                 (exit->key != NOTHING && has_key(ch, exit->key))) {
 
-                if (visited_count < 1000 && queue_tail < 1000) {
-                    queue[queue_tail++] = next_room;
-                    visited[visited_count++] = next_room;
+                if (visited_count < 1000) {
+                    bfs_enqueue(next_room, 0);
+                    MARK(next_room);
+                    visited_count++;
                 }
             }
         }
@@ -677,9 +1236,7 @@ obj_vnum find_blocking_key(struct char_data *ch, room_rnum src, room_rnum target
     if (src == target)
         return NOTHING;
 
-    /* Clear marks first */
-    for (curr_room = 0; curr_room <= top_of_world; curr_room++)
-        UNMARK(curr_room);
+    bfs_begin();
 
     MARK(src);
 
@@ -706,10 +1263,8 @@ obj_vnum find_blocking_key(struct char_data *ch, room_rnum src, room_rnum target
         }
     }
 
-    /* If no immediate blocking key found, do a simple BFS to find first blocking door */
-    bfs_clear_queue();
-
-    /* Enqueue first valid steps */
+    /* If no immediate blocking key found, do a simple BFS to find first blocking door,
+       starting from the first valid steps */
     for (curr_dir = 0; curr_dir < DIR_COUNT; curr_dir++) {
         if (VALID_EDGE(src, curr_dir)) {
             MARK(TOROOM(src, curr_dir));
@@ -718,11 +1273,10 @@ obj_vnum find_blocking_key(struct char_data *ch, room_rnum src, room_rnum target
     }
 
     /* BFS to find target or first blocking door */
-    while (queue_head) {
-        curr_room = queue_head->room;
+    while (bfs_head < bfs_tail) {
+        curr_room = bfs_queue[bfs_head].room;
 
         if (curr_room == target) {
-            bfs_clear_queue();
             return NOTHING; /* Path exists without key blocking */
         }
 
@@ -741,7 +1295,6 @@ obj_vnum find_blocking_key(struct char_data *ch, room_rnum src, room_rnum target
                 IS_SET(exit->exit_info, EX_LOCKED)) {
 
                 if (exit->key != NOTHING && !has_key(ch, exit->key)) {
-                    bfs_clear_queue();
                     return exit->key; /* Found blocking key */
                 }
             }
@@ -750,10 +1303,10 @@ obj_vnum find_blocking_key(struct char_data *ch, room_rnum src, room_rnum target
             if (!IS_SET(exit->exit_info, EX_CLOSED) || !IS_SET(exit->exit_info, EX_LOCKED) ||
                 (exit->key != NOTHING && has_key(ch, exit->key))) {
                 MARK(next_room);
-                bfs_enqueue(next_room, queue_head->dir);
+                bfs_enqueue(next_room, bfs_queue[bfs_head].dir);
             }
         }
-        bfs_dequeue();
+        bfs_head++;
     }
 
     return NOTHING; /* No blocking key found */
@@ -766,7 +1319,6 @@ obj_vnum find_blocking_key(struct char_data *ch, room_rnum src, room_rnum target
 int find_first_step(room_rnum src, room_rnum target)
 {
     int curr_dir;
-    room_rnum curr_room;
 
     if (src == NOWHERE || target == NOWHERE || src > top_of_world || target > top_of_world) {
         log1("SYSERR: Illegal value %d or %d passed to find_first_step. (%s)", src, target, __FILE__);
@@ -775,9 +1327,14 @@ int find_first_step(room_rnum src, room_rnum target)
     if (src == target)
         return (BFS_ALREADY_THERE);
 
-    /* clear marks first, some OLC systems will save the mark. */
-    for (curr_room = 0; curr_room <= top_of_world; curr_room++)
-        UNMARK(curr_room);
+    /* Popular targets are answered from their flow field, and rooms in
+       different zones are searched over the zone border graph instead. */
+    if (flow_field_lookup(src, target, &curr_dir, NULL))
+        return (curr_dir);
+    if (world[src].zone != world[target].zone)
+        return (zone_path_search(src, target, &curr_dir) < 0 ? BFS_NO_PATH : curr_dir);
+
+    bfs_begin();
 
     MARK(src);
 
@@ -789,18 +1346,17 @@ int find_first_step(room_rnum src, room_rnum target)
         }
 
     /* now, do the classic BFS. */
-    while (queue_head) {
-        if (queue_head->room == target) {
-            curr_dir = queue_head->dir;
-            bfs_clear_queue();
+    while (bfs_head < bfs_tail) {
+        if (bfs_queue[bfs_head].room == target) {
+            curr_dir = bfs_queue[bfs_head].dir;
             return (curr_dir);
         } else {
             for (curr_dir = 0; curr_dir < DIR_COUNT; curr_dir++)
-                if (VALID_EDGE(queue_head->room, curr_dir)) {
-                    MARK(TOROOM(queue_head->room, curr_dir));
-                    bfs_enqueue(TOROOM(queue_head->room, curr_dir), queue_head->dir);
+                if (VALID_EDGE(bfs_queue[bfs_head].room, curr_dir)) {
+                    MARK(TOROOM(bfs_queue[bfs_head].room, curr_dir));
+                    bfs_enqueue(TOROOM(bfs_queue[bfs_head].room, curr_dir), bfs_queue[bfs_head].dir);
                 }
-            bfs_dequeue();
+            bfs_head++;
         }
     }
 
@@ -813,7 +1369,6 @@ int find_first_step(room_rnum src, room_rnum target)
 int bfs_distance(room_rnum src, room_rnum target)
 {
     int curr_dir;
-    room_rnum curr_room;
     int distance = 0;
 
     if (src == NOWHERE || target == NOWHERE || src > top_of_world || target > top_of_world) {
@@ -823,9 +1378,12 @@ int bfs_distance(room_rnum src, room_rnum target)
     if (src == target)
         return (0); /* Already there - distance is 0 */
 
-    /* clear marks first */
-    for (curr_room = 0; curr_room <= top_of_world; curr_room++)
-        UNMARK(curr_room);
+    if (flow_field_lookup(src, target, &curr_dir, &distance))
+        return (curr_dir < 0 ? curr_dir : distance);
+    if (world[src].zone != world[target].zone)
+        return (zone_path_search(src, target, &curr_dir));
+
+    bfs_begin();
 
     MARK(src);
 
@@ -837,31 +1395,36 @@ int bfs_distance(room_rnum src, room_rnum target)
         }
 
     /* BFS with distance tracking */
-    while (queue_head) {
-        if (queue_head->room == target) {
-            distance = queue_head->dir; /* dir field contains distance */
-            bfs_clear_queue();
+    while (bfs_head < bfs_tail) {
+        if (bfs_queue[bfs_head].room == target) {
+            distance = bfs_queue[bfs_head].dir; /* dir field contains distance */
             return (distance);
         } else {
-            int next_distance = queue_head->dir + 1;
+            int next_distance = bfs_queue[bfs_head].dir + 1;
             for (curr_dir = 0; curr_dir < DIR_COUNT; curr_dir++)
-                if (VALID_EDGE(queue_head->room, curr_dir)) {
-                    MARK(TOROOM(queue_head->room, curr_dir));
-                    bfs_enqueue(TOROOM(queue_head->room, curr_dir), next_distance);
+                if (VALID_EDGE(bfs_queue[bfs_head].room, curr_dir)) {
+                    MARK(TOROOM(bfs_queue[bfs_head].room, curr_dir));
+                    bfs_enqueue(TOROOM(bfs_queue[bfs_head].room, curr_dir), next_distance);
                 }
-            bfs_dequeue();
+            bfs_head++;
         }
     }
 
     return (BFS_NO_PATH);
 }
 
-/* Enhanced pathfinding that considers movement costs and MV availability
- * Returns the first direction to take, and sets total_cost to the total MV needed for the path */
+/* Enhanced pathfinding that considers movement costs and MV availability.
+ * A* over the rooms, where entering a room costs calculate_movement_cost() and
+ * the landmark hop bound times the cheapest step cost guides the search.
+ * Returns the first direction of the cheapest path and sets total_cost to the
+ * MV it takes to walk all of it. */
 int find_first_step_enhanced(struct char_data *ch, room_rnum src, room_rnum target, int *total_cost)
 {
-    int curr_dir;
-    room_rnum curr_room;
+    struct path_heap_entry top;
+    int step_cost[NUM_ROOM_SECTORS], min_step = INT_MAX;
+    float weather_modifier;
+    room_rnum room, to;
+    int curr_dir, cost, bound;
 
     *total_cost = 0; /* Initialize total cost */
 
@@ -872,39 +1435,53 @@ int find_first_step_enhanced(struct char_data *ch, room_rnum src, room_rnum targ
     if (src == target)
         return (BFS_ALREADY_THERE);
 
-    /* clear marks first, some OLC systems will save the mark. */
-    for (curr_room = 0; curr_room <= top_of_world; curr_room++)
-        UNMARK(curr_room);
+    astar_searches++;
+    landmarks_ready();
+    if ((bound = landmark_bound(src, target)) < 0)
+        return (BFS_NO_PATH);
 
-    MARK(src);
-
-    /* first, enqueue the first steps, saving which direction we're going and movement cost */
-    for (curr_dir = 0; curr_dir < DIR_COUNT; curr_dir++)
-        if (VALID_EDGE(src, curr_dir)) {
-            room_rnum next_room = TOROOM(src, curr_dir);
+    /* calculate_movement_cost() only varies with the sector for one character */
+    weather_modifier = get_weather_movement_modifier(ch);
+    for (curr_dir = 0; curr_dir < NUM_ROOM_SECTORS; curr_dir++) {
+        step_cost[curr_dir] = MAX((int)(movement_loss[curr_dir] * weather_modifier), 1);
+        min_step = MIN(min_step, step_cost[curr_dir]);
+    }
 
-            MARK(next_room);
-            bfs_enqueue(next_room, curr_dir);
+    /* bfs_hops holds each reached room's path cost (-1 once proven a dead end)
+       and bfs_first its first step. */
+    bfs_begin();
+    path_heap_size = 0;
+    MARK(src);
+    bfs_hops[src] = 0;
+    bfs_first[src] = -1;
+    path_heap_push(bound * min_step, 0, src);
+
+    while (path_heap_size) {
+        top = path_heap_pop();
+        room = top.node;
+        if (top.cost != bfs_hops[room])
+            continue;
+        astar_rooms_expanded++;
+        if (room == target) {
+            *total_cost = top.cost;
+            return (bfs_first[room]);
         }
 
-    /* now, do BFS looking for target */
-    while (queue_head) {
-        if (queue_head->room == target) {
-            curr_dir = queue_head->dir;
-
-            /* Calculate total cost for this path by tracing back */
-            /* For now, we'll use a simple approximation based on the target room cost */
-            *total_cost = calculate_movement_cost(ch, target);
-
-            bfs_clear_queue();
-            return (curr_dir);
-        } else {
-            for (curr_dir = 0; curr_dir < DIR_COUNT; curr_dir++)
-                if (VALID_EDGE(queue_head->room, curr_dir)) {
-                    MARK(TOROOM(queue_head->room, curr_dir));
-                    bfs_enqueue(TOROOM(queue_head->room, curr_dir), queue_head->dir);
-                }
-            bfs_dequeue();
+        for (curr_dir = 0; curr_dir < DIR_COUNT; curr_dir++) {
+            if (!TRACKABLE_EDGE(room, curr_dir))
+                continue;
+            to = TOROOM(room, curr_dir);
+            cost = top.cost + step_cost[SECT(to)];
+            if (IS_MARKED(to) && (bfs_hops[to] < 0 || bfs_hops[to] <= cost))
+                continue;
+            MARK(to);
+            if ((bound = landmark_bound(to, target)) < 0) {
+                bfs_hops[to] = -1;
+                continue;
+            }
+            bfs_hops[to] = cost;
+            bfs_first[to] = room == src ? curr_dir : bfs_first[room];
+            path_heap_push(cost + bound * min_step, cost, to);
         }
     }
 
@@ -918,8 +1495,7 @@ int find_path_with_keys(struct char_data *ch, room_rnum src, room_rnum target, i
                         char **path_description)
 {
     struct path_state initial_state, *current_state;
-    struct path_state **visited_states;
-    int num_visited = 0, max_visited = MAX_VISITED_STATES;
+    int num_visited = 0;
     int curr_dir, i, iterations = 0;
     char *desc_buffer;
 
@@ -991,11 +1567,8 @@ int find_path_with_keys(struct char_data *ch, room_rnum src, room_rnum target, i
         }
     }
 
-    /* Initialize visited states tracking */
-    CREATE(visited_states, struct path_state *, max_visited);
-
-    /* Clear state queue */
-    state_clear_queue();
+    /* Empty the state queue and the visited states */
+    state_begin();
 
     /* Initialize starting state with optimized key limit */
     initial_state.room = src;
@@ -1079,26 +1652,15 @@ int find_path_with_keys(struct char_data *ch, room_rnum src, room_rnum target, i
                 strcat(desc_buffer, ")");
             }
 
-            /* Cleanup */
-            for (i = 0; i < num_visited; i++)
-                if (visited_states[i])
-                    free(visited_states[i]);
-            free(visited_states);
-            state_clear_queue();
             return current_state->first_dir;
         }
 
         /* Check if this state has been visited with same or better conditions */
-        if (is_state_visited(current_state, visited_states, num_visited))
+        if (state_mark_visited(current_state))
             continue;
 
-        /* Add to visited states - only if we have space */
-        if (num_visited < max_visited) {
-            CREATE(visited_states[num_visited], struct path_state, 1);
-            *(visited_states[num_visited]) = *current_state;
-            num_visited++;
-        } else {
-            /* Too many states visited, abort to prevent memory issues */
+        /* Too many states visited, abort to bound the search */
+        if (++num_visited > MAX_VISITED_STATES) {
             strcat(desc_buffer, "Busca muito complexa, abortada por segurança.");
             break;
         }
@@ -1185,13 +1747,6 @@ int find_path_with_keys(struct char_data *ch, room_rnum src, room_rnum target, i
         strcat(desc_buffer, "Nenhum caminho encontrado.");
     }
 
-    /* Cleanup */
-    for (i = 0; i < num_visited; i++)
-        if (visited_states[i])
-            free(visited_states[i]);
-    free(visited_states);
-    state_clear_queue();
-
     return (BFS_NO_PATH);
 }
 
@@ -1413,23 +1968,73 @@ ACMD(do_track)
 struct pathfind_cache_entry {
     room_rnum src;
     room_rnum target;
-    time_t timestamp;
+    unsigned int epoch;     /* pathfind_cache_epoch when stored; older entries are stale */
+    unsigned int last_used; /* pathfind_cache_clock at the last store or hit */
     int direction;
     int valid;
     int priority; /* 0 = normal, 1 = duty-related (shopkeeper/sentinel returning to post) */
 };
 
-static struct pathfind_cache_entry pathfind_cache[PATHFIND_CACHE_SIZE];
-static int pathfind_cache_initialized = 0;
+#define PATHFIND_CACHE_SETS (PATHFIND_CACHE_SIZE / PATHFIND_CACHE_WAYS)
 
-static void init_pathfind_cache(void)
+static struct pathfind_cache_entry pathfind_cache[PATHFIND_CACHE_SIZE];
+static unsigned int pathfind_cache_clock = 0;
+
+/* Any change to exits, to_room links or NOTRACK flags can change a first step,
+   so everything cached before it is dropped at once by moving to a new epoch.
+   The zone abstraction only forgets the hop counts of the changed room's zone,
+   and collects border rooms again when the room leads into another zone.
+   NOWHERE means rooms or zones were added, removed or renumbered, or that a
+   rule TRACKABLE_EDGE() reads changed, such as track_through_doors; every
+   zone's hop counts and border set are dropped then. */
+static void forget_paths_through(room_rnum room)
 {
-    int i;
-    for (i = 0; i < PATHFIND_CACHE_SIZE; i++) {
-        pathfind_cache[i].valid = 0;
-        pathfind_cache[i].priority = 0;
+    room_rnum to;
+    zone_rnum z;
+    int dir, i;
+
+    pathfind_cache_epoch++;
+
+    if (room == NOWHERE || room > top_of_world || world[room].zone >= num_zone_paths) {
+        for (z = 0; z < num_zone_paths; z++) {
+            free(zone_paths[z].hops);
+            zone_paths[z].hops = NULL;
+        }
+        zone_paths_rooms = 0;
+        zone_paths_stale = TRUE;
+        /* Flow fields and their counters are keyed by room number and were
+           built with the old tracking rule: give every slot back. */
+        if (flow_fields_initialised) {
+            for (i = 0; i < FLOW_FIELDS; i++)
+                flow_fields[i].target = NOWHERE;
+            for (i = 0; i < FLOW_COUNTERS; i++) {
+                flow_counters[i].target = NOWHERE;
+                flow_counters[i].count = 0;
+            }
+        }
+        return;
     }
-    pathfind_cache_initialized = 1;
+
+    free(zone_paths[world[room].zone].hops);
+    zone_paths[world[room].zone].hops = NULL;
+    for (dir = 0; dir < DIR_COUNT; dir++)
+        if (world[room].dir_option[dir] && (to = TOROOM(room, dir)) != NOWHERE && to <= top_of_world &&
+            world[to].zone != world[room].zone)
+            zone_paths_stale = TRUE;
+}
+
+void invalidate_pathfind_cache(room_rnum room)
+{
+    landmarks_stale = TRUE;
+    forget_paths_through(room);
+}
+
+/* Opening or closing a door only matters when tracking stops at closed doors,
+   and never moves the landmarks, which ignore doors. */
+void pathfind_door_changed(room_rnum room)
+{
+    if (CONFIG_TRACK_T_DOORS == FALSE)
+        forget_paths_through(room);
 }
 
 /* Getter functions for pathfinding statistics */
@@ -1439,36 +2044,58 @@ long get_pathfind_cache_hits(void) { return pathfind_cache_hits; }
 
 long get_advanced_pathfind_calls(void) { return advanced_pathfind_calls; }
 
+long get_flow_field_hits(void) { return flow_field_hits; }
+
+long get_astar_searches(void) { return astar_searches; }
+
+long get_astar_rooms_expanded(void) { return astar_rooms_expanded; }
+
+int get_flow_fields_live(void)
+{
+    int i, live = 0;
+
+    if (flow_fields_initialised)
+        for (i = 0; i < FLOW_FIELDS; i++)
+            if (flow_fields[i].target != NOWHERE)
+                live++;
+    return live;
+}
+
 int get_pathfind_cache_valid_entries(void)
 {
     int valid_entries = 0;
-    if (pathfind_cache_initialized) {
-        for (int i = 0; i < PATHFIND_CACHE_SIZE; i++) {
-            if (pathfind_cache[i].valid) {
-                valid_entries++;
-            }
+    for (int i = 0; i < PATHFIND_CACHE_SIZE; i++) {
+        if (pathfind_cache[i].valid && pathfind_cache[i].epoch == pathfind_cache_epoch) {
+            valid_entries++;
         }
     }
     return valid_entries;
 }
 
+/* First entry of the set that (src, target) hashes into. */
+static struct pathfind_cache_entry *pathfind_cache_set(room_rnum src, room_rnum target)
+{
+    unsigned int hash = (unsigned int)src * 2654435761u ^ (unsigned int)target * 40503u;
+
+    hash ^= hash >> 15;
+    return pathfind_cache + (hash & (PATHFIND_CACHE_SETS - 1)) * PATHFIND_CACHE_WAYS;
+}
+
 static int get_cached_pathfind(room_rnum src, room_rnum target)
 {
+    struct pathfind_cache_entry *set;
     int i;
-    time_t now = get_cached_time(); /* Use cached time instead of system call */
-
-    if (!pathfind_cache_initialized)
-        return -1;
 
     /* Validate src and target rooms */
     if (!is_valid_room(src) || !is_valid_room(target))
         return -1;
 
-    for (i = 0; i < PATHFIND_CACHE_SIZE; i++) {
-        if (pathfind_cache[i].valid && pathfind_cache[i].src == src && pathfind_cache[i].target == target &&
-            (now - pathfind_cache[i].timestamp) < PATHFIND_CACHE_TTL) {
+    set = pathfind_cache_set(src, target);
+    for (i = 0; i < PATHFIND_CACHE_WAYS; i++) {
+        if (set[i].valid && set[i].src == src && set[i].target == target && set[i].epoch == pathfind_cache_epoch) {
+            set[i].last_used = ++pathfind_cache_clock;
             pathfind_cache_hits++;
-            return pathfind_cache[i].direction;
+            return set[i].direction;
         }
     }
     return -1;
@@ -1484,6 +2111,9 @@ static void cache_pathfind_result(room_rnum src, room_rnum target, int direction
 
 static void cache_pathfind_result_priority(room_rnum src, room_rnum target, int direction, int priority)
 {
+    struct pathfind_cache_entry *set, *victim = NULL, *low_victim = NULL;
+    int i;
+
     /* Don't cache failed pathfinding results to preserve cache slots for successful paths */
     if (direction < 0) {
         return;
@@ -1494,47 +2124,31 @@ static void cache_pathfind_result_priority(room_rnum src, room_rnum target, int
         return;
     }
 
-    int i, oldest_idx = 0;
-    time_t now = get_cached_time(); /* Use cached time instead of system call */
-    time_t oldest_time = now;
-    int found_low_priority = 0;
+    set = pathfind_cache_set(src, target);
 
-    if (!pathfind_cache_initialized)
-        init_pathfind_cache();
-
-    /* First pass: Find empty slot or lowest priority entry that can be replaced */
-    for (i = 0; i < PATHFIND_CACHE_SIZE; i++) {
-        if (!pathfind_cache[i].valid) {
-            oldest_idx = i;
-            found_low_priority = 1;
+    /* Reuse the entry for this pair or a free/stale one; otherwise evict the least recently used entry,
+     * sparing duty entries when a duty result needs the room. */
+    for (i = 0; i < PATHFIND_CACHE_WAYS; i++) {
+        if (!set[i].valid || set[i].epoch != pathfind_cache_epoch || (set[i].src == src && set[i].target == target)) {
+            victim = set + i;
             break;
         }
-        /* If this is a high priority entry, prefer replacing low priority entries */
-        if (priority > 0 && pathfind_cache[i].priority == 0) {
-            if (!found_low_priority || pathfind_cache[i].timestamp < oldest_time) {
-                oldest_time = pathfind_cache[i].timestamp;
-                oldest_idx = i;
-                found_low_priority = 1;
-            }
-        }
-    }
-
-    /* Second pass: If no low priority entries found, find the oldest entry */
-    if (!found_low_priority) {
-        for (i = 0; i < PATHFIND_CACHE_SIZE; i++) {
-            if (pathfind_cache[i].timestamp < oldest_time) {
-                oldest_time = pathfind_cache[i].timestamp;
-                oldest_idx = i;
-            }
-        }
-    }
-
-    pathfind_cache[oldest_idx].src = src;
-    pathfind_cache[oldest_idx].target = target;
-    pathfind_cache[oldest_idx].direction = direction;
-    pathfind_cache[oldest_idx].timestamp = now;
-    pathfind_cache[oldest_idx].valid = 1;
-    pathfind_cache[oldest_idx].priority = priority;
+        if (!victim || set[i].last_used < victim->last_used)
+            victim = set + i;
+        if (set[i].priority == 0 && (!low_victim || set[i].last_used < low_victim->last_used))
+            low_victim = set + i;
+    }
+
+    if (i == PATHFIND_CACHE_WAYS && priority > 0 && low_victim)
+        victim = low_victim;
+
+    victim->src = src;
+    victim->target = target;
+    victim->direction = direction;
+    victim->epoch = pathfind_cache_epoch;
+    victim->last_used = ++pathfind_cache_clock;
+    victim->valid = 1;
+    victim->priority = priority;
 }
 
 /* Enhanced pathfind command for comprehensive pathfinding analysis - improved for players */
@@ -1718,7 +2332,7 @@ int calculate_mv_recovery_time(struct char_data *ch, int mv_needed)
 /**
  * Special pathfinding for mobs returning to duty posts (shopkeepers/sentinels).
  * Uses high priority caching and bypasses cache limitations for critical duty paths.
- * Returns the best direction or -1 if no path found.
+ * Returns the best direction, -1 if no search was made, or the BFS code when no path exists.
  */
 int mob_duty_pathfind(struct char_data *ch, room_rnum target_room)
 {
@@ -1747,7 +2361,8 @@ int mob_duty_pathfind(struct char_data *ch, room_rnum target_room)
     } else {
         /* NPCs no longer use advanced pathfinding to prevent bottlenecks */
         /* Advanced pathfinding is reserved for players only via the track command */
-        chosen_dir = -1;
+        /* Pass the BFS code on: the search was complete, so another one cannot succeed */
+        chosen_dir = basic_dir;
     }
 
     return chosen_dir;
@@ -1756,7 +2371,7 @@ int mob_duty_pathfind(struct char_data *ch, room_rnum target_room)
 /**
  * Intelligent pathfinding comparison for mobs.
  * Compares basic vs advanced pathfinding and chooses the most efficient method.
- * Returns the best direction or -1 if no path found.
+ * Returns the best direction, -1 if no search was made, or the BFS code when no path exists.
  */
 int mob_smart_pathfind(struct char_data *ch, room_rnum target_room)
 {
@@ -1795,7 +2410,8 @@ int mob_smart_pathfind(struct char_data *ch, room_rnum target_room)
     } else {
         /* NPCs no longer use advanced pathfinding to prevent bottlenecks */
         /* Advanced pathfinding is reserved for players only via the track command */
-        chosen_dir = -1;
+        /* Pass the BFS code on: the search was complete, so another one cannot succeed */
+        chosen_dir = basic_dir;
     }
 
     /* Cache the result */
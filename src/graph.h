@@ -15,9 +15,14 @@
 #define _GRAPH_H_
 
 /* Pathfinding cache constants */
-/* Simple pathfinding cache to reduce redundant calculations */
-#define PATHFIND_CACHE_SIZE 100 /* Reduced from 1000 to minimize linear search overhead */
-#define PATHFIND_CACHE_TTL 120  /* Cache entries valid for 2 minutes to reduce recomputation */
+/* First steps are cached by (src, target) in sets of PATHFIND_CACHE_WAYS entries, so a lookup only probes one set
+ * however large the cache is. Entries stay valid until the room graph changes. */
+#define PATHFIND_CACHE_SIZE 16384 /* Total entries; PATHFIND_CACHE_SIZE / PATHFIND_CACHE_WAYS must be a power of two */
+#define PATHFIND_CACHE_WAYS 4     /* Entries per set, evicted least recently used first */
+/* Targets queried often get a flow field: one reverse BFS answering find_first_step() for every source room. */
+#define FLOW_FIELDS 32       /* Fields kept at once, least recently used replaced first */
+#define FLOW_FIELD_HOT 8     /* Net queries for a target in its counter slot before it gets a field */
+#define FLOW_COUNTERS 1024   /* Query counter slots, shared by targets hashing alike; must be a power of two */
 ACMD(do_track);
 ACMD(do_pathfind);
 void hunt_victim(struct char_data *ch);
@@ -44,5 +49,14 @@ long get_pathfind_calls_total(void);
 long get_pathfind_cache_hits(void);
 long get_advanced_pathfind_calls(void);
 int get_pathfind_cache_valid_entries(void);
+long get_flow_field_hits(void);
+long get_astar_searches(void);
+long get_astar_rooms_expanded(void);
+int get_flow_fields_live(void);
+
+/* Pathfinding cache invalidation; pass NOWHERE when the world was renumbered
+   or track_through_doors changed. */
+void invalidate_pathfind_cache(room_rnum room);
+void pathfind_door_changed(room_rnum room);
 
 #endif /* _GRAPH_H_*/
@@ -37,6 +37,7 @@ static struct list_data *pending_group_cleanup = NULL;
 static int apply_ac(struct char_data *ch, int eq_pos);
 static void update_object(struct obj_data *obj, int use);
 static void affect_modify_ar(struct char_data *ch, byte loc, sbyte mod, int bitv[], bool add);
+static int name_bucket(const char *keyword);
 
 char *fname(const char *namelist)
 {
@@ -327,6 +328,8 @@ void affect_total(struct char_data *ch)
             GET_STR(ch) = 18;
         }
     }
+
+    MSDP_DIRTY(ch, MSDP_DIRTY_STATUS);
 }
 
 /* Insert an affect_type in a char_data structure. Automatically sets
@@ -483,6 +486,7 @@ void char_from_room(struct char_data *ch)
     REMOVE_FROM_LIST(ch, world[IN_ROOM(ch)].people, next_in_room);
     IN_ROOM(ch) = NOWHERE;
     ch->next_in_room = NULL;
+    update_zone_presence(ch);
 
     /* Room-local visibility ends when the character leaves the room. */
     if (IS_NPC(ch))
@@ -519,6 +523,10 @@ void char_to_room(struct char_data *ch, room_rnum room)
         ch->next_in_room = world[room].people;
         world[room].people = ch;
         IN_ROOM(ch) = room;
+        update_zone_presence(ch);
+        if (SCRIPT(ch))
+            update_script_registry(SCRIPT(ch));
+        MSDP_DIRTY(ch, MSDP_DIRTY_ROOM);
 
         /* Check for escort quest completion */
         if (!IS_NPC(ch) && GET_QUEST_TYPE(ch) == AQ_MOB_ESCORT) {
@@ -551,6 +559,7 @@ void obj_to_char(struct obj_data *object, struct char_data *ch)
         IN_ROOM(object) = NOWHERE;
         IS_CARRYING_W(ch) += GET_OBJ_WEIGHT(object);
         IS_CARRYING_N(ch)++;
+        MSDP_DIRTY(ch, MSDP_DIRTY_STATUS);
 
         autoquest_trigger_check(ch, NULL, object, AQ_OBJ_FIND);
 
@@ -578,6 +587,7 @@ void obj_from_char(struct obj_data *object)
 
     IS_CARRYING_W(object->carried_by) -= GET_OBJ_WEIGHT(object);
     IS_CARRYING_N(object->carried_by)--;
+    MSDP_DIRTY(object->carried_by, MSDP_DIRTY_STATUS);
     object->carried_by = NULL;
     object->next_content = NULL;
 }
@@ -743,15 +753,59 @@ struct obj_data *get_obj_in_list_num(int num, struct obj_data *list)
 }
 
 /* search the entire world for an object number, and return a pointer  */
-struct obj_data *get_obj_num(obj_rnum nr)
+struct obj_data *get_obj_num(obj_rnum nr) { return (first_obj_instance(nr)); }
+
+/* Every live object made from a prototype is on that prototype's list of
+ * instances, newest first, as mobs are (see mob_instance_link()).  Where a
+ * copy is comes from its own in_room, carried_by, worn_by and in_obj, so
+ * moving it around does not touch the list; read_object() links it and
+ * extract_obj() unlinks it. */
+void obj_instance_link(struct obj_data *obj)
 {
-    struct obj_data *i;
+    struct index_data *index = &obj_index[GET_OBJ_RNUM(obj)];
 
-    for (i = object_list; i; i = i->next)
-        if (GET_OBJ_RNUM(i) == nr)
-            return (i);
+    obj->prev_instance = NULL;
+    obj->next_instance = index->objs;
+    if (index->objs)
+        index->objs->prev_instance = obj;
+    index->objs = obj;
+}
 
-    return (NULL);
+/* Safe to call on an object that is not linked. */
+void obj_instance_unlink(struct obj_data *obj)
+{
+    if (obj->prev_instance)
+        obj->prev_instance->next_instance = obj->next_instance;
+    else if (GET_OBJ_RNUM(obj) != NOTHING && GET_OBJ_RNUM(obj) <= top_of_objt &&
+             obj_index[GET_OBJ_RNUM(obj)].objs == obj)
+        obj_index[GET_OBJ_RNUM(obj)].objs = obj->next_instance;
+    if (obj->next_instance)
+        obj->next_instance->prev_instance = obj->prev_instance;
+    obj->next_instance = obj->prev_instance = NULL;
+}
+
+struct obj_data *first_obj_instance(obj_rnum nr)
+{
+    if (nr == NOTHING || nr > top_of_objt)
+        return (NULL);
+    return (obj_index[nr].objs);
+}
+
+/* The room an object is in, looking through any containers it is inside:
+ * the room the outermost one lies in, or the room of whoever carries or
+ * wears it.  If holder is given it is set to that character, or NULL. */
+room_rnum obj_location(struct obj_data *obj, struct char_data **holder)
+{
+    struct char_data *ch;
+
+    while (obj->in_obj)
+        obj = obj->in_obj;
+
+    ch = obj->carried_by ? obj->carried_by : obj->worn_by;
+    if (holder)
+        *holder = ch;
+
+    return (ch ? IN_ROOM(ch) : IN_ROOM(obj));
 }
 
 /* Check if a character already has an object with the specified vnum in inventory or equipment */
@@ -801,13 +855,207 @@ struct char_data *get_char_room(char *name, int *number, room_rnum room)
 }
 
 /* search all over the world for a char num, and return a pointer if found */
-struct char_data *get_char_num(mob_rnum nr)
+struct char_data *get_char_num(mob_rnum nr) { return (first_mob_instance(nr)); }
+
+/* Every live mob is on its prototype's list of instances, newest first (the
+ * same order as character_list), so a search for a given mob only visits
+ * the copies of that mob.  Walk it with first_mob_instance() and
+ * next_instance.  read_mobile() links each mob and extract_char_final()
+ * unlinks it. */
+void mob_instance_link(struct char_data *mob)
 {
-    struct char_data *i;
+    struct index_data *index = &mob_index[GET_MOB_RNUM(mob)];
 
-    for (i = character_list; i; i = i->next)
-        if (GET_MOB_RNUM(i) == nr)
-            return (i);
+    mob->prev_instance = NULL;
+    mob->next_instance = index->mobs;
+    if (index->mobs)
+        index->mobs->prev_instance = mob;
+    index->mobs = mob;
+}
+
+/* Safe to call on a mob that is not linked. */
+void mob_instance_unlink(struct char_data *mob)
+{
+    if (mob->prev_instance)
+        mob->prev_instance->next_instance = mob->next_instance;
+    else if (GET_MOB_RNUM(mob) != NOBODY && GET_MOB_RNUM(mob) <= top_of_mobt &&
+             mob_index[GET_MOB_RNUM(mob)].mobs == mob)
+        mob_index[GET_MOB_RNUM(mob)].mobs = mob->next_instance;
+    if (mob->next_instance)
+        mob->next_instance->prev_instance = mob->prev_instance;
+    mob->next_instance = mob->prev_instance = NULL;
+}
+
+struct char_data *first_mob_instance(mob_rnum nr)
+{
+    if (nr == NOBODY || nr > top_of_mobt)
+        return (NULL);
+    return (mob_index[nr].mobs);
+}
+
+/* mobile_activity() runs one of PULSE_MOBILE slices per pulse.  Each live mob
+ * sits on the list of its slice (script id modulo PULSE_MOBILE, which never
+ * changes once assigned) so a pulse only walks its own mobs.  Linked and
+ * unlinked alongside the instance list. */
+static struct char_data *mob_slices[PULSE_MOBILE];
+
+void mob_slice_link(struct char_data *mob)
+{
+    int slice = char_script_id(mob) % PULSE_MOBILE;
+
+    mob->prev_in_slice = NULL;
+    mob->next_in_slice = mob_slices[slice];
+    if (mob_slices[slice])
+        mob_slices[slice]->prev_in_slice = mob;
+    mob_slices[slice] = mob;
+}
+
+/* Safe to call on a mob that is not linked. */
+void mob_slice_unlink(struct char_data *mob)
+{
+    if (mob->prev_in_slice)
+        mob->prev_in_slice->next_in_slice = mob->next_in_slice;
+    else if (mob->script_id > 0 && mob_slices[mob->script_id % PULSE_MOBILE] == mob)
+        mob_slices[mob->script_id % PULSE_MOBILE] = mob->next_in_slice;
+    if (mob->next_in_slice)
+        mob->next_in_slice->prev_in_slice = mob->prev_in_slice;
+    mob->next_in_slice = mob->prev_in_slice = NULL;
+}
+
+struct char_data *first_slice_mob(int slice)
+{
+    if (slice < 0 || slice >= PULSE_MOBILE)
+        return (NULL);
+    return (mob_slices[slice]);
+}
+
+/* The name index holds every keyword in the name list of every character in
+ * character_list, hashed on its first NAME_KEY_LEN letters, so a search by
+ * keyword only has to isname() the characters in one bucket.  isname() also
+ * matches abbreviations; any word of NAME_KEY_LEN letters or more can only
+ * abbreviate keywords that start with those letters, and shorter keywords
+ * can only be matched by shorter words, which fall back to a scan of
+ * character_list.  A character's entries go to the front of their buckets
+ * together when it is added, newest first like character_list itself.
+ * name_index_add() is called where characters join character_list,
+ * name_index_remove() where they leave it, and name_index_update() when a
+ * character in the game gets a new name list. */
+#define NAME_INDEX_SIZE 1024 /* Power of two */
+#define NAME_KEY_LEN 2
+
+struct name_index_entry {
+    struct char_data *ch;
+    int bucket;
+    struct name_index_entry *prev, *next; /* In the bucket */
+    struct name_index_entry *next_key;    /* The character's other keywords */
+};
+
+static struct name_index_entry *name_index[NAME_INDEX_SIZE];
+
+static int name_bucket(const char *keyword)
+{
+    unsigned int h = 0;
+    int i;
+
+    for (i = 0; i < NAME_KEY_LEN; i++)
+        h = h * 31 + (unsigned char)LOWER(keyword[i]);
+
+    return (h & (NAME_INDEX_SIZE - 1));
+}
+
+void name_index_add(struct char_data *ch)
+{
+    struct name_index_entry *entry;
+    const char *keyword = ch->player.name;
+    size_t len;
+
+    if (!keyword)
+        return;
+
+    for (;;) {
+        keyword += strspn(keyword, WHITESPACE);
+        if (!*keyword)
+            break;
+        len = strcspn(keyword, WHITESPACE);
+
+        if (len >= NAME_KEY_LEN) {
+            CREATE(entry, struct name_index_entry, 1);
+            entry->ch = ch;
+            entry->bucket = name_bucket(keyword);
+            entry->next = name_index[entry->bucket];
+            if (entry->next)
+                entry->next->prev = entry;
+            name_index[entry->bucket] = entry;
+            entry->next_key = ch->name_keys;
+            ch->name_keys = entry;
+        }
+        keyword += len;
+    }
+}
+
+/* Safe to call on a character that is not in the index. */
+void name_index_remove(struct char_data *ch)
+{
+    struct name_index_entry *entry;
+
+    while ((entry = ch->name_keys) != NULL) {
+        ch->name_keys = entry->next_key;
+        if (entry->prev)
+            entry->prev->next = entry->next;
+        else
+            name_index[entry->bucket] = entry->next;
+        if (entry->next)
+            entry->next->prev = entry->prev;
+        free(entry);
+    }
+}
+
+/* After ch->player.name has been changed. */
+void name_index_update(struct char_data *ch)
+{
+    name_index_remove(ch);
+    name_index_add(ch);
+}
+
+/* Walk the characters in the game whose name list isname() matches name:
+ *   for (ch = first_char_named(name, &cur); ch; ch = next_char_named(&cur))
+ * The order is that of character_list, except that a renamed character
+ * counts as the newest. */
+struct char_data *first_char_named(const char *name, struct name_cursor *cur)
+{
+    cur->name = name;
+    cur->last = NULL;
+    cur->entry = NULL;
+    cur->scan = NULL;
+
+    if (name && strlen(name) >= NAME_KEY_LEN && !name[strcspn(name, WHITESPACE)])
+        cur->entry = name_index[name_bucket(name)];
+    else
+        cur->scan = character_list;
+
+    return (next_char_named(cur));
+}
+
+struct char_data *next_char_named(struct name_cursor *cur)
+{
+    struct char_data *ch;
+
+    while ((ch = cur->scan) != NULL) {
+        cur->scan = ch->next;
+        if (isname(cur->name, ch->player.name))
+            return (ch);
+    }
+
+    while (cur->entry) {
+        ch = cur->entry->ch;
+        cur->entry = cur->entry->next;
+        /* Keywords of one character that share a bucket sit together. */
+        if (ch == cur->last)
+            continue;
+        cur->last = ch;
+        if (isname(cur->name, ch->player.name))
+            return (ch);
+    }
 
     return (NULL);
 }
@@ -1001,6 +1249,7 @@ void extract_obj(struct obj_data *obj)
         extract_obj(obj->contains);
 
     REMOVE_FROM_LIST(obj, object_list, next);
+    obj_instance_unlink(obj);
 
     if (GET_OBJ_RNUM(obj) != NOTHING)
         (obj_index[GET_OBJ_RNUM(obj)].number)--;
@@ -1183,10 +1432,14 @@ void extract_char_final(struct char_data *ch)
     }
 
     char_from_room(ch);
+    name_index_remove(ch);
 
     if (IS_NPC(ch)) {
-        if (GET_MOB_RNUM(ch) != NOTHING) /* prototyped */
+        if (GET_MOB_RNUM(ch) != NOTHING) { /* prototyped */
             mob_index[GET_MOB_RNUM(ch)].number--;
+            mob_instance_unlink(ch);
+        }
+        mob_slice_unlink(ch);
         clearMemory(ch);
 
         if (SCRIPT(ch))
@@ -1299,6 +1552,7 @@ void extract_pending_chars(void)
 struct char_data *get_player_vis(struct char_data *ch, char *name, int *number, int inroom)
 {
     struct char_data *i;
+    struct name_cursor cur;
     int num;
 
     if (!number) {
@@ -1306,7 +1560,7 @@ struct char_data *get_player_vis(struct char_data *ch, char *name, int *number,
         num = get_number(&name);
     }
 
-    for (i = character_list; i; i = i->next) {
+    for (i = first_char_named(name, &cur); i; i = next_char_named(&cur)) {
         if (IS_NPC(i))
             continue;
         if (inroom == FIND_CHAR_ROOM && IN_ROOM(i) != IN_ROOM(ch))
@@ -1360,6 +1614,7 @@ struct char_data *get_char_room_vis(struct char_data *ch, char *name, int *numbe
 struct char_data *get_char_world_vis(struct char_data *ch, char *name, int *number)
 {
     struct char_data *i;
+    struct name_cursor cur;
     int num;
 
     if (!number) {
@@ -1373,11 +1628,9 @@ struct char_data *get_char_world_vis(struct char_data *ch, char *name, int *numb
     if (*number == 0)
         return get_player_vis(ch, name, NULL, 0);
 
-    for (i = character_list; i && *number; i = i->next) {
+    for (i = first_char_named(name, &cur); i && *number; i = next_char_named(&cur)) {
         if (IN_ROOM(ch) == IN_ROOM(i))
             continue;
-        if (!isname(name, i->player.name))
-            continue;
         if (!CAN_SEE(ch, i))
             continue;
         if (--(*number) != 0)
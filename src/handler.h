@@ -51,6 +51,27 @@ void update_char_objects(struct char_data *ch);
 /* characters*/
 struct char_data *get_char_room(char *name, int *num, room_rnum room);
 struct char_data *get_char_num(mob_rnum nr);
+void mob_instance_link(struct char_data *mob);
+void mob_instance_unlink(struct char_data *mob);
+struct char_data *first_mob_instance(mob_rnum nr);
+void mob_slice_link(struct char_data *mob);
+void mob_slice_unlink(struct char_data *mob);
+struct char_data *first_slice_mob(int slice);
+
+/** A walk over the characters in the game a keyword may refer to; see
+ * first_char_named(). */
+struct name_cursor {
+    const char *name;
+    struct name_index_entry *entry; /**< Next entry in the name index bucket */
+    struct char_data *scan;         /**< Next in character_list, if the name can't use the index */
+    struct char_data *last;         /**< Owner of the last entry looked at */
+};
+
+void name_index_add(struct char_data *ch);
+void name_index_remove(struct char_data *ch);
+void name_index_update(struct char_data *ch);
+struct char_data *first_char_named(const char *name, struct name_cursor *cur);
+struct char_data *next_char_named(struct name_cursor *cur);
 
 void char_from_room(struct char_data *ch);
 void char_to_room(struct char_data *ch, room_rnum room);
@@ -66,6 +87,10 @@ struct char_data *get_char_world_vis(struct char_data *ch, char *name, int *numb
 
 struct obj_data *get_obj_in_list_num(int num, struct obj_data *list);
 struct obj_data *get_obj_num(obj_rnum nr);
+void obj_instance_link(struct obj_data *obj);
+void obj_instance_unlink(struct obj_data *obj);
+struct obj_data *first_obj_instance(obj_rnum nr);
+room_rnum obj_location(struct obj_data *obj, struct char_data **holder);
 bool char_has_obj_vnum(struct char_data *ch, obj_vnum vnum);
 struct obj_data *get_obj_in_list_vis(struct char_data *ch, char *name, int *number, struct obj_data *list);
 struct obj_data *get_obj_vis(struct char_data *ch, char *name, int *num);
@@ -105,7 +130,7 @@ int generic_find(char *arg, bitvector_t bitvector, struct char_data *ch, struct
 /* prototypes from mobact.c */
 void forget(struct char_data *ch, struct char_data *victim);
 void remember(struct char_data *ch, struct char_data *victim);
-void mobile_activity(void);
+void mobile_activity(int slice);
 void mob_emotion_activity(void);
 void clearMemory(struct char_data *ch);
 
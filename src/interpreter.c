@@ -51,6 +51,13 @@ static int _parse_name(char *arg, char *name);
 static bool perform_new_char_dupe_check(struct descriptor_data *d);
 /* sort_commands utility */
 static int sort_commands_helper(const void *a, const void *b);
+/* command trie utilities */
+static struct cmd_trie_node *cmd_trie_child(struct cmd_trie_node *node, char letter, bool create);
+static struct cmd_trie_node *cmd_trie_walk(const char *str);
+static void cmd_trie_insert(int cmd);
+static void cmd_trie_carry_disabled(struct cmd_trie_node *node, char *path, int depth);
+static void free_cmd_trie(struct cmd_trie_node *node);
+static void build_command_trie(void);
 int parse_hometown(char arg);
 void hometown_menu(struct descriptor_data *d);
 
@@ -59,6 +66,25 @@ int *cmd_sort_info = NULL;
 
 struct command_info *complete_cmd_info;
 
+/* Prefix trie over complete_cmd_info, so resolving an abbreviation costs the
+   length of the input instead of a walk of the whole list. Every node keeps,
+   separately for real commands and for socials, the list positions below it
+   at which minimum_level strictly drops; the first of those a character's
+   level allows is exactly what the old first-match is_abbrev scan returned. */
+struct cmd_trie_node {
+    char letter;
+    int exact;     /* first command spelled exactly like this path, or -1 */
+    bool disabled; /* set by do_disable, kept across rebuilds by name */
+    int num_steps[2];
+    int *steps[2]; /* [0] real commands, [1] socials */
+    struct cmd_trie_node *child;
+    struct cmd_trie_node *sibling;
+};
+
+static struct cmd_trie_node *cmd_trie = NULL;
+static struct cmd_trie_node **cmd_trie_terminal = NULL; /* by command number */
+static int cmd_trie_count = 0;
+
 /* This is the Master Command List. You can put new commands in, take commands
    out, change the order they appear in, etc.  You can adjust the "priority" of
    commands simply by changing the order they appear in the command list. (For
@@ -498,6 +524,8 @@ void sort_commands(void)
         num_of_cmds++;
     num_of_cmds++; /* \n */
 
+    if (cmd_sort_info)
+        free(cmd_sort_info);
     CREATE(cmd_sort_info, int, num_of_cmds);
 
     for (a = 0; a < num_of_cmds; a++)
@@ -505,6 +533,161 @@ void sort_commands(void)
 
     /* Don't sort the RESERVED or \n entries. */
     qsort(cmd_sort_info + 1, num_of_cmds - 2, sizeof(int), sort_commands_helper);
+
+    build_command_trie();
+}
+
+static struct cmd_trie_node *cmd_trie_child(struct cmd_trie_node *node, char letter, bool create)
+{
+    struct cmd_trie_node *child;
+
+    for (child = node->child; child; child = child->sibling)
+        if (child->letter == letter)
+            return (child);
+
+    if (!create)
+        return (NULL);
+
+    CREATE(child, struct cmd_trie_node, 1);
+    child->letter = letter;
+    child->exact = -1;
+    child->sibling = node->child;
+    node->child = child;
+    return (child);
+}
+
+/* Node spelling str, or NULL when no command starts with it. */
+static struct cmd_trie_node *cmd_trie_walk(const char *str)
+{
+    struct cmd_trie_node *node = cmd_trie;
+
+    for (; node && *str; str++)
+        node = cmd_trie_child(node, *str, FALSE);
+
+    return (node);
+}
+
+/* Commands must be inserted in list order for the steps to stay sorted. */
+static void cmd_trie_insert(int cmd)
+{
+    struct cmd_trie_node *node = cmd_trie;
+    const char *c;
+    int kind = (complete_cmd_info[cmd].command_pointer == do_action);
+    int level = complete_cmd_info[cmd].minimum_level;
+
+    for (c = complete_cmd_info[cmd].command; *c; c++) {
+        node = cmd_trie_child(node, *c, TRUE);
+        if (node->num_steps[kind] &&
+            complete_cmd_info[node->steps[kind][node->num_steps[kind] - 1]].minimum_level <= level)
+            continue;
+        RECREATE(node->steps[kind], int, node->num_steps[kind] + 1);
+        node->steps[kind][node->num_steps[kind]++] = cmd;
+    }
+
+    if (node->exact < 0)
+        node->exact = cmd;
+    cmd_trie_terminal[cmd] = node;
+}
+
+/* Re-disable, in the freshly built trie, every name disabled in the old one. */
+static void cmd_trie_carry_disabled(struct cmd_trie_node *node, char *path, int depth)
+{
+    struct cmd_trie_node *child, *now;
+
+    if (node->disabled) {
+        path[depth] = '\0';
+        if ((now = cmd_trie_walk(path)) != NULL && now->exact >= 0)
+            now->disabled = TRUE;
+    }
+
+    if (depth >= MAX_INPUT_LENGTH - 1)
+        return;
+
+    for (child = node->child; child; child = child->sibling) {
+        path[depth] = child->letter;
+        cmd_trie_carry_disabled(child, path, depth + 1);
+    }
+}
+
+static void free_cmd_trie(struct cmd_trie_node *node)
+{
+    struct cmd_trie_node *next;
+
+    for (; node; node = next) {
+        next = node->sibling;
+        free_cmd_trie(node->child);
+        if (node->steps[0])
+            free(node->steps[0]);
+        if (node->steps[1])
+            free(node->steps[1]);
+        free(node);
+    }
+}
+
+static void build_command_trie(void)
+{
+    struct cmd_trie_node *old = cmd_trie;
+    char path[MAX_INPUT_LENGTH];
+    int cmd;
+
+    for (cmd_trie_count = 0; *complete_cmd_info[cmd_trie_count].command != '\n'; cmd_trie_count++)
+        ;
+
+    CREATE(cmd_trie, struct cmd_trie_node, 1);
+    cmd_trie->exact = -1;
+    if (cmd_trie_terminal)
+        free(cmd_trie_terminal);
+    CREATE(cmd_trie_terminal, struct cmd_trie_node *, MAX(cmd_trie_count, 1));
+
+    for (cmd = 0; cmd < cmd_trie_count; cmd++)
+        cmd_trie_insert(cmd);
+
+    if (old) {
+        cmd_trie_carry_disabled(old, path, 0);
+        free_cmd_trie(old);
+    }
+}
+
+/* First command in list order that arg abbreviates and a character of the
+   given level may use, among socials or among everything else; -1 if none. */
+int find_command_abbrev(const char *arg, int level, bool social)
+{
+    struct cmd_trie_node *node;
+    int i, kind = social ? 1 : 0;
+
+    if (!*arg)
+        return (-1);
+
+    if (!cmd_trie) {
+        for (i = 0; *complete_cmd_info[i].command != '\n'; i++)
+            if ((complete_cmd_info[i].command_pointer == do_action) == social &&
+                !strncmp(complete_cmd_info[i].command, arg, strlen(arg)) && level >= complete_cmd_info[i].minimum_level)
+                return (i);
+        return (-1);
+    }
+
+    if ((node = cmd_trie_walk(arg)) == NULL)
+        return (-1);
+
+    for (i = 0; i < node->num_steps[kind]; i++)
+        if (level >= complete_cmd_info[node->steps[kind][i]].minimum_level)
+            return (node->steps[kind][i]);
+
+    return (-1);
+}
+
+bool is_command_disabled(int cmd)
+{
+    if (cmd < 0 || cmd >= cmd_trie_count || !cmd_trie_terminal)
+        return (FALSE);
+
+    return (cmd_trie_terminal[cmd]->disabled);
+}
+
+void set_command_disabled(int cmd, bool disabled)
+{
+    if (cmd >= 0 && cmd < cmd_trie_count && cmd_trie_terminal)
+        cmd_trie_terminal[cmd]->disabled = disabled;
 }
 
 /* This is the actual command interpreter called from game_loop() in comm.c It
@@ -512,7 +695,7 @@ void sort_commands(void)
    then calls the appropriate function. */
 void command_interpreter(struct char_data *ch, char *argument)
 {
-    int cmd, length;
+    int cmd;
     char *line;
     char arg[MAX_INPUT_LENGTH];
 
@@ -605,22 +788,14 @@ void command_interpreter(struct char_data *ch, char *argument)
             return;
     }
 
-    for (length = strlen(arg), cmd = 0; *complete_cmd_info[cmd].command != '\n'; cmd++)
-        if (complete_cmd_info[cmd].command_pointer != do_action &&
-            !strncmp(complete_cmd_info[cmd].command, arg, length))
-            if (GET_LEVEL(ch) >= complete_cmd_info[cmd].minimum_level)
-                break;
+    cmd = find_command_abbrev(arg, GET_LEVEL(ch), FALSE);
 
     /* it's not a 'real' command, so it's a social */
 
-    if (*complete_cmd_info[cmd].command == '\n')
-        for (length = strlen(arg), cmd = 0; *complete_cmd_info[cmd].command != '\n'; cmd++)
-            if (complete_cmd_info[cmd].command_pointer == do_action &&
-                !strncmp(complete_cmd_info[cmd].command, arg, length))
-                if (GET_LEVEL(ch) >= complete_cmd_info[cmd].minimum_level)
-                    break;
+    if (cmd < 0)
+        cmd = find_command_abbrev(arg, GET_LEVEL(ch), TRUE);
 
-    if (*complete_cmd_info[cmd].command == '\n') {
+    if (cmd < 0) {
         int found = 0;
 
         struct str_spells *skill = get_spell_by_name(arg, SKILL);
@@ -1063,7 +1238,12 @@ void half_chop(char *string, char *arg1, char *arg2)
 /* Used in specprocs, mostly.  (Exactly) matches "command" to cmd number */
 int find_command(const char *command)
 {
+    struct cmd_trie_node *node;
     int cmd;
+
+    if (cmd_trie)
+        return ((node = cmd_trie_walk(command)) != NULL ? node->exact : -1);
+
     for (cmd = 0; *complete_cmd_info[cmd].command != '\n'; cmd++)
         if (!strcmp(complete_cmd_info[cmd].command, command))
             return (cmd);
@@ -1145,8 +1325,10 @@ static int perform_dupe_check(struct descriptor_data *d)
                 target = k->original;
                 mode = UNSWITCH;
             }
-            if (k->character)
+            if (k->character) {
                 k->character->desc = NULL;
+                update_zone_presence(k->character);
+            }
             k->character = NULL;
             k->original = NULL;
         } else if (k->character && GET_IDNUM(k->character) == id && k->original) {
@@ -1163,6 +1345,7 @@ static int perform_dupe_check(struct descriptor_data *d)
                 mode = USURP;
             }
             k->character->desc = NULL;
+            update_zone_presence(k->character);
             k->character = NULL;
             if (k->original) {
                 on_player_linkless(k->original);
@@ -1225,6 +1408,7 @@ static int perform_dupe_check(struct descriptor_data *d)
     free_char(d->character); /* get rid of the old char */
     d->character = target;
     d->character->desc = d;
+    update_zone_presence(d->character);
     d->original = NULL;
     d->character->char_specials.timer = 0;
     REMOVE_BIT_AR(PLR_FLAGS(d->character), PLR_MAILING);
@@ -1319,6 +1503,7 @@ int enter_player_game(struct descriptor_data *d)
     room_vnum load_room;
 
     reset_char(d->character);
+    d->msdp_dirty = MSDP_DIRTY_ALL;
 
     /* Clean up stale disguise state from previous session
      * If player has AFF_DISGUISE but no entry in disguise_list,
@@ -1423,6 +1608,7 @@ int enter_player_game(struct descriptor_data *d)
         read_saved_vars(d->character);
     d->character->next = character_list;
     character_list = d->character;
+    name_index_add(d->character);
     char_to_room(d->character, load_room);
     load_result = Crash_load(d->character);
     /* Save the character and their object file */
@@ -34,6 +34,9 @@ void nanny(struct descriptor_data *d, char *arg);
 int is_abbrev(const char *arg1, const char *arg2);
 int is_number(const char *str);
 int find_command(const char *command);
+int find_command_abbrev(const char *arg, int level, bool social);
+bool is_command_disabled(int cmd);
+void set_command_disabled(int cmd, bool disabled);
 void skip_spaces(char **string);
 char *delete_doubledollar(char *string);
 int special(struct char_data *ch, int cmd, char *arg);
@@ -420,6 +420,7 @@ void gain_condition(struct char_data *ch, int condition, int value)
     GET_COND(ch, condition) += value;
     GET_COND(ch, condition) = MAX(0, GET_COND(ch, condition));
     GET_COND(ch, condition) = MIN(24, GET_COND(ch, condition));
+    MSDP_DIRTY(ch, MSDP_DIRTY_STATUS);
 
     /* Don't send messages if player is writing or condition is above threshold */
     if (GET_COND(ch, condition) > 1 || PLR_FLAGGED(ch, PLR_WRITING))
@@ -485,6 +486,7 @@ static void check_idling(struct char_data *ch)
                  */
                 ch->desc->character = NULL;
                 ch->desc = NULL;
+                update_zone_presence(ch);
             }
             if (CONFIG_FREE_RENT)
                 Crash_rentsave(ch, 0);
@@ -520,9 +522,12 @@ void point_update(void)
         } else
             gain_condition(i, THIRST, -1);
         if (GET_POS(i) >= POS_STUNNED) {
-            GET_HIT(i) = MIN(GET_HIT(i) + hit_gain(i), GET_MAX_HIT(i));
-            GET_MANA(i) = MIN(GET_MANA(i) + mana_gain(i), GET_MAX_MANA(i));
-            GET_MOVE(i) = MIN(GET_MOVE(i) + move_gain(i), GET_MAX_MOVE(i));
+            /* Mobs frozen in a dormant zone get theirs when it wakes. */
+            if (!IS_NPC(i) || !i->mob_specials.dormant_since) {
+                GET_HIT(i) = MIN(GET_HIT(i) + hit_gain(i), GET_MAX_HIT(i));
+                GET_MANA(i) = MIN(GET_MANA(i) + mana_gain(i), GET_MAX_MANA(i));
+                GET_MOVE(i) = MIN(GET_MOVE(i) + move_gain(i), GET_MAX_MOVE(i));
+            }
 
             /* Breath update - handle underwater and high altitude rooms */
             if (!IS_NPC(i) && !PLR_FLAGGED(i, PLR_FROZEN)) {
@@ -928,6 +928,7 @@ int mag_summons(int level, struct char_data *ch, struct obj_data *obj, int spell
         /* Don't mess up the prototype; use new string copies. */
         mob->player.name = strdup(GET_NAME(ch));
         mob->player.short_descr = strdup(GET_NAME(ch));
+        name_index_update(mob);
     }
 
     load_mtrigger(mob);
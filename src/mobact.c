@@ -40,6 +40,9 @@
 /* local file scope only function prototypes */
 static bool aggressive_mob_on_a_leash(struct char_data *slave, struct char_data *master, struct char_data *attack);
 static bool can_heal_based_on_alignment(struct char_data *healer, struct char_data *target);
+static bool mob_sits_out(struct char_data *ch, unsigned long turn);
+static void mob_dormant_catch_up(struct char_data *ch);
+static void wake_dormant_mobs(void);
 
 /* External function prototypes */
 void call_ACMD(void (*function)(), struct char_data *ch, char *argument, int cmd, int subcmd);
@@ -670,12 +673,9 @@ static void mob_contextual_social(struct char_data *ch, struct char_data *target
     social_index = rand_number(0, social_index - 1);
 
     /* Find the social command number */
-    for (cmd_num = 0; *complete_cmd_info[cmd_num].command != '\n'; cmd_num++) {
-        if (!strcmp(complete_cmd_info[cmd_num].command, social_list[social_index]))
-            break;
-    }
+    cmd_num = find_command(social_list[social_index]);
 
-    if (*complete_cmd_info[cmd_num].command != '\n') {
+    if (cmd_num >= 0) {
         /* Execute the social */
         do_action(ch, GET_NAME(target), cmd_num, 0);
 
@@ -702,6 +702,86 @@ static void mob_contextual_social(struct char_data *ch, struct char_data *target
     }
 }
 
+/* Most emotion decay passes a mob coming out of dormancy catches up on; by
+ * then every emotion has long settled at its baseline. */
+#define DORMANT_EMOTION_STEPS 50
+/* Most regeneration ticks it catches up on, which also keeps the sums in range. */
+#define DORMANT_REGEN_TICKS 10000
+
+/**
+ * Whether a mob in a dormant zone (see zone_dormancy_update()) sits out
+ * this turn of mobile_activity() or mob_emotion_activity().  Fighting mobs
+ * always take their turn.
+ * @param ch The mob
+ * @param turn How many times the calling job has run, to spread the turns
+ *   that do run across the mobs
+ */
+static bool mob_sits_out(struct char_data *ch, unsigned long turn)
+{
+    if (!zone_table[world[IN_ROOM(ch)].zone].dormant || FIGHTING(ch))
+        return FALSE;
+    if (CONFIG_DORMANT_MOB_RATE > 0)
+        return ((turn + char_script_id(ch)) % CONFIG_DORMANT_MOB_RATE != 0);
+    return TRUE;
+}
+
+/**
+ * Brings a mob that was frozen in a dormant zone up to date in one step:
+ * the timers and decays mobile_activity() would have run, a bounded number
+ * of silent emotion decay passes (which also decay its MALP memories), and
+ * the hit points, mana and moves point_update() held back.
+ * @param ch The mob
+ */
+static void mob_dormant_catch_up(struct char_data *ch)
+{
+    unsigned long elapsed = pulse - ch->mob_specials.dormant_since;
+    int turns = elapsed / PULSE_MOBILE, steps, ticks;
+
+    ch->mob_specials.dormant_since = 0;
+
+    ticks = MIN(elapsed / (SECS_PER_MUD_HOUR * PASSES_PER_SEC), DORMANT_REGEN_TICKS);
+    if (ticks > 0 && GET_POS(ch) >= POS_STUNNED) {
+        GET_HIT(ch) = MIN(GET_HIT(ch) + ticks * hit_gain(ch), GET_MAX_HIT(ch));
+        GET_MANA(ch) = MIN(GET_MANA(ch) + ticks * mana_gain(ch), GET_MAX_MANA(ch));
+        GET_MOVE(ch) = MIN(GET_MOVE(ch) + ticks * move_gain(ch), GET_MAX_MOVE(ch));
+    }
+
+    if (!ch->ai_data || turns <= 0)
+        return;
+
+    ch->ai_data->duty_frustration_timer = MAX(0, ch->ai_data->duty_frustration_timer - turns);
+    ch->ai_data->quest_posting_frustration_timer = MAX(0, ch->ai_data->quest_posting_frustration_timer - turns);
+    ch->ai_data->helplessness -= 5.0f * turns;
+    if (ch->ai_data->helplessness < 0.0f)
+        ch->ai_data->helplessness = 0.0f;
+    sec_passive_decay_steps(ch, turns);
+
+    if (!AWAKE(ch) || AFF_FLAGGED(ch, AFF_PARALIZE))
+        return;
+
+    ch->ai_data->cognitive_capacity =
+        MIN(ch->ai_data->cognitive_capacity + MIN(turns, COGNITIVE_CAPACITY_MAX) * COGNITIVE_CAPACITY_REGEN,
+            COGNITIVE_CAPACITY_MAX);
+
+    if (CONFIG_MOB_CONTEXTUAL_SOCIALS) {
+        steps = MIN(elapsed / PULSE_MOB_EMOTION * CONFIG_MOB_EMOTION_UPDATE_CHANCE / 100, DORMANT_EMOTION_STEPS);
+        while (steps-- > 0)
+            update_mob_emotion_decay(ch);
+    }
+}
+
+/* Catches up the frozen mobs of every zone that has woken since the last call. */
+static void wake_dormant_mobs(void)
+{
+    struct char_data *ch;
+
+    dormant_zones_woken = FALSE;
+    for (ch = character_list; ch; ch = ch->next)
+        if (IS_NPC(ch) && ch->mob_specials.dormant_since && IN_ROOM(ch) != NOWHERE &&
+            !zone_table[world[IN_ROOM(ch)].zone].dormant)
+            mob_dormant_catch_up(ch);
+}
+
 /**
  * Separate heartbeat pass for mob emotion and social behavior.
  * Called more frequently than mobile_activity() to make mobs feel more alive.
@@ -730,6 +810,10 @@ void mob_emotion_activity(void)
         if (FIGHTING(ch) || !AWAKE(ch))
             continue;
 
+        /* Mobs in dormant zones rest too */
+        if (mob_sits_out(ch, pulse / PULSE_MOB_EMOTION))
+            continue;
+
         /* Mobs perform contextual socials based on reputation, alignment, gender, and position */
         /* Only perform if experimental feature is enabled */
         /* Probability controlled by CONFIG_MOB_EMOTION_SOCIAL_CHANCE (configurable in cedit) */
@@ -906,16 +990,24 @@ void mob_emotion_activity(void)
     } /* end for() */
 }
 
-void mobile_activity(void)
+/* Mobiles are split into PULSE_MOBILE slices by script id and heartbeat()
+ * runs one slice per pulse, so every mob still thinks once per PULSE_MOBILE
+ * but the work is spread evenly instead of landing on a single pulse.  Each
+ * slice keeps its own list (see mob_slice_link()) so a pulse never walks the
+ * mobs of the other slices. */
+void mobile_activity(int slice)
 {
     struct char_data *ch, *next_ch, *vict;
     int found;
     memory_rec *names;
 
-    for (ch = character_list; ch; ch = next_ch) {
-        next_ch = ch->next;
+    if (dormant_zones_woken)
+        wake_dormant_mobs();
 
-        if (!ch || !IS_MOB(ch))
+    for (ch = first_slice_mob(slice); ch; ch = next_ch) {
+        next_ch = ch->next_in_slice;
+
+        if (!IS_MOB(ch))
             continue;
 
         /* Skip mobs that have been marked for extraction (e.g., from death traps) */
@@ -929,6 +1021,16 @@ void mobile_activity(void)
             continue;
         }
 
+        /* Dormant zones: frozen mobs wait for the zone to wake, the rest
+           only take some of their turns. */
+        if (ch->mob_specials.dormant_since && (CONFIG_DORMANT_MOB_RATE || !zone_table[world[IN_ROOM(ch)].zone].dormant))
+            mob_dormant_catch_up(ch);
+        if (mob_sits_out(ch, pulse / PULSE_MOBILE)) {
+            if (!CONFIG_DORMANT_MOB_RATE && !ch->mob_specials.dormant_since)
+                ch->mob_specials.dormant_since = pulse;
+            continue;
+        }
+
         /* Examine call for special procedure */
         if (MOB_FLAGGED(ch, MOB_SPEC) && !no_specials) {
             if (mob_index[GET_MOB_RNUM(ch)].func == NULL) {
@@ -2041,7 +2143,7 @@ void mobile_activity(void)
          * This prevents all mobs from checking on the same tick */
         if (ch->ai_data && !AFF_FLAGGED(ch, AFF_CHARM) && GET_MOB_QUEST(ch) == NOTHING &&
             ch->ai_data->current_goal == GOAL_NONE &&
-            ((GET_MOB_RNUM(ch) + pulse) % 20 == 0) && /* Stagger: each mob checks every 20 ticks */
+            ((GET_MOB_RNUM(ch) + pulse / PULSE_MOBILE) % 20 == 0) && /* Stagger: each mob checks every 20 ticks */
             rand_number(1, 100) <= 10) {              /* 10% chance when it's their turn */
             mob_try_to_accept_quest(ch);
         }
@@ -4839,64 +4941,43 @@ struct char_data *get_mob_in_room_by_vnum(room_rnum room, mob_vnum vnum)
  */
 struct char_data *find_questmaster_by_vnum(mob_vnum vnum)
 {
-    struct char_data *i, *next_i;
+    mob_rnum rnum = real_mobile(vnum);
 
-    /* Search through all characters in the world */
-    for (i = character_list; i; i = next_i) {
-        next_i = i->next;
-
-        /* Safety check: Skip characters marked for extraction */
-        if (MOB_FLAGGED(i, MOB_NOTDEADYET) || PLR_FLAGGED(i, PLR_NOTDEADYET))
-            continue;
-
-        /* Safety check: Validate room before using the character */
-        if (!IS_NPC(i) || IN_ROOM(i) == NOWHERE || IN_ROOM(i) < 0 || IN_ROOM(i) > top_of_world)
-            continue;
+    /* Check if this mob is a questmaster (has quest special procedure) */
+    if (rnum == NOBODY || (mob_index[rnum].func != questmaster && mob_index[rnum].func != temp_questmaster))
+        return NULL;
 
-        if (GET_MOB_VNUM(i) == vnum) {
-            /* Check if this mob is a questmaster (has quest special procedure) */
-            if (mob_index[GET_MOB_RNUM(i)].func == questmaster || mob_index[GET_MOB_RNUM(i)].func == temp_questmaster) {
-                return i;
-            }
-        }
-    }
-    return NULL;
+    return find_mob_by_vnum(vnum);
 }
 
 /**
  * Find any mob in the world by vnum (not just questmasters).
- * Note: This performs O(n) search through character_list. Called during quest
- * processing which is throttled, so performance impact is acceptable.
+ * Only the live copies of that mob are searched, see mob_instance_link().
  * @param vnum The mob vnum to find.
  * @return Pointer to the mob if found, NULL otherwise.
  */
 struct char_data *find_mob_by_vnum(mob_vnum vnum)
 {
-    struct char_data *i, *next_i;
-
-    /* Search through all characters in the world */
-    for (i = character_list; i; i = next_i) {
-        next_i = i->next;
+    struct char_data *i;
 
+    for (i = first_mob_instance(real_mobile(vnum)); i; i = i->next_instance) {
         /* Safety check: Skip characters marked for extraction */
-        if (MOB_FLAGGED(i, MOB_NOTDEADYET) || PLR_FLAGGED(i, PLR_NOTDEADYET))
+        if (MOB_FLAGGED(i, MOB_NOTDEADYET))
             continue;
 
         /* Safety check: Validate room before using the character */
-        if (!IS_NPC(i) || IN_ROOM(i) == NOWHERE || IN_ROOM(i) < 0 || IN_ROOM(i) > top_of_world)
+        if (IN_ROOM(i) == NOWHERE || IN_ROOM(i) < 0 || IN_ROOM(i) > top_of_world)
             continue;
 
-        if (GET_MOB_VNUM(i) == vnum) {
-            return i;
-        }
+        return i;
     }
     return NULL;
 }
 
 /**
  * Find the location of an object in the world (on ground, in open container, or carried by a mob).
- * Note: This performs O(rooms + mobs) search through the world. Called during quest
- * processing which is throttled, so performance impact is acceptable.
+ * Only visits the live copies of the object, see obj_instance_link().  An object on the ground
+ * is preferred to one a mob is carrying.
  * Only searches open containers - mobs cannot see into closed containers.
  * @param obj_vnum The object vnum to find.
  * @return Room number where the object can be found, or NOWHERE if not found.
@@ -4905,43 +4986,26 @@ room_rnum find_object_location(obj_vnum obj_vnum)
 {
     struct obj_data *obj;
     struct char_data *mob;
-    room_rnum room;
+    room_rnum carried = NOWHERE;
 
-    /* First, check if object is on the ground in any room */
-    for (room = 0; room <= top_of_world; room++) {
-        for (obj = world[room].contents; obj; obj = obj->next_content) {
-            if (GET_OBJ_VNUM(obj) == obj_vnum) {
-                return room;
-            }
-            /* Check inside open containers on the ground (mobs can't see inside closed ones) */
-            if (GET_OBJ_TYPE(obj) == ITEM_CONTAINER && !OBJVAL_FLAGGED(obj, CONT_CLOSED)) {
-                struct obj_data *contained;
-                for (contained = obj->contains; contained; contained = contained->next_content) {
-                    if (GET_OBJ_VNUM(contained) == obj_vnum) {
-                        return room;
-                    }
-                }
-            }
-        }
-    }
+    for (obj = first_obj_instance(real_object(obj_vnum)); obj; obj = obj->next_instance) {
+        /* On the ground */
+        if (IN_ROOM(obj) != NOWHERE)
+            return IN_ROOM(obj);
 
-    /* Then, check if any mob is carrying the object */
-    for (mob = character_list; mob; mob = mob->next) {
-        if (!IS_NPC(mob))
-            continue;
-        if (MOB_FLAGGED(mob, MOB_NOTDEADYET) || PLR_FLAGGED(mob, PLR_NOTDEADYET))
-            continue;
-        if (IN_ROOM(mob) == NOWHERE || IN_ROOM(mob) < 0 || IN_ROOM(mob) > top_of_world)
-            continue;
+        /* Inside an open container on the ground (mobs can't see inside closed ones) */
+        if (obj->in_obj && IN_ROOM(obj->in_obj) != NOWHERE && GET_OBJ_TYPE(obj->in_obj) == ITEM_CONTAINER &&
+            !OBJVAL_FLAGGED(obj->in_obj, CONT_CLOSED))
+            return IN_ROOM(obj->in_obj);
 
-        for (obj = mob->carrying; obj; obj = obj->next_content) {
-            if (GET_OBJ_VNUM(obj) == obj_vnum) {
-                return IN_ROOM(mob);
-            }
-        }
+        /* Carried by a mob; keep looking in case a copy lies on the ground */
+        if (carried == NOWHERE && (mob = obj->carried_by) != NULL && IS_NPC(mob) &&
+            !MOB_FLAGGED(mob, MOB_NOTDEADYET) && !PLR_FLAGGED(mob, PLR_NOTDEADYET) && IN_ROOM(mob) != NOWHERE &&
+            IN_ROOM(mob) <= top_of_world)
+            carried = IN_ROOM(mob);
     }
 
-    return NOWHERE; /* Object not found */
+    return carried; /* NOWHERE if not found */
 }
 
 /**
@@ -6100,69 +6164,51 @@ bool mob_try_drop(struct char_data *ch, struct obj_data *obj)
  */
 room_rnum find_key_location(obj_vnum key_vnum, int *source_type, mob_vnum *carrying_mob)
 {
-    room_rnum room;
+    room_rnum mob_room = NOWHERE, room;
     struct obj_data *obj;
-    struct char_data *mob;
+    struct char_data *mob, *holder = NULL;
 
     if (source_type)
         *source_type = 0;
     if (carrying_mob)
         *carrying_mob = NOBODY;
 
-    /* Search all rooms for the key */
-    for (room = 0; room <= top_of_world; room++) {
-        /* Check objects on room floor */
-        for (obj = world[room].contents; obj; obj = obj->next_content) {
-            if (GET_OBJ_TYPE(obj) == ITEM_KEY && GET_OBJ_VNUM(obj) == key_vnum) {
-                if (source_type)
-                    *source_type = KEY_SOURCE_ROOM;
-                return room;
-            }
+    /* Only the live copies of the key; one lying loose beats one a mob has. */
+    for (obj = first_obj_instance(real_object(key_vnum)); obj; obj = obj->next_instance) {
+        if (GET_OBJ_TYPE(obj) != ITEM_KEY)
+            continue;
 
-            /* Check inside containers */
-            if (GET_OBJ_TYPE(obj) == ITEM_CONTAINER && !OBJVAL_FLAGGED(obj, CONT_CLOSED)) {
-                struct obj_data *contained;
-                for (contained = obj->contains; contained; contained = contained->next_content) {
-                    if (GET_OBJ_TYPE(contained) == ITEM_KEY && GET_OBJ_VNUM(contained) == key_vnum) {
-                        if (source_type)
-                            *source_type = KEY_SOURCE_CONTAINER;
-                        return room;
-                    }
-                }
-            }
+        /* On the room floor */
+        if (IN_ROOM(obj) != NOWHERE) {
+            if (source_type)
+                *source_type = KEY_SOURCE_ROOM;
+            return IN_ROOM(obj);
         }
 
-        /* Check mobs in this room */
-        for (mob = world[room].people; mob; mob = mob->next_in_room) {
-            if (!IS_NPC(mob))
-                continue;
-
-            /* Check mob inventory */
-            for (obj = mob->carrying; obj; obj = obj->next_content) {
-                if (GET_OBJ_TYPE(obj) == ITEM_KEY && GET_OBJ_VNUM(obj) == key_vnum) {
-                    if (source_type)
-                        *source_type = KEY_SOURCE_MOB;
-                    if (carrying_mob)
-                        *carrying_mob = GET_MOB_VNUM(mob);
-                    return room;
-                }
-            }
+        /* Inside an open container on the floor */
+        if (obj->in_obj && IN_ROOM(obj->in_obj) != NOWHERE && GET_OBJ_TYPE(obj->in_obj) == ITEM_CONTAINER &&
+            !OBJVAL_FLAGGED(obj->in_obj, CONT_CLOSED)) {
+            if (source_type)
+                *source_type = KEY_SOURCE_CONTAINER;
+            return IN_ROOM(obj->in_obj);
+        }
 
-            /* Check mob equipment */
-            for (int wear_pos = 0; wear_pos < NUM_WEARS; wear_pos++) {
-                obj = GET_EQ(mob, wear_pos);
-                if (obj && GET_OBJ_TYPE(obj) == ITEM_KEY && GET_OBJ_VNUM(obj) == key_vnum) {
-                    if (source_type)
-                        *source_type = KEY_SOURCE_MOB;
-                    if (carrying_mob)
-                        *carrying_mob = GET_MOB_VNUM(mob);
-                    return room;
-                }
-            }
+        /* In a mob's inventory or equipment, or in a bag it has */
+        room = obj_location(obj, &mob);
+        if (!holder && mob && IS_NPC(mob) && room != NOWHERE) {
+            holder = mob;
+            mob_room = room;
         }
     }
 
-    return NOWHERE; /* Key not found anywhere */
+    if (holder) {
+        if (source_type)
+            *source_type = KEY_SOURCE_MOB;
+        if (carrying_mob)
+            *carrying_mob = GET_MOB_VNUM(holder);
+    }
+
+    return mob_room; /* NOWHERE if the key was not found anywhere */
 }
 
 /**
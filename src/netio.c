@@ -0,0 +1,614 @@
+/**
+ * @file netio.c
+ * Network output threads.
+ *
+ * Part of the core tbaMUD source code distribution, which is a derivative
+ * of, and continuation of, CircleMUD.
+ *
+ * All rights reserved.  See license for complete information.
+ *
+ * Every connection owns a ring of NET_RING_SIZE chunk pointers with three
+ * free-running indices: the game thread fills slots at 'tail', a network
+ * thread writes them out and advances 'sent', and the game thread returns
+ * written chunks to its pool and advances 'reclaim'.  Each index has exactly
+ * one writer, so no locks are needed on the data path.  The only lock guards
+ * the hand-over of new connections and the stop request.
+ *
+ * There are NET_WORKERS network threads.  A connection is given to the least
+ * busy one when it opens and stays there, so its output (and its zlib stream)
+ * is only ever touched by one thread and cannot be reordered.
+ *
+ * Chunks marked 'compressed' are run through the connection's MCCP stream by
+ * its network thread.  Everything a connection has waiting is compressed in
+ * one go and closed with a single Z_SYNC_FLUSH, so a pulse's worth of output
+ * costs one flush instead of one per write_to_output().  The first
+ * compressed chunk starts the stream and the first plain chunk after it
+ * finishes it, which is exactly where protocol.c put the MCCP start sequence
+ * and the end of compression.
+ *
+ * The network threads never allocate or free memory themselves (zmalloc is
+ * not thread safe); connections and chunks are created and released by the
+ * game thread.  zlib allocates its stream state with the C library directly.
+ */
+
+#include "conf.h"
+#include "sysdep.h"
+
+#ifdef CIRCLE_NET_THREAD
+
+#    include <poll.h>
+
+#    include "structs.h"
+#    include "utils.h"
+#    include "comm.h"
+#    include "protocol.h"
+#    include "netio.h"
+
+#    ifdef USING_MCCP
+#        include <zlib.h>
+#    endif
+
+#    define NET_RING_MASK (NET_RING_SIZE - 1)
+
+#    define LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#    define STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#    define ATOMIC_ADD(p, v) __atomic_add_fetch((p), (v), __ATOMIC_RELAXED)
+#    define ATOMIC_SUB(p, v) __atomic_sub_fetch((p), (v), __ATOMIC_RELAXED)
+#    define ATOMIC_TAKE(p) __atomic_exchange_n((p), 0, __ATOMIC_RELAXED)
+
+struct net_worker {
+    pthread_t tid;
+    struct net_conn *pending;   /* opened, not yet seen by the thread (locked) */
+    int stopping;               /* stop request (locked) */
+    int conns;                  /* connections assigned, game thread only */
+    bool wake_pending;          /* game thread pushed since the last netio_wake() */
+    int wake_pipe[2];
+    struct pollfd *poll_set;    /* thread's poll() array */
+    struct net_conn **poll_conns; /* connection behind each poll_set entry */
+    int poll_max;
+};
+
+struct net_conn {
+    socket_t desc;                          /* the socket, closed by the network thread */
+    struct net_worker *worker;              /* thread this connection belongs to */
+    struct out_chunk *slot[NET_RING_SIZE];  /* chunks handed over for writing */
+    unsigned int tail;                      /* game: next slot to fill */
+    unsigned int sent;                      /* network: next slot to write */
+    unsigned int reclaim;                   /* game: next written slot to return */
+    size_t backlog;                         /* bytes handed over and not yet written */
+    int error;                              /* errno of a fatal write, 0 if none */
+    int closed;                             /* game is done, close the socket */
+    int done;                               /* network is done, free the connection */
+    size_t cursor;                          /* network: bytes of slot[sent] written */
+    bool blocked;                           /* network: waiting for POLLOUT */
+#    ifdef USING_MCCP
+    bool z_active;                          /* network: zs is initialised */
+    z_stream zs;                            /* network: MCCP stream */
+    size_t zlen;                            /* network: compressed bytes in zout */
+    size_t zpos;                            /* network: bytes of zout written */
+    Bytef zout[NET_ZBUF_SIZE];              /* network: compressed output */
+#    endif
+    struct net_conn *net_next;              /* network thread's list */
+    struct net_conn *next;                  /* game thread's list */
+};
+
+static struct net_worker workers[NET_WORKERS];
+static pthread_mutex_t netio_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct net_conn *conn_list = NULL; /* every connection, game thread only */
+static int num_workers = 0;               /* threads actually running */
+static int partial_sends = 0;             /* short writes, collected by netio_reclaim() */
+
+static void *netio_thread(void *arg);
+static void netio_worker_free(struct net_worker *w);
+static void netio_flush(struct net_conn *conn);
+static int netio_write(struct net_conn *conn, struct iovec *iov, int iovcnt, size_t total);
+static void netio_discard(struct net_conn *conn);
+static void netio_nonblock(int fd);
+#    ifdef USING_MCCP
+static int netio_deflate(struct net_conn *conn);
+static void netio_deflate_end(struct net_conn *conn);
+#    endif
+
+/* Start the network threads.  'max_conns' sizes their poll arrays, which
+   have to be allocated here since the threads must not call malloc(). */
+void netio_start(int max_conns)
+{
+    struct net_worker *w;
+    sigset_t all, old;
+    int err;
+
+    if (num_workers)
+        return;
+
+    /* Signals belong to the game thread. */
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+
+    for (; num_workers < NET_WORKERS; num_workers++) {
+        w = &workers[num_workers];
+        memset(w, 0, sizeof(*w));
+
+        if (pipe(w->wake_pipe) < 0) {
+            perror("SYSERR: netio pipe");
+            break;
+        }
+        netio_nonblock(w->wake_pipe[0]);
+        netio_nonblock(w->wake_pipe[1]);
+
+        w->poll_max = max_conns + 1;
+        CREATE(w->poll_set, struct pollfd, w->poll_max);
+        CREATE(w->poll_conns, struct net_conn *, w->poll_max);
+
+        if ((err = pthread_create(&w->tid, NULL, netio_thread, w)) != 0) {
+            log1("SYSERR: Unable to start a network thread: %s", strerror(err));
+            netio_worker_free(w);
+            break;
+        }
+    }
+
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if (num_workers)
+        log1("Started %d network output thread%s.", num_workers, num_workers == 1 ? "" : "s");
+}
+
+/* Stop the network threads once everything handed to them has been written
+   (or NET_DRAIN_SECS have passed).  Sockets that were never closed stay
+   open, with any MCCP stream properly finished, so copyover can pass them
+   on.  Every net_conn is freed; the caller must drop its pointers to them. */
+void netio_stop(void)
+{
+    struct net_conn *conn;
+    int i;
+
+    if (!num_workers)
+        return;
+
+    pthread_mutex_lock(&netio_lock);
+    for (i = 0; i < num_workers; i++)
+        workers[i].stopping = 1;
+    pthread_mutex_unlock(&netio_lock);
+
+    for (i = 0; i < num_workers; i++)
+        workers[i].wake_pending = TRUE;
+    netio_wake();
+
+    for (i = 0; i < num_workers; i++) {
+        pthread_join(workers[i].tid, NULL);
+        netio_worker_free(&workers[i]);
+    }
+    num_workers = 0;
+
+    while ((conn = conn_list) != NULL) {
+        conn_list = conn->next;
+        while (conn->reclaim != conn->tail)
+            free(conn->slot[conn->reclaim++ & NET_RING_MASK]);
+        free(conn);
+    }
+}
+
+static void netio_worker_free(struct net_worker *w)
+{
+    close(w->wake_pipe[0]);
+    close(w->wake_pipe[1]);
+    w->wake_pipe[0] = w->wake_pipe[1] = -1;
+    free(w->poll_set);
+    free(w->poll_conns);
+    w->poll_set = NULL;
+    w->poll_conns = NULL;
+}
+
+/* Attach a socket to a network thread.  Returns NULL when none are running,
+   in which case the caller writes to the socket itself. */
+struct net_conn *netio_open(socket_t desc)
+{
+    struct net_worker *w;
+    struct net_conn *conn;
+    int i;
+
+    if (!num_workers)
+        return (NULL);
+
+    for (w = &workers[0], i = 1; i < num_workers; i++)
+        if (workers[i].conns < w->conns)
+            w = &workers[i];
+
+    CREATE(conn, struct net_conn, 1);
+    conn->desc = desc;
+    conn->worker = w;
+    w->conns++;
+
+    conn->next = conn_list;
+    conn_list = conn;
+
+    pthread_mutex_lock(&netio_lock);
+    conn->net_next = w->pending;
+    w->pending = conn;
+    pthread_mutex_unlock(&netio_lock);
+
+    return (conn);
+}
+
+/* The game is finished with this connection: the network thread writes what
+   it can without waiting, then closes the socket.  The caller must not touch
+   'conn' again. */
+void netio_close(struct net_conn *conn)
+{
+    STORE_RELEASE(&conn->closed, 1);
+    conn->worker->wake_pending = TRUE;
+}
+
+/* Free ring slots, i.e. how many chunks netio_push() may be called with. */
+int netio_space(struct net_conn *conn)
+{
+    return (NET_RING_SIZE - (int)(conn->tail - conn->reclaim));
+}
+
+/* Hand a chunk over for writing.  The network thread owns it until
+   netio_reclaim() returns it. */
+void netio_push(struct net_conn *conn, struct out_chunk *chunk)
+{
+    conn->slot[conn->tail & NET_RING_MASK] = chunk;
+    ATOMIC_ADD(&conn->backlog, chunk->len);
+    STORE_RELEASE(&conn->tail, conn->tail + 1);
+    conn->worker->wake_pending = TRUE;
+}
+
+/* Let the network threads know there is work, once per pulse at most. */
+void netio_wake(void)
+{
+    struct net_worker *w;
+    char c = 0;
+    int i;
+
+    for (i = 0; i < num_workers; i++) {
+        w = &workers[i];
+        if (!w->wake_pending)
+            continue;
+        w->wake_pending = FALSE;
+
+        /* A full pipe already means a wake-up is on its way. */
+        if (write(w->wake_pipe[1], &c, 1) < 0 && errno != EAGAIN)
+            perror("SYSERR: netio wake");
+    }
+}
+
+/* Bytes handed over and not yet written; counts towards MAX_OUTPUT_BACKLOG. */
+size_t netio_backlog(struct net_conn *conn)
+{
+    return (LOAD_ACQUIRE(&conn->backlog));
+}
+
+/* Returns the errno of a fatal write on this connection, or 0. */
+int netio_error(struct net_conn *conn)
+{
+    return (LOAD_ACQUIRE(&conn->error));
+}
+
+/* Return every written chunk to the game thread's pool and free connections
+   the network threads have finished with.  Returns the number of short
+   writes since the last call, for the "partial sends" statistic. */
+int netio_reclaim(struct out_chunk **pool)
+{
+    struct net_conn *conn, *next, *temp;
+    struct out_chunk *chunk;
+    unsigned int sent;
+
+    for (conn = conn_list; conn; conn = next) {
+        next = conn->next;
+
+        sent = LOAD_ACQUIRE(&conn->sent);
+        while (conn->reclaim != sent) {
+            chunk = conn->slot[conn->reclaim++ & NET_RING_MASK];
+            chunk->next = *pool;
+            *pool = chunk;
+        }
+
+        if (LOAD_ACQUIRE(&conn->done)) {
+            conn->worker->conns--;
+            REMOVE_FROM_LIST(conn, conn_list, next);
+            free(conn);
+        }
+    }
+
+    return (ATOMIC_TAKE(&partial_sends));
+}
+
+static void netio_nonblock(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+        perror("SYSERR: netio fcntl");
+}
+
+/* Write as much of a connection's ring as the socket will take. */
+static void netio_flush(struct net_conn *conn)
+{
+    struct iovec iov[MAX_OUTPUT_IOV];
+    struct out_chunk *chunk;
+    unsigned int avail, i;
+    size_t total, n;
+    ssize_t result;
+
+    while (!conn->blocked && !conn->error) {
+#    ifdef USING_MCCP
+        /* Compressed output goes out before anything behind it in the ring. */
+        if (conn->zpos < conn->zlen) {
+            iov[0].iov_base = conn->zout + conn->zpos;
+            iov[0].iov_len = conn->zlen - conn->zpos;
+            if ((result = netio_write(conn, iov, 1, iov[0].iov_len)) > 0 && (conn->zpos += result) == conn->zlen)
+                conn->zpos = conn->zlen = 0;
+            continue;
+        }
+#    endif
+
+        avail = LOAD_ACQUIRE(&conn->tail) - conn->sent;
+        if (avail == 0)
+            return;
+
+#    ifdef USING_MCCP
+        chunk = conn->slot[conn->sent & NET_RING_MASK];
+        if (chunk->compressed) {
+            if (netio_deflate(conn) < 0) {
+                STORE_RELEASE(&conn->error, EIO);
+                netio_discard(conn);
+            }
+            continue;
+        } else if (conn->z_active) {
+            /* Compression ended here: finish the stream first. */
+            netio_deflate_end(conn);
+            continue;
+        }
+#    endif
+
+        if (avail > MAX_OUTPUT_IOV)
+            avail = MAX_OUTPUT_IOV;
+
+        total = 0;
+        for (i = 0; i < avail; i++) {
+            chunk = conn->slot[(conn->sent + i) & NET_RING_MASK];
+            if (chunk->compressed)
+                break;
+            n = i ? 0 : conn->cursor;
+            iov[i].iov_base = chunk->data + n;
+            iov[i].iov_len = chunk->len - n;
+            total += chunk->len - n;
+        }
+
+        if ((result = netio_write(conn, iov, i, total)) <= 0)
+            continue;
+
+        ATOMIC_SUB(&conn->backlog, (size_t)result);
+
+        /* Retire the chunks that went out completely. */
+        while (result > 0) {
+            chunk = conn->slot[conn->sent & NET_RING_MASK];
+            n = chunk->len - conn->cursor;
+            if ((size_t)result < n) {
+                conn->cursor += result;
+                break;
+            }
+            result -= n;
+            conn->cursor = 0;
+            STORE_RELEASE(&conn->sent, conn->sent + 1);
+        }
+    }
+}
+
+/* One writev() to the connection's socket.  Returns the number of bytes
+   written, or 0 after marking the connection blocked or failed. */
+static int netio_write(struct net_conn *conn, struct iovec *iov, int iovcnt, size_t total)
+{
+    ssize_t result;
+
+    do {
+        result = writev(conn->desc, iov, iovcnt);
+    } while (result < 0 && errno == EINTR);
+
+    if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        conn->blocked = TRUE;
+        return (0);
+    }
+
+    if (result <= 0) {
+        /* Fatal; the game thread notices and closes the descriptor. */
+        STORE_RELEASE(&conn->error, result < 0 ? errno : EIO);
+        netio_discard(conn);
+        return (0);
+    }
+
+    if ((size_t)result < total)
+        ATOMIC_ADD(&partial_sends, 1);
+
+    return (result);
+}
+
+/* Drop everything queued on a connection. */
+static void netio_discard(struct net_conn *conn)
+{
+    unsigned int tail = LOAD_ACQUIRE(&conn->tail);
+
+    while (conn->sent != tail) {
+        ATOMIC_SUB(&conn->backlog, conn->slot[conn->sent & NET_RING_MASK]->len - conn->cursor);
+        conn->cursor = 0;
+        STORE_RELEASE(&conn->sent, conn->sent + 1);
+    }
+
+#    ifdef USING_MCCP
+    if (conn->z_active) {
+        deflateEnd(&conn->zs);
+        conn->z_active = FALSE;
+    }
+    conn->zlen = conn->zpos = 0;
+#    endif
+}
+
+#    ifdef USING_MCCP
+/* Compress the run of compressed chunks at the head of the ring into zout,
+   as many as are guaranteed to fit, ending with one Z_SYNC_FLUSH so the
+   client can show all of it.  zout must be empty.  Returns -1 on a zlib
+   error. */
+static int netio_deflate(struct net_conn *conn)
+{
+    struct out_chunk *chunk;
+    unsigned int tail = LOAD_ACQUIRE(&conn->tail);
+    uLong batch = 0;
+
+    if (!conn->z_active) {
+        memset(&conn->zs, 0, sizeof(conn->zs));
+        if (deflateInit(&conn->zs, Z_DEFAULT_COMPRESSION) != Z_OK)
+            return (-1);
+        conn->z_active = TRUE;
+    }
+
+    conn->zs.next_out = conn->zout;
+    conn->zs.avail_out = NET_ZBUF_SIZE;
+
+    while (conn->sent != tail) {
+        chunk = conn->slot[conn->sent & NET_RING_MASK];
+        if (!chunk->compressed)
+            break;
+
+        /* Leave room for the worst case, including the flush. */
+        if (batch && deflateBound(&conn->zs, batch + chunk->len) + 16 > NET_ZBUF_SIZE)
+            break;
+
+        conn->zs.next_in = (Bytef *)chunk->data;
+        conn->zs.avail_in = chunk->len;
+        if (deflate(&conn->zs, Z_NO_FLUSH) == Z_STREAM_ERROR || conn->zs.avail_in)
+            return (-1);
+
+        batch += chunk->len;
+        ATOMIC_SUB(&conn->backlog, chunk->len);
+        STORE_RELEASE(&conn->sent, conn->sent + 1);
+    }
+
+    if (deflate(&conn->zs, Z_SYNC_FLUSH) == Z_STREAM_ERROR || !conn->zs.avail_out)
+        return (-1);
+
+    conn->zlen = NET_ZBUF_SIZE - conn->zs.avail_out;
+    conn->zpos = 0;
+    return (0);
+}
+
+/* Finish the connection's MCCP stream; what is left of it lands in zout,
+   which must be empty. */
+static void netio_deflate_end(struct net_conn *conn)
+{
+    conn->zs.next_in = NULL;
+    conn->zs.avail_in = 0;
+    conn->zs.next_out = conn->zout;
+    conn->zs.avail_out = NET_ZBUF_SIZE;
+    deflate(&conn->zs, Z_FINISH);
+    deflateEnd(&conn->zs);
+    conn->z_active = FALSE;
+
+    conn->zlen = NET_ZBUF_SIZE - conn->zs.avail_out;
+    conn->zpos = 0;
+}
+#    endif /* USING_MCCP */
+
+static void *netio_thread(void *arg)
+{
+    struct net_worker *w = (struct net_worker *)arg;
+    struct net_conn *conns = NULL, *conn, *next, *prev;
+    struct timeval deadline, now;
+    char drain[64];
+    int stopping = 0, busy, nfds, i;
+
+    for (;;) {
+        /* Pick up new connections and the stop request. */
+        pthread_mutex_lock(&netio_lock);
+        while ((conn = w->pending) != NULL) {
+            w->pending = conn->net_next;
+            conn->net_next = conns;
+            conns = conn;
+        }
+        if (w->stopping && !stopping) {
+            stopping = 1;
+            gettimeofday(&deadline, NULL);
+            deadline.tv_sec += NET_DRAIN_SECS;
+        }
+        pthread_mutex_unlock(&netio_lock);
+
+        busy = 0;
+        for (prev = NULL, conn = conns; conn; conn = next) {
+            next = conn->net_next;
+
+            netio_flush(conn);
+
+            /* A closed connection gets one attempt at its last words. */
+            if (LOAD_ACQUIRE(&conn->closed)) {
+                CLOSE_SOCKET(conn->desc);
+                netio_discard(conn);
+                if (prev)
+                    prev->net_next = next;
+                else
+                    conns = next;
+                STORE_RELEASE(&conn->done, 1);
+                continue;
+            }
+
+#    ifdef USING_MCCP
+            /* Going down: end compression so the client is back to plain
+               text for whoever inherits the socket. */
+            if (stopping && conn->z_active && !conn->error && conn->zpos == conn->zlen &&
+                conn->sent == LOAD_ACQUIRE(&conn->tail)) {
+                netio_deflate_end(conn);
+                netio_flush(conn);
+            }
+            if (!conn->error && (conn->zpos < conn->zlen || conn->z_active))
+                busy = 1;
+#    endif
+            if (!conn->error && conn->sent != LOAD_ACQUIRE(&conn->tail))
+                busy = 1;
+            prev = conn;
+        }
+
+        if (stopping) {
+            gettimeofday(&now, NULL);
+            if (!busy || now.tv_sec > deadline.tv_sec ||
+                (now.tv_sec == deadline.tv_sec && now.tv_usec >= deadline.tv_usec))
+                break;
+        }
+
+        /* Sleep until woken by the game thread or a blocked socket drains. */
+        w->poll_set[0].fd = w->wake_pipe[0];
+        w->poll_set[0].events = POLLIN;
+        w->poll_set[0].revents = 0;
+        nfds = 1;
+        for (conn = conns; conn && nfds < w->poll_max; conn = conn->net_next) {
+            if (!conn->blocked || conn->error)
+                continue;
+            w->poll_set[nfds].fd = conn->desc;
+            w->poll_set[nfds].events = POLLOUT;
+            w->poll_set[nfds].revents = 0;
+            w->poll_conns[nfds++] = conn;
+        }
+
+        if (poll(w->poll_set, nfds, stopping ? 100 : -1) < 0 && errno != EINTR)
+            break;
+
+        if (w->poll_set[0].revents & POLLIN)
+            while (read(w->wake_pipe[0], drain, sizeof(drain)) > 0)
+                ;
+
+        for (i = 1; i < nfds; i++)
+            if (w->poll_set[i].revents & (POLLOUT | POLLERR | POLLHUP | POLLNVAL))
+                w->poll_conns[i]->blocked = FALSE;
+    }
+
+    /* Whatever is left cannot be written; release it.  Open sockets stay
+       open for copyover. */
+    for (conn = conns; conn; conn = conn->net_next) {
+        netio_discard(conn);
+        if (LOAD_ACQUIRE(&conn->closed))
+            CLOSE_SOCKET(conn->desc);
+        STORE_RELEASE(&conn->done, 1);
+    }
+
+    return (NULL);
+}
+
+#endif /* CIRCLE_NET_THREAD */
@@ -0,0 +1,43 @@
+/**
+ * @file netio.h
+ * Network output threads.
+ *
+ * The game thread renders output into chunks as it always has; each
+ * connection then hands those chunks to its network thread through a
+ * single-producer/single-consumer ring, and the network thread does the MCCP
+ * compression and the writev() calls.  Sent chunks go back to the game
+ * thread's pool through the same ring.  A client that stops reading, or a
+ * burst of compression, only ever holds up a network thread, never
+ * heartbeat().
+ *
+ * Part of the core tbaMUD source code distribution, which is a derivative
+ * of, and continuation of, CircleMUD.
+ *
+ * All rights reserved.  See license for complete information.
+ */
+#ifndef _NETIO_H_
+#define _NETIO_H_
+
+#ifdef CIRCLE_NET_THREAD
+
+#define NET_WORKERS 2       /**< Network output threads */
+#define NET_RING_SIZE 256   /**< Chunks in flight per connection (power of 2) */
+#define NET_ZBUF_SIZE 16384 /**< Compressed bytes produced per MCCP flush, at most */
+#define NET_DRAIN_SECS 5    /**< How long netio_stop() waits for output to drain */
+
+struct net_conn;
+
+/* Game thread side */
+void netio_start(int max_conns);
+void netio_stop(void);
+struct net_conn *netio_open(socket_t desc);
+void netio_close(struct net_conn *conn);
+int netio_space(struct net_conn *conn);
+void netio_push(struct net_conn *conn, struct out_chunk *chunk);
+void netio_wake(void);
+size_t netio_backlog(struct net_conn *conn);
+int netio_error(struct net_conn *conn);
+int netio_reclaim(struct out_chunk **pool);
+
+#endif /* CIRCLE_NET_THREAD */
+#endif /* _NETIO_H_ */
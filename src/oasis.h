@@ -594,6 +594,8 @@ extern const char *nrm, *grn, *cyn, *yel, *YEL, *bln, *red;
 /* Social gossip configuration */
 #define CEDIT_MOB_GOSSIP_CHANCE 219
 #define CEDIT_MOB_GOSSIP_COOLDOWN 220
+#define CEDIT_ZONE_DORMANCY 221
+#define CEDIT_DORMANT_MOB_RATE 222
 
 /* Hedit Submodes of connectedness. */
 #define HEDIT_CONFIRM_SAVESTRING 0
@@ -24,6 +24,7 @@
 #include "constants.h"
 #include "dg_scripts.h"
 #include "screen.h"
+#include "graph.h"
 
 /* Local, filescope function prototypes */
 /* Utility function for buildwalk */
@@ -202,6 +203,8 @@ ACMD(do_dig)
                 free(W_EXIT(IN_ROOM(ch), dir)->keyword);
             free(W_EXIT(IN_ROOM(ch), dir));
             W_EXIT(IN_ROOM(ch), dir) = NULL;
+            invalidate_zone_neighbours();
+            invalidate_pathfind_cache(IN_ROOM(ch));
             add_to_save_list(zone_table[world[IN_ROOM(ch)].zone].number, SL_WLD);
             send_to_char(ch, "Você removeu a saída para %s.\r\n", dirs[dir]);
             return;
@@ -269,6 +272,8 @@ ACMD(do_dig)
     W_EXIT(IN_ROOM(ch), dir)->general_description = NULL;
     W_EXIT(IN_ROOM(ch), dir)->keyword = NULL;
     W_EXIT(IN_ROOM(ch), dir)->to_room = rrnum;
+    invalidate_zone_neighbours();
+    invalidate_pathfind_cache(IN_ROOM(ch));
     add_to_save_list(zone_table[world[IN_ROOM(ch)].zone].number, SL_WLD);
 
     send_to_char(ch, "Você fez uma nova saída para %s até a sala %d (%s).\r\n", dirs[dir], rvnum, world[rrnum].name);
@@ -353,6 +358,9 @@ int buildwalk(struct char_data *ch, int dir)
             EXIT(ch, dir)->to_room = rnum;
             CREATE(world[rnum].dir_option[rev_dir[dir]], struct room_direction_data, 1);
             world[rnum].dir_option[rev_dir[dir]]->to_room = IN_ROOM(ch);
+            invalidate_zone_neighbours();
+            invalidate_pathfind_cache(IN_ROOM(ch));
+            invalidate_pathfind_cache(rnum);
 
             /* Report room creation to user */
             send_to_char(ch, "%sSala #%d criada por BuildWalk.%s\r\n", yel, vnum, nrm);
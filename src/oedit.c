@@ -13,6 +13,7 @@
 #include "interpreter.h"
 #include "spells.h"
 #include "db.h"
+#include "handler.h"
 #include "boards.h"
 #include "constants.h"
 #include "shop.h"
@@ -234,9 +235,7 @@ void oedit_save_internally(struct descriptor_data *d)
     obj_proto[robj_num].proto_script = OLC_SCRIPT(d);
 
     /* this takes care of the objects currently in-game */
-    for (obj = object_list; obj; obj = obj->next) {
-        if (obj->item_number != robj_num)
-            continue;
+    for (obj = first_obj_instance(robj_num); obj; obj = obj->next_instance) {
         /* remove any old scripts */
         if (SCRIPT(obj))
             extract_script(obj, OBJ_TRIGGER);
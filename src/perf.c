@@ -0,0 +1,244 @@
+/**
+ * @file perf.c
+ * Heartbeat profiler.
+ *
+ * Part of the core tbaMUD source code distribution, which is a derivative
+ * of, and continuation of, CircleMUD.
+ *
+ * All rights reserved.  See license for complete information.
+ *
+ * perf_begin()/perf_end() bracket a phase and add the elapsed time to its
+ * statistics and to its share of the current game loop iteration.  Once per
+ * iteration game_loop() calls perf_loop_done() with the number of pulses it
+ * found it had missed; if there are any, the phase that used the most time
+ * in that iteration gets the blame, and the per-iteration shares start over.
+ */
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "perf.h"
+
+struct perf_stats {
+    unsigned long calls;
+    long min, max;            /* All time, in nanoseconds */
+    double total;             /* Nanoseconds */
+    long window[PERF_WINDOW]; /* The most recent samples, in nanoseconds */
+    int next, filled;
+    unsigned long overruns;   /* Pulses missed while this phase was the biggest */
+    unsigned long skipped;    /* Runs left out to catch up */
+    long this_loop;           /* Nanoseconds spent in the current iteration */
+    struct timespec start;
+};
+
+static const char *perf_names[NUM_PERF_PHASES] = {
+    "input",   "commands", "output",  "events",   "scripts", "msdp",    "zones",
+    "emotion", "mobiles",  "violence", "auctions", "weather", "timetrig", "affects",
+    "points",  "quests",   "autosave", "extract",  "cleanups", "misc"};
+
+static const char *defer_names[NUM_DEFER_JOBS] = {"emotion", "auctions", "auction save", "autosave", "cleanups"};
+
+static struct perf_stats perf_phases[NUM_PERF_PHASES];
+static struct perf_stats perf_loop; /* Whole game loop iterations */
+static unsigned long perf_late_loops = 0, perf_missed = 0;
+static time_t perf_since = 0;
+static unsigned long defer_counts[NUM_DEFER_JOBS][3]; /* Deferred, coalesced, forced */
+
+/* Local functions */
+static long perf_elapsed(const struct timespec *start);
+static void perf_add(struct perf_stats *st, long ns);
+static void perf_summary(struct perf_stats *st, long *avg, long *p99);
+static int perf_compare(const void *a, const void *b);
+
+static long perf_elapsed(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000000000L + (now.tv_nsec - start->tv_nsec);
+}
+
+static void perf_add(struct perf_stats *st, long ns)
+{
+    if (!st->calls || ns < st->min)
+        st->min = ns;
+    if (ns > st->max)
+        st->max = ns;
+    st->calls++;
+    st->total += ns;
+    st->this_loop += ns;
+
+    st->window[st->next] = ns;
+    st->next = (st->next + 1) % PERF_WINDOW;
+    if (st->filled < PERF_WINDOW)
+        st->filled++;
+}
+
+void perf_begin(int phase) { clock_gettime(CLOCK_MONOTONIC, &perf_phases[phase].start); }
+
+void perf_end(int phase) { perf_add(&perf_phases[phase], perf_elapsed(&perf_phases[phase].start)); }
+
+void perf_loop_done(int missed_pulses, long loop_usec)
+{
+    int i, worst = 0;
+
+    if (!perf_since)
+        perf_since = time(0);
+
+    perf_add(&perf_loop, loop_usec * 1000L);
+
+    if (missed_pulses > 0) {
+        for (i = 1; i < NUM_PERF_PHASES; i++)
+            if (perf_phases[i].this_loop > perf_phases[worst].this_loop)
+                worst = i;
+
+        perf_phases[worst].overruns += missed_pulses;
+        perf_late_loops++;
+        perf_missed += missed_pulses;
+
+        if (missed_pulses >= PASSES_PER_SEC)
+            log1("PERF: Missed %d pulses, %ld ms of %ld ms were spent in %s.", missed_pulses,
+                 perf_phases[worst].this_loop / 1000000L, loop_usec / 1000L, perf_names[worst]);
+    }
+
+    for (i = 0; i < NUM_PERF_PHASES; i++)
+        perf_phases[i].this_loop = 0;
+}
+
+/** Counts a deferrable job that was put off (or, when coalesced, that came
+ * due again while still waiting and was merged with the earlier run). */
+void perf_deferred(int job, bool coalesced) { defer_counts[job][coalesced ? 1 : 0]++; }
+
+/** Counts a deferred job that waited its longest and ran on a busy pulse. */
+void perf_forced(int job) { defer_counts[job][2]++; }
+
+/** Counts a run of a phase that was left out to catch up. */
+void perf_skipped(int phase) { perf_phases[phase].skipped++; }
+
+void perf_reset(void)
+{
+    struct timespec start;
+    int i;
+
+    /* 'show perf reset' itself runs inside a timed phase; keep its start. */
+    for (i = 0; i < NUM_PERF_PHASES; i++) {
+        start = perf_phases[i].start;
+        memset(&perf_phases[i], 0, sizeof(perf_phases[i]));
+        perf_phases[i].start = start;
+    }
+    memset(&perf_loop, 0, sizeof(perf_loop));
+    memset(defer_counts, 0, sizeof(defer_counts));
+    perf_late_loops = perf_missed = 0;
+    perf_since = time(0);
+}
+
+static int perf_compare(const void *a, const void *b)
+{
+    long x = *(const long *)a, y = *(const long *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* Average and 99th percentile of the recent samples. */
+static void perf_summary(struct perf_stats *st, long *avg, long *p99)
+{
+    long sorted[PERF_WINDOW];
+    double sum = 0;
+    int i;
+
+    *avg = *p99 = 0;
+    if (!st->filled)
+        return;
+
+    for (i = 0; i < st->filled; i++) {
+        sorted[i] = st->window[i];
+        sum += st->window[i];
+    }
+    qsort(sorted, st->filled, sizeof(long), perf_compare);
+
+    *avg = (long)(sum / st->filled);
+    *p99 = sorted[MIN(st->filled - 1, st->filled * 99 / 100)];
+}
+
+size_t perf_report(char *buf, size_t size)
+{
+    double grand = 0;
+    long avg, p99;
+    size_t len;
+    int i;
+
+    for (i = 0; i < NUM_PERF_PHASES; i++)
+        grand += perf_phases[i].total;
+
+    len = snprintf(buf, size,
+                   "Heartbeat profile (usec; avg/p99 over the last %d calls)\r\n"
+                   "Phase          Calls      Min      Avg      p99      Max  Share  Overruns\r\n"
+                   "-------------------------------------------------------------------------\r\n",
+                   PERF_WINDOW);
+
+    for (i = 0; i < NUM_PERF_PHASES && len < size; i++) {
+        struct perf_stats *st = &perf_phases[i];
+
+        if (!st->calls)
+            continue;
+        perf_summary(st, &avg, &p99);
+        len += snprintf(buf + len, size - len, "%-10s %9lu %8ld %8ld %8ld %8ld %5.1f%% %9lu\r\n", perf_names[i],
+                        st->calls, st->min / 1000, avg / 1000, p99 / 1000, st->max / 1000,
+                        grand > 0 ? st->total * 100.0 / grand : 0.0, st->overruns);
+    }
+
+    if (len < size) {
+        perf_summary(&perf_loop, &avg, &p99);
+        len += snprintf(buf + len, size - len,
+                        "Whole loop: avg %ld, p99 %ld, max %ld usec (budget %d).\r\n"
+                        "%lu late iterations, %lu pulses missed in the last %ld seconds.\r\n",
+                        avg / 1000, p99 / 1000, perf_loop.max / 1000, OPT_USEC, perf_late_loops, perf_missed,
+                        perf_since ? (long)(time(0) - perf_since) : 0L);
+    }
+
+    if (len < size)
+        len += snprintf(buf + len, size - len, "Put off while behind:  Deferred  Coalesced  Forced\r\n");
+    for (i = 0; i < NUM_DEFER_JOBS && len < size; i++)
+        len += snprintf(buf + len, size - len, "  %-18s %9lu %10lu %7lu\r\n", defer_names[i], defer_counts[i][0],
+                        defer_counts[i][1], defer_counts[i][2]);
+    for (i = 0; i < NUM_PERF_PHASES && len < size; i++)
+        if (perf_phases[i].skipped)
+            len += snprintf(buf + len, size - len, "  %-18s %9lu skipped\r\n", perf_names[i],
+                            perf_phases[i].skipped);
+
+    return (len < size ? len : size - 1);
+}
+
+/* Append the current figures to a CSV file, one line per phase, so repeated
+   dumps build up a time series. */
+int perf_dump_csv(const char *fname)
+{
+    time_t now = time(0);
+    long avg, p99;
+    FILE *fl;
+    int i;
+
+    if (!(fl = fopen(fname, "a"))) {
+        log1("SYSERR: Can't open %s for writing: %s", fname, strerror(errno));
+        return (FALSE);
+    }
+
+    fseek(fl, 0, SEEK_END);
+    if (ftell(fl) == 0)
+        fprintf(fl, "time,phase,calls,min_us,avg_us,p99_us,max_us,total_ms,overruns\n");
+
+    for (i = 0; i < NUM_PERF_PHASES; i++) {
+        struct perf_stats *st = &perf_phases[i];
+
+        perf_summary(st, &avg, &p99);
+        fprintf(fl, "%ld,%s,%lu,%ld,%ld,%ld,%ld,%.0f,%lu\n", (long)now, perf_names[i], st->calls, st->min / 1000,
+                avg / 1000, p99 / 1000, st->max / 1000, st->total / 1000000.0, st->overruns);
+    }
+    perf_summary(&perf_loop, &avg, &p99);
+    fprintf(fl, "%ld,loop,%lu,%ld,%ld,%ld,%ld,%.0f,%lu\n", (long)now, perf_loop.calls, perf_loop.min / 1000,
+            avg / 1000, p99 / 1000, perf_loop.max / 1000, perf_loop.total / 1000000.0, perf_missed);
+
+    fclose(fl);
+    return (TRUE);
+}
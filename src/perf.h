@@ -0,0 +1,68 @@
+/**
+ * @file perf.h
+ * Heartbeat profiler.
+ *
+ * Every phase of the game loop (reading input, running commands, sending
+ * output and each of the heartbeat() subsystems) is timed with the monotonic
+ * clock.  Each phase keeps its all-time min/max and a rolling window of its
+ * most recent samples for the average and 99th percentile.  When the game
+ * loop falls behind, the missed pulses are charged to whichever phase took
+ * the most time in the iteration that overran.  It also counts the work
+ * heartbeat() put off or skipped to catch up.
+ *
+ * Part of the core tbaMUD source code distribution, which is a derivative
+ * of, and continuation of, CircleMUD.
+ *
+ * All rights reserved.  See license for complete information.
+ */
+#ifndef _PERF_H_
+#define _PERF_H_
+
+#define PERF_WINDOW 256 /**< Recent samples kept per phase for avg/p99 */
+
+/** Profiled phases of the game loop, in the order they run. */
+enum perf_phase {
+    PERF_INPUT,        /**< process_input() */
+    PERF_COMMANDS,     /**< nanny(), command_interpreter() and friends */
+    PERF_OUTPUT,       /**< process_output() and prompts */
+    PERF_EVENTS,       /**< event_process() */
+    PERF_SCRIPTS,      /**< script_trigger_check() */
+    PERF_MSDP,         /**< msdp_update() */
+    PERF_ZONES,        /**< zone_update() */
+    PERF_MOB_EMOTION,  /**< mob_emotion_activity() */
+    PERF_MOBILES,      /**< mobile_activity() */
+    PERF_VIOLENCE,     /**< perform_violence() */
+    PERF_AUCTIONS,     /**< update_auctions(), save_auctions() */
+    PERF_WEATHER,      /**< beware_lightning(), weather_and_time() */
+    PERF_TIME_TRIGS,   /**< check_time_triggers() */
+    PERF_AFFECTS,      /**< affect_update() */
+    PERF_POINTS,       /**< point_update() */
+    PERF_QUESTS,       /**< check_timed_quests() */
+    PERF_AUTOSAVE,     /**< Crash_save_all(), House_save_all() */
+    PERF_EXTRACT,      /**< extract_pending_chars() */
+    PERF_CLEANUPS,     /**< process_deferred_cleanups() */
+    PERF_MISC,         /**< Idle passwords, usage and time saves */
+    NUM_PERF_PHASES
+};
+
+/** Heartbeat jobs that are put off while the game is behind. */
+enum defer_job {
+    DEFER_EMOTION,      /**< mob_emotion_activity() */
+    DEFER_AUCTIONS,     /**< update_auctions() */
+    DEFER_AUCTION_SAVE, /**< save_auctions() */
+    DEFER_AUTOSAVE,     /**< Crash_save_all(), House_save_all() */
+    DEFER_CLEANUPS,     /**< process_deferred_cleanups() */
+    NUM_DEFER_JOBS
+};
+
+void perf_begin(int phase);
+void perf_end(int phase);
+void perf_loop_done(int missed_pulses, long loop_usec);
+void perf_deferred(int job, bool coalesced);
+void perf_forced(int job);
+void perf_skipped(int phase);
+void perf_reset(void);
+size_t perf_report(char *buf, size_t size);
+int perf_dump_csv(const char *fname);
+
+#endif /* _PERF_H_ */
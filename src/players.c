@@ -44,6 +44,14 @@ static void load_quests(FILE *fl, struct char_data *ch);
 static void load_HMVS(struct char_data *ch, const char *line, int mode);
 static void write_aliases_ascii(FILE *file, struct char_data *ch);
 static void read_aliases_ascii(FILE *file, struct char_data *ch, int count);
+static unsigned int player_name_hash(const char *name);
+static void ptable_hash_insert(int pos);
+
+/* player_table by name: an open addressed hash of positions in the table,
+ * at most half full.  Rebuilt by hash_player_index() whenever positions or
+ * names change wholesale; create_entry() just adds its one new entry. */
+static int *ptable_hash = NULL;
+static int ptable_hash_size = 0;
 
 /* New version to build player index for ASCII Player Files. Generate index
  * table for the player file. */
@@ -85,6 +93,47 @@ void build_player_index(void)
 
     fclose(plr_index);
     top_of_p_file = top_of_p_table = i - 1;
+    hash_player_index();
+}
+
+/* Case-insensitive, as str_cmp() is. */
+static unsigned int player_name_hash(const char *name)
+{
+    unsigned int h = 5381;
+
+    for (; *name; name++)
+        h = h * 33 + (unsigned char)LOWER(*name);
+
+    return (h);
+}
+
+static void ptable_hash_insert(int pos)
+{
+    unsigned int i = player_name_hash(player_table[pos].name) & (ptable_hash_size - 1);
+
+    while (ptable_hash[i] != -1)
+        i = (i + 1) & (ptable_hash_size - 1);
+    ptable_hash[i] = pos;
+}
+
+/* Rebuild the hashed name index of player_table from scratch. */
+void hash_player_index(void)
+{
+    int i, size = 64;
+
+    while (size < 2 * (top_of_p_table + 1))
+        size <<= 1;
+
+    if (size != ptable_hash_size) {
+        RECREATE(ptable_hash, int, size);
+        ptable_hash_size = size;
+    }
+    for (i = 0; i < ptable_hash_size; i++)
+        ptable_hash[i] = -1;
+
+    for (i = 0; i <= top_of_p_table; i++)
+        if (player_table[i].name)
+            ptable_hash_insert(i);
 }
 
 /* Create a new entry in the in-memory index table for the player file. If the
@@ -113,6 +162,11 @@ int create_entry(char *name)
     /* clear the bitflag in case we have garbage data */
     player_table[pos].flags = 0;
 
+    if (2 * (top_of_p_table + 1) > ptable_hash_size)
+        hash_player_index();
+    else if (get_ptable_by_name(name) != pos)
+        ptable_hash_insert(pos);
+
     return (pos);
 }
 
@@ -148,6 +202,9 @@ static void remove_player_from_index(int pos)
         free(player_table);
         player_table = NULL;
     }
+
+    /* Everything after pos moved down one */
+    hash_player_index();
 }
 
 /* This function necessary to save a seperate ASCII player index */
@@ -188,28 +245,35 @@ void free_player_index(void)
     free(player_table);
     player_table = NULL;
     top_of_p_table = 0;
+
+    free(ptable_hash);
+    ptable_hash = NULL;
+    ptable_hash_size = 0;
 }
 
 long get_ptable_by_name(const char *name)
 {
-    int i;
+    unsigned int i;
 
-    for (i = 0; i <= top_of_p_table; i++)
-        if (!str_cmp(player_table[i].name, name))
-            return (i);
+    if (!ptable_hash || top_of_p_table < 0)
+        return (-1);
+
+    for (i = player_name_hash(name) & (ptable_hash_size - 1); ptable_hash[i] != -1;
+         i = (i + 1) & (ptable_hash_size - 1))
+        if (!str_cmp(player_table[ptable_hash[i]].name, name))
+            return (ptable_hash[i]);
 
     return (-1);
 }
 
 long get_id_by_name(const char *name)
 {
-    int i;
+    long i;
 
-    for (i = 0; i <= top_of_p_table; i++)
-        if (!str_cmp(player_table[i].name, name))
-            return (player_table[i].id);
+    if ((i = get_ptable_by_name(name)) < 0)
+        return (-1);
 
-    return (-1);
+    return (player_table[i].id);
 }
 
 char *get_name_by_id(long id)
@@ -554,7 +618,7 @@ int load_char(const char *name, struct char_data *ch)
                             t = read_trigger(t_rnum);
                             if (!SCRIPT(ch))
                                 CREATE(SCRIPT(ch), struct script_data, 1);
-                            add_trigger(SCRIPT(ch), t, -1);
+                            add_trigger(ch, MOB_TRIGGER, t, -1);
                         }
                     }
                     break;
@@ -72,6 +72,7 @@ static void prefedit_save_to_char(struct descriptor_data *d)
     if (vict && vict->desc && IS_PLAYING(vict->desc)) {
         for (i = 0; i < PR_ARRAY_MAX; i++)
             PRF_FLAGS(vict)[i] = OLC_PREFS(d)->pref_flags[i];
+        update_zone_presence(vict);
 
         GET_WIMP_LEV(vict) = OLC_PREFS(d)->wimp_level;
         GET_PAGE_LENGTH(vict) = OLC_PREFS(d)->page_length;
@@ -13,10 +13,6 @@
 #include <sys/types.h>
 #include "protocol.h"
 
-#ifdef USING_MCCP
-#    include <zlib.h>
-#endif
-
 /******************************************************************************
  The following section is for Diku/Merc derivatives.  Replace as needed.
  ******************************************************************************/
@@ -43,7 +39,7 @@ const char *RGBthree = "F555";
 static void Write(descriptor_t *apDescriptor, const char *apData)
 {
     if (apDescriptor != NULL) {
-        if (apDescriptor->pProtocol->WriteOOB > 0 || *(apDescriptor->output) == '\0') {
+        if (apDescriptor->pProtocol->WriteOOB > 0 || apDescriptor->output.total == 0) {
             apDescriptor->pProtocol->WriteOOB = 2;
         }
     }
@@ -77,8 +73,9 @@ static void CompressStart(descriptor_t *apDescriptor)
         Write(apDescriptor, WontMCCP2);
     }
 
-    /* Only start compression if MCCP2 or MCCP3 is enabled */
-    if (!pProtocol->bMCCP2 && !pProtocol->bMCCP3) {
+    /* Only start compression if MCCP2 or MCCP3 is enabled, and there is a
+       network thread to do the compressing for this descriptor. */
+    if ((!pProtocol->bMCCP2 && !pProtocol->bMCCP3) || !output_compress_ok(apDescriptor)) {
         const char WontMCCP2[] = {(char)IAC, (char)WONT, TELOPT_MCCP2, '\0'};
         const char WontMCCP3[] = {(char)IAC, (char)WONT, TELOPT_MCCP3, '\0'};
         Write(apDescriptor, WontMCCP2);
@@ -86,32 +83,20 @@ static void CompressStart(descriptor_t *apDescriptor)
         return;
     }
 
-    /* Allocate and initialize compression stream */
-    z_stream *stream = malloc(sizeof(z_stream));
-    if (!stream)
-        return;
-
-    stream->zalloc = z_alloc;
-    stream->zfree = z_free;
-    stream->opaque = NULL;
-
-    /* Initialize deflate for compression */
-    if (deflateInit(stream, Z_DEFAULT_COMPRESSION) != Z_OK) {
-        free(stream);
-        return;
-    }
-
-    pProtocol->pCompress = stream;
     pProtocol->bCompressing = true;
 
-    /* Send the compression start sequence - prioritize MCCP3 */
+    /* Send the compression start sequence - prioritize MCCP3.  Everything
+       queued after it goes out compressed; the network thread owns the zlib
+       stream. */
     if (pProtocol->bMCCP3) {
         const char StartMCCP3[] = {(char)IAC, (char)SB, TELOPT_MCCP3, (char)IAC, (char)SE, '\0'};
         Write(apDescriptor, StartMCCP3);
+        output_compress(apDescriptor, TRUE);
         InfoMessage(apDescriptor, "MCCP3 INITIALIZED\r\n");
     } else if (pProtocol->bMCCP2) {
         const char StartMCCP2[] = {(char)IAC, (char)SB, TELOPT_MCCP2, (char)IAC, (char)SE, '\0'};
         Write(apDescriptor, StartMCCP2);
+        output_compress(apDescriptor, TRUE);
         InfoMessage(apDescriptor, "MCCP2 INITIALIZED\r\n");
     }
 #else
@@ -128,16 +113,11 @@ static void CompressEnd(descriptor_t *apDescriptor)
 #ifdef USING_MCCP
     protocol_t *pProtocol = apDescriptor ? apDescriptor->pProtocol : NULL;
 
-    if (!pProtocol || !pProtocol->bCompressing || !pProtocol->pCompress)
+    if (!pProtocol || !pProtocol->bCompressing)
         return;
 
-    z_stream *stream = (z_stream *)pProtocol->pCompress;
-
-    /* Finish compression stream properly */
-    deflateEnd(stream);
-    free(stream);
-
-    pProtocol->pCompress = NULL;
+    /* The network thread finishes the stream ahead of the next plain byte. */
+    output_compress(apDescriptor, FALSE);
     pProtocol->bCompressing = false;
 
     /* Send notification that compression is ending */
@@ -333,6 +313,10 @@ static char *AllocString(const char *apString);
 
 static const char s_Clean[] = "\033[0;00m"; /* Remove colour */
 
+/* Bytes ProtocolOutputToBuffer() has to look at; everything else is copied
+ * through as it is. */
+static const char s_Special[] = "\t@>!";
+
 static const char s_DarkBlack[] = "\033[0;30m";   /* Black foreground */
 static const char s_DarkRed[] = "\033[0;31m";     /* Red foreground */
 static const char s_DarkGreen[] = "\033[0;32m";   /* Green foreground */
@@ -404,7 +388,6 @@ protocol_t *ProtocolCreate(void)
     pProtocol->pVariables = (MSDP_t **)malloc(sizeof(MSDP_t *) * eMSDP_MAX);
 
 #ifdef USING_MCCP
-    pProtocol->pCompress = NULL;
     pProtocol->bCompressing = false;
 #endif
 
@@ -449,14 +432,6 @@ void ProtocolDestroy(protocol_t *apProtocol)
         free(apProtocol->pLastTTYPE);
     free(apProtocol->pMXPVersion);
 
-#ifdef USING_MCCP
-    if (apProtocol->pCompress) {
-        z_stream *stream = (z_stream *)apProtocol->pCompress;
-        deflateEnd(stream);
-        free(apProtocol->pCompress);
-    }
-#endif
-
     free(apProtocol);
 }
 
@@ -1042,7 +1017,19 @@ void ProtocolOutputToBuffer(descriptor_t *apDescriptor, const char *apData, char
             apOutput[i++] = '?';
         } else /* Just copy the character normally */
         {
-            apOutput[i++] = apData[j];
+            /* ...along with the rest of the plain run behind it, which is
+             * most of any room description or who list.  Only the bytes in
+             * s_Special can start a code, so strcspn() finds the next one. */
+            size_t Run = strcspn(&apData[j + 1], s_Special) + 1;
+
+            if (*apLength > 0 && Run > (size_t)(*apLength - j))
+                Run = *apLength - j;
+            if (Run > (size_t)(maxOutput - i))
+                Run = maxOutput - i;
+
+            memcpy(&apOutput[i], &apData[j], Run);
+            i += Run;
+            j += Run - 1;
         }
     }
 
@@ -1059,12 +1046,9 @@ void ProtocolOutputToBuffer(descriptor_t *apDescriptor, const char *apData, char
      * or for protocol control sequences that could interfere with client identification */
     if (pProtocol && !pProtocol->pVariables[eMSDP_UTF_8]->ValueInt && apDescriptor &&
         STATE(apDescriptor) != CON_GET_PROTOCOL) {
-        /* Use the minimum of outputSize and MAX_OUTPUT_BUFFER to ensure safe filtering */
-        size_t filterSize = (outputSize < MAX_OUTPUT_BUFFER + 1) ? outputSize : (MAX_OUTPUT_BUFFER + 1);
-        char FilteredResult[MAX_OUTPUT_BUFFER + 1];
-        FilterUTF8ToASCII(apOutput, FilteredResult, (int)filterSize);
-        strncpy(apOutput, FilteredResult, outputSize - 1);
-        apOutput[outputSize - 1] = '\0';
+        /* The filter never writes more bytes than it reads, so it can work in
+         * place and is not limited to MAX_OUTPUT_BUFFER. */
+        FilterUTF8ToASCII(apOutput, apOutput, (int)outputSize);
         i = strlen(apOutput);
     }
 
@@ -1073,6 +1057,29 @@ void ProtocolOutputToBuffer(descriptor_t *apDescriptor, const char *apData, char
         *apLength = i;
 }
 
+int ProtocolOutputClass(descriptor_t *apDescriptor)
+{
+    protocol_t *pProtocol = apDescriptor ? apDescriptor->pProtocol : NULL;
+    int Class = 0;
+
+    if (pProtocol == NULL || pProtocol->pVariables[eMSDP_MXP]->ValueInt)
+        return -1;
+
+    /* Colour: none, ANSI or xterm 256, exactly as ColourRGB() decides. */
+    if (pProtocol->pVariables[eMSDP_ANSI_COLORS]->ValueInt &&
+        (!apDescriptor->character || clr(apDescriptor->character, C_CMP)))
+        Class = pProtocol->pVariables[eMSDP_XTERM_256_COLORS]->ValueInt ? 2 : 1;
+
+    if (pProtocol->pVariables[eMSDP_UTF_8]->ValueInt)
+        Class |= 1 << 2;
+    if (pProtocol->bMSP || pProtocol->pVariables[eMSDP_SOUND]->ValueInt)
+        Class |= 1 << 3;
+    if (STATE(apDescriptor) != CON_GET_PROTOCOL)
+        Class |= 1 << 4;
+
+    return Class;
+}
+
 /* ProtocolOutput: Process and format output data for transmission to client
  *
  * This function processes output text, applying color codes, protocol-specific
@@ -1438,7 +1445,7 @@ void MSDPSendList(descriptor_t *apDescriptor, const char *apVariable, const char
     }
 }
 
-void MSDPSetNumber(descriptor_t *apDescriptor, variable_t aMSDP, int aValue)
+bool_t MSDPSetNumber(descriptor_t *apDescriptor, variable_t aMSDP, int aValue)
 {
     protocol_t *pProtocol = apDescriptor ? apDescriptor->pProtocol : NULL;
 
@@ -1447,12 +1454,14 @@ void MSDPSetNumber(descriptor_t *apDescriptor, variable_t aMSDP, int aValue)
             if (pProtocol->pVariables[aMSDP]->ValueInt != aValue) {
                 pProtocol->pVariables[aMSDP]->ValueInt = aValue;
                 pProtocol->pVariables[aMSDP]->bDirty = true;
+                return true;
             }
         }
     }
+    return false;
 }
 
-void MSDPSetString(descriptor_t *apDescriptor, variable_t aMSDP, const char *apValue)
+bool_t MSDPSetString(descriptor_t *apDescriptor, variable_t aMSDP, const char *apValue)
 {
     protocol_t *pProtocol = apDescriptor ? apDescriptor->pProtocol : NULL;
 
@@ -1462,9 +1471,11 @@ void MSDPSetString(descriptor_t *apDescriptor, variable_t aMSDP, const char *apV
                 free(pProtocol->pVariables[aMSDP]->pValueString);
                 pProtocol->pVariables[aMSDP]->pValueString = AllocString(apValue);
                 pProtocol->pVariables[aMSDP]->bDirty = true;
+                return true;
             }
         }
     }
+    return false;
 }
 
 void MSDPSetTable(descriptor_t *apDescriptor, variable_t aMSDP, const char *apValue)
@@ -1690,6 +1701,16 @@ static void FilterUTF8ToASCII(char *input, char *output, int max_output_size)
         if (c < 0x80) {
             /* ASCII character, copy as-is */
             output[j++] = input[i++];
+        } else if (c == (unsigned char)IAC) {
+            /* Telnet command (never valid UTF-8): copy it and its option
+             * byte untouched, or the client never sees e.g. the MCCP start. */
+            int len = 2;
+
+            if (i + 1 < input_len && (unsigned char)input[i + 1] >= (unsigned char)SB &&
+                (unsigned char)input[i + 1] != (unsigned char)IAC)
+                len = 3;
+            while (len-- > 0 && i < input_len && j < max_output_size - 1)
+                output[j++] = input[i++];
         } else if ((c & 0xE0) == 0xC0 && i + 1 < input_len) {
             /* 2-byte UTF-8 sequence */
             unsigned char c2 = (unsigned char)input[i + 1];
@@ -2689,13 +2710,17 @@ static const char *GetAnsiColour(bool_t abBackground, int aRed, int aGreen, int
 
 static const char *GetRGBColour(bool_t abBackground, int aRed, int aGreen, int aBlue)
 {
-    static char Result[16];
+    /* Every colour code is built once, the first time it's used. */
+    static char Result[2][216][16];
     int ColVal = 16 + (aRed * 36) + (aGreen * 6) + aBlue;
-    sprintf(Result, "\033[%c8;5;%c%c%cm", '3' + abBackground, /* Background */
-            '0' + (ColVal / 100),                             /* Red        */
-            '0' + ((ColVal % 100) / 10),                      /* Green      */
-            '0' + (ColVal % 10));                             /* Blue       */
-    return Result;
+    char *pResult = Result[abBackground ? 1 : 0][ColVal - 16];
+
+    if (*pResult == '\0')
+        sprintf(pResult, "\033[%c8;5;%c%c%cm", '3' + (abBackground ? 1 : 0), /* Background */
+                '0' + (ColVal / 100),                                       /* Red        */
+                '0' + ((ColVal % 100) / 10),                                /* Green      */
+                '0' + (ColVal % 10));                                       /* Blue       */
+    return pResult;
 }
 
 static bool_t IsValidColour(const char *apArgument)
@@ -2763,11 +2788,6 @@ static char *AllocString(const char *apString)
     return pResult;
 }
 
-/* zlib helper functions */
-void *z_alloc(void *opaque, uint items, uint size) { return calloc(items, size); }
-
-void z_free(void *opaque, void *address) { return free(address); }
-
 /******************************************************************************
  MCCP compression control functions.
  ******************************************************************************/
@@ -235,7 +235,6 @@ typedef struct {
     char *pLastTTYPE;      /* Used for the cyclic TTYPE check */
     MSDP_t **pVariables;   /* The MSDP variables */
 #ifdef USING_MCCP
-    void *pCompress;     /* Compression stream (z_stream*) */
     bool_t bCompressing; /* Is compression currently active? */
 #endif
 } protocol_t;
@@ -358,6 +357,16 @@ const char *ProtocolOutput(descriptor_t *apDescriptor, const char *apData, int *
 void ProtocolOutputToBuffer(descriptor_t *apDescriptor, const char *apData, char *apOutput, size_t outputSize,
                             int *apLength);
 
+/* Function: ProtocolOutputClass
+ *
+ * Returns which output class the descriptor is in: two descriptors of the same
+ * class get identical bytes out of ProtocolOutputToBuffer for the same text,
+ * so a broadcast only has to translate it once per class.  Returns -1 if the
+ * output can't be shared (MXP keeps per-descriptor state while translating).
+ */
+#define PROTOCOL_OUTPUT_CLASSES 32
+int ProtocolOutputClass(descriptor_t *apDescriptor);
+
 /******************************************************************************
  Copyover save/load functions.
  ******************************************************************************/
@@ -440,7 +449,7 @@ void MSDPSendList(descriptor_t *apDescriptor, const char *apVariable, const char
  *
  * You can also this function for bools, chars, enums, short ints, etc.
  */
-void MSDPSetNumber(descriptor_t *apDescriptor, variable_t aMSDP, int aValue);
+bool_t MSDPSetNumber(descriptor_t *apDescriptor, variable_t aMSDP, int aValue);
 
 /* Function: MSDPSetString
  *
@@ -448,8 +457,10 @@ void MSDPSetNumber(descriptor_t *apDescriptor, variable_t aMSDP, int aValue);
  * approach is to send every MSDP variable within an update function (and
  * this is what the snippet does by default), but if the variable is only
  * set in one place you can just move its MDSPSend() call to there.
+ *
+ * Both return true if the value changed (and so will be sent).
  */
-void MSDPSetString(descriptor_t *apDescriptor, variable_t aMSDP, const char *apValue);
+bool_t MSDPSetString(descriptor_t *apDescriptor, variable_t aMSDP, const char *apValue);
 
 /* Function: MSDPSetTable
  *
@@ -572,9 +583,6 @@ char *UnicodeGet(int aValue);
  */
 void UnicodeAdd(char **apString, int aValue);
 
-void *z_alloc(void *opaque, uint items, uint size);
-void z_free(void *opaque, void *address);
-
 /* MCCP compression control functions */
 bool_t ProtocolMCCPStart(descriptor_t *apDescriptor);
 void ProtocolMCCPStop(descriptor_t *apDescriptor);
@@ -416,19 +416,18 @@ static char *format_quest_info(qst_rnum rnum, struct char_data *ch, char *buf, s
             struct obj_data *obj_instance;
 
             /* First, try to find an actual instance of this object in the world */
-            for (obj_instance = object_list; obj_instance; obj_instance = obj_instance->next) {
-                if (GET_OBJ_RNUM(obj_instance) == obj_rnum_val) {
-                    /* Check if object is in a room */
-                    if (obj_instance->in_room != NOWHERE) {
-                        found_zone = world[obj_instance->in_room].zone;
-                        break;
-                    }
-                    /* Check if carried by a mob in a valid room */
-                    if (obj_instance->carried_by && IS_NPC(obj_instance->carried_by) &&
-                        IN_ROOM(obj_instance->carried_by) != NOWHERE) {
-                        found_zone = world[IN_ROOM(obj_instance->carried_by)].zone;
-                        break;
-                    }
+            for (obj_instance = first_obj_instance(obj_rnum_val); obj_instance;
+                 obj_instance = obj_instance->next_instance) {
+                /* Check if object is in a room */
+                if (obj_instance->in_room != NOWHERE) {
+                    found_zone = world[obj_instance->in_room].zone;
+                    break;
+                }
+                /* Check if carried by a mob in a valid room */
+                if (obj_instance->carried_by && IS_NPC(obj_instance->carried_by) &&
+                    IN_ROOM(obj_instance->carried_by) != NOWHERE) {
+                    found_zone = world[IN_ROOM(obj_instance->carried_by)].zone;
+                    break;
                 }
             }
 
@@ -437,8 +436,8 @@ static char *format_quest_info(qst_rnum rnum, struct char_data *ch, char *buf, s
                 mob_rnum qm_rnum = real_mobile(QST_MASTER(rnum));
                 if (qm_rnum != NOBODY) {
                     struct char_data *qm_mob;
-                    for (qm_mob = character_list; qm_mob; qm_mob = qm_mob->next) {
-                        if (IS_NPC(qm_mob) && GET_MOB_RNUM(qm_mob) == qm_rnum && IN_ROOM(qm_mob) != NOWHERE) {
+                    for (qm_mob = first_mob_instance(qm_rnum); qm_mob; qm_mob = qm_mob->next_instance) {
+                        if (IN_ROOM(qm_mob) != NOWHERE) {
                             found_zone = world[IN_ROOM(qm_mob)].zone;
                             break;
                         }
@@ -463,9 +462,8 @@ static char *format_quest_info(qst_rnum rnum, struct char_data *ch, char *buf, s
         if (target_mob_rnum != NOBODY) {
             /* Find the zone where this mob type can be found */
             struct char_data *target_mob;
-            for (target_mob = character_list; target_mob; target_mob = target_mob->next) {
-                if (IS_NPC(target_mob) && GET_MOB_RNUM(target_mob) == target_mob_rnum &&
-                    IN_ROOM(target_mob) != NOWHERE) {
+            for (target_mob = first_mob_instance(target_mob_rnum); target_mob; target_mob = target_mob->next_instance) {
+                if (IN_ROOM(target_mob) != NOWHERE) {
                     zone_rnum zone = world[IN_ROOM(target_mob)].zone;
                     if (zone != NOWHERE && zone >= 0 && zone <= top_of_zone_table && zone_table) {
                         const char *zone_name = zone_table[zone].name;
@@ -775,9 +773,8 @@ bool assign_bounty_target(struct char_data *ch, struct char_data *qm, qst_rnum r
 
     /* Find a living mob with the target vnum in the world */
     if (target_rnum != NOBODY) {
-        for (target_mob = character_list; target_mob; target_mob = target_mob->next) {
-            if (IS_NPC(target_mob) && GET_MOB_RNUM(target_mob) == target_rnum &&
-                !MOB_FLAGGED(target_mob, MOB_NOTDEADYET)) {
+        for (target_mob = first_mob_instance(target_rnum); target_mob; target_mob = target_mob->next_instance) {
+            if (!MOB_FLAGGED(target_mob, MOB_NOTDEADYET)) {
                 /* Found a target - store its unique ID */
                 GET_BOUNTY_TARGET_ID(ch) = char_script_id(target_mob);
                 send_to_char(ch, "%s diz, 'O alvo foi localizado. Boa caçada!'\r\n", GET_NAME(qm));
@@ -1237,13 +1234,7 @@ void autoquest_trigger_check(struct char_data *ch, struct char_data *vict, struc
                         struct char_data *original_requester = NULL;
 
                         /* Find the original requester in the world */
-                        for (original_requester = character_list; original_requester;
-                             original_requester = original_requester->next) {
-                            if (IS_NPC(original_requester) &&
-                                GET_MOB_RNUM(original_requester) == original_requester_rnum) {
-                                break;
-                            }
-                        }
+                        original_requester = first_mob_instance(original_requester_rnum);
 
                         if (original_requester && original_requester != vict) {
                             /* Transfer item from questmaster to original requester */
@@ -1461,13 +1452,7 @@ void autoquest_trigger_check(struct char_data *ch, struct char_data *vict, struc
                         struct char_data *original_requester = NULL;
 
                         /* Find the original requester in the world */
-                        for (original_requester = character_list; original_requester;
-                             original_requester = original_requester->next) {
-                            if (IS_NPC(original_requester) &&
-                                GET_MOB_RNUM(original_requester) == original_requester_rnum) {
-                                break;
-                            }
-                        }
+                        original_requester = first_mob_instance(original_requester_rnum);
 
                         if (original_requester && original_requester != vict) {
                             /* Transfer item from questmaster to original requester */
@@ -3098,10 +3083,7 @@ bool mob_can_reach_questmaster(struct char_data *mob, mob_vnum qm_vnum)
         return FALSE;
 
     /* Find the questmaster in the world */
-    for (qm = character_list; qm; qm = qm->next) {
-        if (IS_NPC(qm) && GET_MOB_VNUM(qm) == qm_vnum)
-            break;
-    }
+    qm = first_mob_instance(real_mobile(qm_vnum));
 
     if (!qm)
         return FALSE; /* Questmaster not found in world */
@@ -3175,18 +3157,8 @@ void make_mob_temp_questmaster_if_needed(struct char_data *mob, qst_vnum quest_v
                 log1("QUEST: Fixed questmaster special procedure for mob prototype %d", qm_vnum);
             }
 
-            /* Find the questmaster in the world and ensure instance also has correct procedure */
-            for (qm = character_list; qm; qm = qm->next) {
-                if (IS_NPC(qm) && GET_MOB_VNUM(qm) == qm_vnum) {
-                    /* Double-check that this specific instance has the questmaster function */
-                    if (mob_index[GET_MOB_RNUM(qm)].func != questmaster) {
-                        mob_index[GET_MOB_RNUM(qm)].func = questmaster;
-                        log1("QUEST: Fixed questmaster special procedure for mob instance %s (%d)", GET_NAME(qm),
-                             qm_vnum);
-                    }
-                    break;
-                }
-            }
+            /* Find the questmaster in the world; its instances share the prototype's procedure */
+            qm = first_mob_instance(qm_rnum);
 
             if (qm) {
                 log1("QUEST: Mob %s posted quest %d to questmaster %s (%d) - quest should be immediately available",
@@ -3950,16 +3922,14 @@ void load_temp_quest_assignments(void)
 
         /* Find the mob in the world */
         mob = NULL;
-        for (mob = character_list; mob; mob = mob->next) {
-            if (IS_NPC(mob) && GET_MOB_VNUM(mob) == mob_vnum) {
-                /* If room_vnum is specified, check if mob is in the right room */
-                if (room_vnum != -1) {
-                    room_rnum = real_room(room_vnum);
-                    if (room_rnum == NOWHERE || IN_ROOM(mob) != room_rnum)
-                        continue; /* Wrong room, keep looking */
-                }
-                break; /* Found the right mob */
+        for (mob = first_mob_instance(real_mobile(mob_vnum)); mob; mob = mob->next_instance) {
+            /* If room_vnum is specified, check if mob is in the right room */
+            if (room_vnum != -1) {
+                room_rnum = real_room(room_vnum);
+                if (room_rnum == NOWHERE || IN_ROOM(mob) != room_rnum)
+                    continue; /* Wrong room, keep looking */
             }
+            break; /* Found the right mob */
         }
 
         if (!mob) {
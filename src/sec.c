@@ -23,6 +23,7 @@
 
 #include "conf.h"
 #include "sysdep.h"
+#include <math.h>
 #include "structs.h"
 #include "utils.h"
 #include "db.h"
@@ -278,6 +279,28 @@ void sec_passive_decay(struct char_data *mob)
     ai->sec.helplessness = ai->sec.helplessness * (1.0f - lm);
 }
 
+void sec_passive_decay_steps(struct char_data *mob, int steps)
+{
+    if (!IS_NPC(mob) || !mob->ai_data || steps <= 0)
+        return;
+
+    struct mob_ai_data *ai = mob->ai_data;
+
+    float A = sec_clamp(ai->last_4d_state.raw_arousal / 100.0f, 0.0f, 1.0f);
+    if (A >= SEC_AROUSAL_EPSILON)
+        return;
+
+    /* n blends by λ toward a fixed base leave (1 − λ)^n of the distance. */
+    float keep = powf(1.0f - SEC_DECAY_LAMBDA, (float)steps);
+    float lm = 1.0f - keep;
+
+    ai->sec.fear = ai->sec.fear * keep + ai->sec_base.fear_base * lm;
+    ai->sec.anger = ai->sec.anger * keep + ai->sec_base.anger_base * lm;
+    ai->sec.happiness = ai->sec.happiness * keep + ai->sec_base.happiness_base * lm;
+    ai->sec.sadness = ai->sec.sadness * keep + ai->sec_base.sadness_base * lm;
+    ai->sec.helplessness = ai->sec.helplessness * keep;
+}
+
 /* ── Read-only getters ───────────────────────────────────────────────────── */
 
 float sec_get_4d_modifier(struct char_data *mob)
@@ -320,6 +320,16 @@ void sec_update(struct char_data *mob, const struct emotion_4d_state *r);
  */
 void sec_passive_decay(struct char_data *mob);
 
+/**
+ * Apply @p steps ticks of passive decay at once, in closed form.
+ * Used to catch up a mob that sat out a dormant zone; the arousal guard
+ * is checked once, as arousal does not change while the mob is idle.
+ *
+ * @param mob    The NPC to update.
+ * @param steps  Number of ticks to apply.
+ */
+void sec_passive_decay_steps(struct char_data *mob, int steps);
+
 /* ── Read-only modulation getters ────────────────────────────────────────── */
 
 /**
@@ -669,6 +669,7 @@ SPECIAL(pet_shops)
             snprintf(buf, sizeof(buf), "%s %s", pet->player.name, pet_name);
             /* free(pet->player.name); don't free the prototype! */
             pet->player.name = strdup(buf);
+            name_index_update(pet);
 
             snprintf(buf, sizeof(buf),
                      "%s Uma pequena placa em uma coleira ao redor de seu pescoço diz: 'Meu nome é %s'\r\n",
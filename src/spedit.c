@@ -48,6 +48,31 @@ struct str_spells *list_spells = NULL;
 int last_spell_vnum = 0;
 char *UNDEF_SPELL = "Undefined";
 
+/* Lookup tables kept beside list_spells. The vnum array is maintained as spells
+   are added; the level table and the name trie depend on fields spedit can
+   change, so any save just marks them stale and they are rebuilt on next use. */
+#define NUM_SPELL_NAME_SLOTS 4 /* any type, SPELL, SKILL, CHANSON */
+
+struct spell_name_node {
+    char letter;                                    /* lowercased byte */
+    struct str_spells *exact[NUM_SPELL_NAME_SLOTS]; /* first spell with exactly this name */
+    struct str_spells *first[NUM_SPELL_NAME_SLOTS]; /* first spell whose name starts here */
+    int count[NUM_SPELL_NAME_SLOTS];                /* spells whose name starts here */
+    struct spell_name_node *child;
+    struct spell_name_node *sibling;
+};
+
+static struct str_spells *spell_by_vnum[MAX_SKILLS + 1];
+static int spell_levels[MAX_SKILLS + 1][NUM_CLASSES + 1]; /* shifted by one for CLASS_UNDEFINED */
+static struct spell_name_node *spell_names = NULL;
+static bool spell_tables_stale = TRUE;
+
+static int spell_name_slot(char type);
+static struct spell_name_node *spell_name_child(struct spell_name_node *node, char letter, bool create);
+static void spell_name_insert(struct str_spells *spell);
+static void free_spell_names(struct spell_name_node *node);
+static void refresh_spell_tables(void);
+
 // return a pointer on the player's name that is editing the spell vnum, or NULL if not edited.
 // The name will be used to says: Spell is edited by: <name>.
 // but, it can also be used to check if a SPELL VNUM is edited.
@@ -153,13 +178,101 @@ int get_spell_class(struct str_spells *spell, int class)
     return -1;
 }
 
+static int spell_name_slot(char type)
+{
+    switch (type) {
+        case SPSK:
+            return 0;
+        case SPELL:
+            return 1;
+        case SKILL:
+            return 2;
+        case CHANSON:
+            return 3;
+    }
+    return -1;
+}
+
+static struct spell_name_node *spell_name_child(struct spell_name_node *node, char letter, bool create)
+{
+    struct spell_name_node *child;
+
+    for (child = node->child; child; child = child->sibling)
+        if (child->letter == letter)
+            return child;
+
+    if (!create)
+        return NULL;
+
+    CREATE(child, struct spell_name_node, 1);
+    child->letter = letter;
+    child->sibling = node->child;
+    node->child = child;
+    return child;
+}
+
+// spells must be inserted in list order, so that exact[] keeps the first one.
+static void spell_name_insert(struct str_spells *spell)
+{
+    struct spell_name_node *node = spell_names;
+    int slot = spell_name_slot(spell->type);
+    const char *c;
+
+    for (c = spell->name; *c; c++) {
+        node = spell_name_child(node, LOWER(*c), TRUE);
+        if (!node->count[0]++)
+            node->first[0] = spell;
+        if (slot > 0 && !node->count[slot]++)
+            node->first[slot] = spell;
+    }
+
+    if (!node->exact[0])
+        node->exact[0] = spell;
+    if (slot > 0 && !node->exact[slot])
+        node->exact[slot] = spell;
+}
+
+static void free_spell_names(struct spell_name_node *node)
+{
+    struct spell_name_node *next;
+
+    for (; node; node = next) {
+        next = node->sibling;
+        free_spell_names(node->child);
+        free(node);
+    }
+}
+
+static void refresh_spell_tables(void)
+{
+    struct str_spells *ptr;
+    int vnum, i;
+
+    for (vnum = 0; vnum <= MAX_SKILLS; vnum++)
+        for (i = 0; i <= NUM_CLASSES; i++)
+            spell_levels[vnum][i] = -1;
+
+    free_spell_names(spell_names);
+    CREATE(spell_names, struct spell_name_node, 1);
+
+    for (ptr = list_spells; ptr; ptr = ptr->next) {
+        if (ptr->vnum >= 0 && ptr->vnum <= MAX_SKILLS)
+            for (i = NUM_CLASSES - 1; i >= 0; i--)
+                if (ptr->assign[i].class_num >= CLASS_UNDEFINED && ptr->assign[i].class_num < NUM_CLASSES)
+                    spell_levels[ptr->vnum][ptr->assign[i].class_num + 1] = ptr->assign[i].level;
+        if (ptr->name)
+            spell_name_insert(ptr);
+    }
+
+    spell_tables_stale = FALSE;
+}
+
 int get_spell_mag_flags(int vnum)
 {
-    struct str_spells *Q;
+    struct str_spells *Q = get_spell_by_vnum(vnum);
 
-    for (Q = list_spells; Q; Q = Q->next)
-        if (Q->vnum == vnum)
-            return (Q->mag_flags);
+    if (Q)
+        return (Q->mag_flags);
 
     log1("SYSERR: Spell vnum %d not found at get_spell_mag_flags.", vnum);
     return 0;
@@ -167,51 +280,58 @@ int get_spell_mag_flags(int vnum)
 
 char *get_spell_name(int vnum)
 {
-    struct str_spells *ptr;
+    struct str_spells *ptr = get_spell_by_vnum(vnum);
 
-    for (ptr = list_spells; ptr; ptr = ptr->next)
-        if (ptr->vnum == vnum)
-            return ptr->name;
-    return UNDEF_SPELL;
+    return ptr ? ptr->name : UNDEF_SPELL;
 }
 
 struct str_spells *get_spell_by_vnum(int vnum)
 {
-    struct str_spells *ptr;
-
-    for (ptr = list_spells; ptr; ptr = ptr->next)
-        if (ptr->vnum == vnum)
-            return ptr;
-    return NULL;
+    if (vnum < 0 || vnum > MAX_SKILLS)
+        return NULL;
+    return spell_by_vnum[vnum];
 }
 
 // check all the assigned classes.
 int get_spell_level(int vnum, int class)
 {
-    int i;
-    struct str_spells *spell = get_spell_by_vnum(vnum);
-
-    if (spell) {
-        for (i = 0; i < NUM_CLASSES; i++)
-            if (spell->assign[i].class_num == class)
-                return spell->assign[i].level;
-    }
-    return -1;
+    if (vnum < 0 || vnum > MAX_SKILLS || class < CLASS_UNDEFINED || class >= NUM_CLASSES)
+        return -1;
+    if (spell_tables_stale)
+        refresh_spell_tables();
+    return spell_levels[vnum][class + 1];
 }
 
 struct str_spells *get_spell_by_name(char *name, char type)
 {
+    struct spell_name_node *node;
     struct str_spells *ptr, *first = NULL;
-    int cpt = 0;
+    int cpt = 0, slot = spell_name_slot(type);
+    const char *c;
+
+    if (slot >= 0) {
+        if (spell_tables_stale)
+            refresh_spell_tables();
+
+        for (node = spell_names, c = name; node && *c; c++)
+            node = spell_name_child(node, LOWER(*c), FALSE);
+
+        if (!node)
+            return NULL;
+        /* An exact match wins, otherwise the abbreviation must be unambiguous. */
+        if (node->exact[slot] || !*name)
+            return node->exact[slot];
+        return node->count[slot] == 1 ? node->first[slot] : NULL;
+    }
 
     /* First pass: look for an exact match */
     for (ptr = list_spells; ptr; ptr = ptr->next)
-        if (!str_cmp(name, ptr->name) && ((type == SPSK) || (ptr->type == type)))
+        if (!str_cmp(name, ptr->name) && ptr->type == type)
             return ptr;
 
     /* Second pass: look for abbreviation match */
     for (ptr = list_spells; ptr; ptr = ptr->next)
-        if (is_abbrev(name, ptr->name) && ((type == SPSK) || (ptr->type == type))) {
+        if (is_abbrev(name, ptr->name) && ptr->type == type) {
             if (++cpt > 1)
                 return NULL;
             first = ptr;
@@ -851,6 +971,12 @@ void spedit_free_memory()
         spedit_free_spell(q);
         q = n;
     }
+    list_spells = NULL;
+
+    memset(spell_by_vnum, 0, sizeof(spell_by_vnum));
+    free_spell_names(spell_names);
+    spell_names = NULL;
+    spell_tables_stale = TRUE;
 }
 
 void spedit_copyover_spell(struct str_spells *from, struct str_spells *to)
@@ -858,6 +984,7 @@ void spedit_copyover_spell(struct str_spells *from, struct str_spells *to)
     int i;
 
     spedit_empty_spell(to);
+    spell_tables_stale = TRUE;
 
     to->status = from->status;
     to->type = from->type;
@@ -919,6 +1046,8 @@ void spedit_save_internally(struct str_spells *spell)
 {
     struct str_spells *i, *p = NULL;
 
+    spell_tables_stale = TRUE;
+
     for (i = list_spells; i; p = i, i = i->next)
         if (i->vnum >= spell->vnum)
             break;
@@ -941,6 +1070,9 @@ void spedit_save_internally(struct str_spells *spell)
         list_spells = spell;
 
     spell->next = i;
+
+    if (spell->vnum >= 0 && spell->vnum <= MAX_SKILLS)
+        spell_by_vnum[spell->vnum] = spell;
 }
 
 void spedit_init_new_spell(struct str_spells *spell)
@@ -1002,7 +1002,6 @@ ASPELL(spell_disintegrate)
 
 ASPELL(spell_transport_via_plants)
 {
-    obj_vnum obj_num = NOTHING;
     room_rnum to_room = NOWHERE;
     struct obj_data *dest_obj = NULL, *tmp_obj = NULL;
 
@@ -1016,15 +1015,14 @@ ASPELL(spell_transport_via_plants)
         send_to_char(ch, "Isto nao é uma planta!\r\n");
         return;
     }
-    obj_num = GET_OBJ_VNUM(obj);
 
     // find another of that plant in the world
-    for (tmp_obj = object_list; tmp_obj; tmp_obj = tmp_obj->next) {
+    for (tmp_obj = first_obj_instance(GET_OBJ_RNUM(obj)); tmp_obj; tmp_obj = tmp_obj->next_instance) {
         if (tmp_obj == obj)
             continue;
 
         // we don't want to transport to a plant in someone's inventory
-        if (GET_OBJ_VNUM(tmp_obj) == obj_num && !tmp_obj->carried_by) {
+        if (!tmp_obj->carried_by) {
             dest_obj = tmp_obj;
 
             // 5% chance we will just stop at this obj
@@ -1509,13 +1507,13 @@ float get_weather_movement_modifier(struct char_data *ch)
     float modifier = 1.0; /* Default no change */
     int zone_num;
 
-    /* Get the character's zone weather data */
+    /* Get the character's zone weather data; climates[] only holds the climate templates */
     zone_num = world[IN_ROOM(ch)].zone;
-    if (zone_num < 0 || zone_num > top_of_zone_table) {
+    if (zone_num < 0 || zone_num > top_of_zone_table || !zone_table[zone_num].weather) {
         return modifier;
     }
 
-    weather = &climates[zone_num];
+    weather = zone_table[zone_num].weather;
 
     /* Weather conditions affect movement difficulty */
 
@@ -741,6 +741,10 @@
  */
 #define RL_SEC *PASSES_PER_SEC
 
+/** How much of a pass (input, commands and heartbeat) may go by before
+ * heartbeat() starts putting off deferrable work to a later pulse. */
+#define PULSE_BUDGET_USEC (OPT_USEC / 2)
+
 /** Controls when a zone update will occur. */
 #define PULSE_ZONE (10 RL_SEC)
 /** Controls when mobile (NPC) actions and updates will occur. */
@@ -769,8 +773,11 @@
 #define MAX_PROMPT_LENGTH 96     /**< Max length of prompt        */
 #define GARBAGE_SPACE 32         /**< Space for **OVERFLOW** etc  */
 #define SMALL_BUFSIZE 1024       /**< Static output buffer size   */
-/** Max amount of output that can be buffered */
+/** Size of the protocol plugin's scratch output buffers */
 #define LARGE_BUFSIZE (MAX_SOCK_BUF - GARBAGE_SPACE - MAX_PROMPT_LENGTH)
+#define OUTPUT_CHUNK_SIZE 4080          /**< Data bytes per output segment */
+#define MAX_OUTPUT_BACKLOG (512 * 1024) /**< Unsent output before overflow */
+#define MAX_OUTPUT_IOV 64               /**< Segments handed to one writev() */
 
 #define MAX_STRING_LENGTH 49152          /**< Max length of string, as defined */
 #define MAX_INPUT_LENGTH 512             /**< Max length per *line* of input */
@@ -912,6 +919,8 @@ struct obj_data {
 
     struct obj_data *next_content;  /**< For 'contains' lists   */
     struct obj_data *next;          /**< For the object list */
+    struct obj_data *next_instance; /**< Next live copy of this object, see obj_instance_link() */
+    struct obj_data *prev_instance; /**< Previous live copy of this object */
     struct char_data *sitting_here; /**< For furniture, who is sitting in it */
 
     struct list_data *events; /**< Used for object events */
@@ -1784,6 +1793,7 @@ struct mob_special_data {
     byte damnodice;          /**< The number of dice to roll for damage */
     byte damsizedice;        /**< The size of each die rolled for damage. */
     room_rnum appeared_room; /**< Room where NPC used appear; NOWHERE if not appeared (transient). */
+    unsigned long dormant_since; /**< Pulse it froze in a dormant zone; 0 if it is not frozen. */
 };
 
 /** An affect structure. */
@@ -1810,6 +1820,8 @@ struct char_data {
     mob_rnum nr;           /**< NPC real instance number */
     room_rnum in_room;     /**< Current location (real room number) */
     room_rnum was_in_room; /**< Previous location for linkdead people  */
+    zone_rnum presence_zone; /**< Zone whose connection count includes us */
+    bool presence_counted;   /**< Also in that zone's is_empty() player count */
     int wait;              /**< wait for how many loops before taking action. */
 
     struct char_player_data player;              /**< General PC/NPC data */
@@ -1834,6 +1846,11 @@ struct char_data {
     struct char_data *next_in_room;  /**< Next PC in the room */
     struct char_data *next;          /**< Next char_data in the room */
     struct char_data *next_fighting; /**< Next in line to fight */
+    struct char_data *next_instance; /**< Next live copy of this mob, see mob_instance_link() */
+    struct char_data *prev_instance; /**< Previous live copy of this mob */
+    struct char_data *next_in_slice; /**< Next mob in this mob's mobile_activity() slice, see mob_slice_link() */
+    struct char_data *prev_in_slice; /**< Previous mob in the same slice */
+    struct name_index_entry *name_keys; /**< This char's keywords in the name index, see name_index_add() */
     struct char_data *next_listener; /**< Next char in listener list */
 
     struct follow_type *followers; /**< List of characters following */
@@ -1862,6 +1879,26 @@ struct txt_q {
     struct txt_block *tail; /**< ? */
 };
 
+/** One segment of a descriptor's output queue. Segments are recycled through
+ * a free pool in comm.c, so steady-state output does not touch malloc. */
+struct out_chunk {
+    struct out_chunk *next;        /**< next segment, towards the tail */
+    size_t len;                    /**< bytes of data in use */
+    bool compressed;               /**< send through the MCCP stream */
+    char data[OUTPUT_CHUNK_SIZE];  /**< already protocol-translated text */
+};
+
+/** Output waiting to be sent to a descriptor. The head segment is sent from
+ * 'cursor' onward; a partial send just moves the cursor. */
+struct out_queue {
+    struct out_chunk *head; /**< oldest segment */
+    struct out_chunk *tail; /**< segment new output is appended to */
+    size_t cursor;          /**< bytes of head already sent */
+    size_t total;           /**< bytes queued and not yet sent */
+    bool overflow;          /**< backlog limit reached, dropping output */
+    bool compress;          /**< new output is to be MCCP compressed */
+};
+
 /** Master structure players. Holds the real players connection to the mud.
  * An analogy is the char_data is the body of the character, the descriptor_data
  * is the soul. */
@@ -1884,13 +1921,9 @@ struct descriptor_data {
     int has_prompt;                    /**< is the user at a prompt?             */
     char inbuf[MAX_RAW_INPUT_LENGTH];  /**< buffer for raw input		*/
     char last_input[MAX_INPUT_LENGTH]; /**< the last input			*/
-    char small_outbuf[SMALL_BUFSIZE];  /**< standard output buffer		*/
-    char *output;                      /**< ptr to the current output buffer	*/
+    struct out_queue output;           /**< q of unsent output		*/
     char **history;                    /**< History of commands, for ! mostly.	*/
     int history_pos;                   /**< Circular array position.		*/
-    int bufptr;                        /**< ptr to end of current output		*/
-    int bufspace;                      /**< space left in the output buffer	*/
-    struct txt_block *large_outbuf;    /**< ptr to large buffer, if we need it */
     struct txt_q input;                /**< q of unprocessed input		*/
     struct char_data *character;       /**< linked to char			*/
     struct char_data *original;        /**< original char if switched		*/
@@ -1899,6 +1932,11 @@ struct descriptor_data {
     struct descriptor_data *next;      /**< link to next descriptor		*/
     struct oasis_olc_data *olc;        /**< OLC info */
     protocol_t *pProtocol;             /**< Kavir plugin */
+    int io_events;                     /**< IO_xxx readiness reported by poller */
+    bool io_queued;                    /**< is this desc on the io ready list?   */
+    struct descriptor_data *io_next;   /**< link to next ready descriptor	*/
+    struct net_conn *conn;             /**< network thread endpoint, or NULL */
+    int msdp_dirty;                    /**< MSDP_DIRTY_xxx groups to recompute */
 
     struct list_data *events;
 
@@ -2055,6 +2093,8 @@ struct index_data {
 
     char *farg;              /**< String argument for special function. */
     struct trig_data *proto; /**< Points to the trigger prototype. */
+    struct char_data *mobs;  /**< Live copies of this mob (mob_index only). */
+    struct obj_data *objs;   /**< Live copies of this object (obj_index only). */
 };
 
 /** Master linked list for the mob/object prototype trigger lists. */
@@ -2182,6 +2222,8 @@ struct game_operation {
     int protocol_negotiation; /**< Enable the protocol negotiation system ? */
     int special_in_comm;      /**< Enable use of a special character in communication channels ? */
     int debug_mode;           /**< Current Debug Mode */
+    int zone_dormancy;        /**< Minutes a zone must be quiet to go dormant; 0 = never */
+    int dormant_mob_rate;     /**< Dormant mobs act one turn in this many; 0 = frozen */
 };
 
 /** The Autowizard options. */
@@ -243,6 +243,29 @@ struct in_addr {
 
 #ifdef HAVE_SYS_UIO_H
 #    include <sys/uio.h>
+#else
+/* Scatter-gather vector for platforms without writev(); comm.c then sends
+   the vectors one at a time. */
+struct iovec {
+    void *iov_base;
+    size_t iov_len;
+};
+#endif
+
+/* Use the Linux epoll() interface for socket polling when it is available.
+   Build with -DCIRCLE_NO_EPOLL (cmake -DNO_EPOLL=ON) to fall back to select(). */
+#if defined(HAVE_SYS_EPOLL_H) && !defined(CIRCLE_NO_EPOLL) && !defined(CIRCLE_UTIL)
+#    include <sys/epoll.h>
+#    define CIRCLE_EPOLL
+#endif
+
+/* Hand socket writes to a separate network thread (netio.c) when POSIX
+   threads are available.  Build with -DCIRCLE_NO_NET_THREAD
+   (cmake -DNO_NET_THREAD=ON) to keep them in the game loop. */
+#if defined(HAVE_PTHREAD_H) && defined(HAVE_SYS_UIO_H) && defined(CIRCLE_UNIX) && !defined(CIRCLE_NO_NET_THREAD) && \
+    !defined(CIRCLE_UTIL)
+#    include <pthread.h>
+#    define CIRCLE_NET_THREAD
 #endif
 
 #ifdef HAVE_SYS_STAT_H
@@ -0,0 +1,370 @@
+/* ************************************************************************
+ *  File: eventbench.c                                      Part of tbaMUD *
+ *  Usage: Micro-benchmark of the DG event queue.                          *
+ *         eventbench [-n pending] [-s seconds] [-c cancels/pulse] [-w]    *
+ *                                                                         *
+ *  Builds the real event queue from ../dg_event.c and a copy of the      *
+ *  old ten-bucket sorted queue it replaced, loads both with the same     *
+ *  pending events, then runs both through the same simulated game time,  *
+ *  where every event that fires reschedules itself and some events are   *
+ *  cancelled and recreated each pulse, and prints what each one cost.    *
+ *                                                                         *
+ *  All Rights Reserved                                                    *
+ *  Copyright (C) 2026 Vitalia Reborn Project                             *
+ ************************************************************************ */
+
+#include "dg_event.c"
+
+/* What dg_event.c needs from the rest of the game. */
+unsigned long pulse = 0;
+
+void basic_mud_log(const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+void free_mud_event(struct mud_event_data *pMudEvent) {}
+
+/* The queue as it was: NUM_LEGACY_QUEUES buckets, each kept sorted by an
+ * insertion walk from the tail, one malloc per element and per event. */
+#define NUM_LEGACY_QUEUES 10
+
+struct legacy_element {
+    void *data;
+    long key;
+    struct legacy_element *prev, *next;
+};
+
+struct legacy_queue {
+    struct legacy_element *head[NUM_LEGACY_QUEUES];
+    struct legacy_element *tail[NUM_LEGACY_QUEUES];
+};
+
+struct legacy_event {
+    EVENTFUNC(*func);
+    void *event_obj;
+    struct legacy_element *q_el;
+};
+
+static struct legacy_queue legacy_q;
+
+static long *due_at; /* When each event should fire */
+static long events_fired, events_late;
+
+static unsigned long seed = 1;
+static int num_pending = 100000, num_seconds = 600, cancels_per_pulse = 20;
+static bool wheel_only = FALSE;
+
+static void usage(void);
+static double now_secs(void);
+static long next_random(void);
+static long random_delay(void);
+static EVENTFUNC(bench_event);
+static struct legacy_element *legacy_enq(long key, void *data);
+static void legacy_deq(struct legacy_element *qe);
+static struct event *wheel_create(int i);
+static struct legacy_event *legacy_create(int i);
+static void legacy_cancel(struct legacy_event *event);
+static void legacy_process(void);
+static void run_wheel(double *fill, double *run, double *drain, long *fired, long *late);
+static void run_legacy(double *fill, double *run, double *drain, long *fired, long *late);
+
+int main(int argc, char **argv)
+{
+    double fill[2], run[2], drain[2];
+    long fired[2], late[2], pulses;
+    int opt, i;
+
+    while ((opt = getopt(argc, argv, "n:s:c:wh")) != -1) {
+        switch (opt) {
+            case 'n':
+                num_pending = atoi(optarg);
+                break;
+            case 's':
+                num_seconds = atoi(optarg);
+                break;
+            case 'c':
+                cancels_per_pulse = atoi(optarg);
+                break;
+            case 'w':
+                wheel_only = TRUE;
+                break;
+            default:
+                usage();
+        }
+    }
+    if (num_pending < 1 || num_seconds < 1 || cancels_per_pulse < 0)
+        usage();
+
+    pulses = (long)num_seconds * PASSES_PER_SEC;
+    printf("eventbench: %d pending events, %ld pulses, %d cancels per pulse.\n\n", num_pending, pulses,
+           cancels_per_pulse);
+
+    CREATE(due_at, long, num_pending);
+    if (!wheel_only)
+        run_legacy(&fill[0], &run[0], &drain[0], &fired[0], &late[0]);
+    else
+        fill[0] = run[0] = drain[0] = fired[0] = late[0] = 0;
+    run_wheel(&fill[1], &run[1], &drain[1], &fired[1], &late[1]);
+    free(due_at);
+
+    printf("%-16s %11s %10s %10s %10s %10s %10s\n", "queue", "fill ns/ev", "run ms", "ns/pulse", "fired",
+           "off time", "drain ms");
+    for (i = wheel_only; i < 2; i++)
+        printf("%-16s %11.1f %10.1f %10.0f %10ld %10ld %10.1f\n", i ? "timing wheel" : "sorted buckets",
+               fill[i] * 1e9 / num_pending, run[i] * 1e3, run[i] * 1e9 / pulses, fired[i], late[i],
+               drain[i] * 1e3);
+
+    if (late[0] || late[1])
+        printf("\neventbench: some events did not fire on the pulse they were due!\n");
+
+    return (late[0] || late[1]);
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: eventbench [-n pending] [-s seconds] [-c cancels/pulse] [-w]\n"
+                    "  -n pending        Events kept in the queue (default 100000).\n"
+                    "  -s seconds        Game time to simulate (default 600).\n"
+                    "  -c cancels/pulse  Events cancelled and recreated every pulse (default 20).\n"
+                    "  -w                Only run the timing wheel; the old queue is very slow.\n");
+    exit(1);
+}
+
+static double now_secs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* A small LCG, so both queues see exactly the same delays. */
+static long next_random(void)
+{
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+    return (long)(seed >> 33);
+}
+
+/* Mostly script waits and combat or spell cooldowns of a few seconds, some
+ * minutes-long affects, and a few timers hours or days away. */
+static long random_delay(void)
+{
+    long r = next_random() % 100;
+
+    if (r < 60)
+        return 1 + next_random() % (10 RL_SEC);
+    if (r < 90)
+        return 1 + next_random() % (10 * 60 RL_SEC);
+    if (r < 99)
+        return 1 + next_random() % (6 * 60 * 60 RL_SEC);
+    return 1 + next_random() % (3 * 24 * 60 * 60 RL_SEC);
+}
+
+/* Checks that the event came up on time and schedules it again. */
+static EVENTFUNC(bench_event)
+{
+    long *due = (long *)event_obj, delay = random_delay();
+
+    events_fired++;
+    if (*due != (long)pulse)
+        events_late++;
+    *due = pulse + delay;
+
+    return delay;
+}
+
+/* The events carry a pointer into due_at[], which must not be freed, so they
+   pose as mud events (whose cleanup is stubbed out above). */
+static struct event *wheel_create(int i)
+{
+    struct event *event;
+    long delay = random_delay();
+
+    due_at[i] = pulse + delay;
+    event = event_create(bench_event, &due_at[i], delay);
+    event->isMudEvent = TRUE;
+
+    return event;
+}
+
+static void run_wheel(double *fill, double *run, double *drain, long *fired, long *late)
+{
+    struct event **events;
+    double start;
+    long p, pulses = (long)num_seconds * PASSES_PER_SEC;
+    int i, j;
+
+    CREATE(events, struct event *, num_pending);
+    seed = 1;
+    pulse = 0;
+    events_fired = events_late = 0;
+
+    start = now_secs();
+    event_init();
+    for (i = 0; i < num_pending; i++)
+        events[i] = wheel_create(i);
+    *fill = now_secs() - start;
+
+    start = now_secs();
+    for (p = 0; p < pulses; p++) {
+        pulse++;
+        event_process();
+        for (j = 0; j < cancels_per_pulse; j++) {
+            i = next_random() % num_pending;
+            event_cancel(events[i]);
+            events[i] = wheel_create(i);
+        }
+    }
+    *run = now_secs() - start;
+    *fired = events_fired;
+    *late = events_late;
+
+    start = now_secs();
+    event_free_all();
+    *drain = now_secs() - start;
+
+    free(events);
+}
+
+static struct legacy_element *legacy_enq(long key, void *data)
+{
+    struct legacy_element *qe, *i;
+    int bucket;
+
+    CREATE(qe, struct legacy_element, 1);
+    qe->data = data;
+    qe->key = key;
+
+    bucket = key % NUM_LEGACY_QUEUES;
+
+    if (!legacy_q.head[bucket]) {
+        legacy_q.head[bucket] = qe;
+        legacy_q.tail[bucket] = qe;
+    } else {
+        for (i = legacy_q.tail[bucket]; i; i = i->prev) {
+            if (i->key < key) {
+                if (i == legacy_q.tail[bucket])
+                    legacy_q.tail[bucket] = qe;
+                else {
+                    qe->next = i->next;
+                    i->next->prev = qe;
+                }
+                qe->prev = i;
+                i->next = qe;
+                break;
+            }
+        }
+        if (i == NULL) {
+            qe->next = legacy_q.head[bucket];
+            legacy_q.head[bucket] = qe;
+            qe->next->prev = qe;
+        }
+    }
+
+    return qe;
+}
+
+static void legacy_deq(struct legacy_element *qe)
+{
+    int i = qe->key % NUM_LEGACY_QUEUES;
+
+    if (qe->prev == NULL)
+        legacy_q.head[i] = qe->next;
+    else
+        qe->prev->next = qe->next;
+
+    if (qe->next == NULL)
+        legacy_q.tail[i] = qe->prev;
+    else
+        qe->next->prev = qe->prev;
+
+    free(qe);
+}
+
+static struct legacy_event *legacy_create(int i)
+{
+    struct legacy_event *event;
+    long delay = random_delay();
+
+    due_at[i] = pulse + delay;
+    CREATE(event, struct legacy_event, 1);
+    event->func = bench_event;
+    event->event_obj = &due_at[i];
+    event->q_el = legacy_enq(due_at[i], event);
+
+    return event;
+}
+
+static void legacy_cancel(struct legacy_event *event)
+{
+    legacy_deq(event->q_el);
+    free(event);
+}
+
+static void legacy_process(void)
+{
+    struct legacy_element *head;
+    struct legacy_event *event;
+    long new_time;
+    int i = pulse % NUM_LEGACY_QUEUES;
+
+    while ((head = legacy_q.head[i]) != NULL && (long)pulse >= head->key) {
+        event = (struct legacy_event *)head->data;
+        legacy_deq(head);
+        event->q_el = NULL;
+        if ((new_time = (event->func)(event->event_obj)) > 0)
+            event->q_el = legacy_enq(new_time + pulse, event);
+        else
+            free(event);
+    }
+}
+
+static void run_legacy(double *fill, double *run, double *drain, long *fired, long *late)
+{
+    struct legacy_event **events;
+    struct legacy_element *qe, *next_qe;
+    double start;
+    long p, pulses = (long)num_seconds * PASSES_PER_SEC;
+    int i, j;
+
+    CREATE(events, struct legacy_event *, num_pending);
+    seed = 1;
+    pulse = 0;
+    events_fired = events_late = 0;
+
+    start = now_secs();
+    for (i = 0; i < num_pending; i++)
+        events[i] = legacy_create(i);
+    *fill = now_secs() - start;
+
+    start = now_secs();
+    for (p = 0; p < pulses; p++) {
+        pulse++;
+        legacy_process();
+        for (j = 0; j < cancels_per_pulse; j++) {
+            i = next_random() % num_pending;
+            legacy_cancel(events[i]);
+            events[i] = legacy_create(i);
+        }
+    }
+    *run = now_secs() - start;
+    *fired = events_fired;
+    *late = events_late;
+
+    start = now_secs();
+    for (i = 0; i < NUM_LEGACY_QUEUES; i++)
+        for (qe = legacy_q.head[i]; qe; qe = next_qe) {
+            next_qe = qe->next;
+            free(qe->data);
+            free(qe);
+        }
+    *drain = now_secs() - start;
+
+    free(events);
+}
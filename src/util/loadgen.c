@@ -0,0 +1,677 @@
+/* ************************************************************************
+ *  File: loadgen.c                                         Part of tbaMUD *
+ *  Usage: Headless load generator for a MUD running on this machine.      *
+ *         loadgen [-p port] [-n clients] [-r cmds/sec] [-d secs] ...      *
+ *                                                                         *
+ *  Opens N telnet connections to a local server, creates (or logs in)    *
+ *  one character per connection, then has every character replay a      *
+ *  weighted mix of commands at a fixed rate.  At the end it reports the   *
+ *  round trip latency of each command (command sent to prompt received)   *
+ *  and, given an immortal to watch with, how many pulses the server ran  *
+ *  late meanwhile.                                                        *
+ *                                                                         *
+ *  All Rights Reserved                                                    *
+ *  Copyright (C) 2026 Vitalia Reborn Project                             *
+ ************************************************************************ */
+
+#include "conf.h"
+#include "sysdep.h"
+#include <poll.h>
+#include <signal.h>
+#include "structs.h"
+#include "utils.h"
+
+#define MAX_CLIENTS 1000      /* Connections, not counting the watcher */
+#define MAX_MIX 64            /* Commands in a mix */
+#define CMD_LINE_LENGTH 128   /* Length of a command line */
+#define TAIL_SIZE 2048        /* Received text kept for matching prompts */
+#define CMD_TIMEOUT 30.0      /* Seconds before a command counts as lost */
+#define LOGIN_TIMEOUT 60.0    /* Seconds a login may take */
+#define REPORT_EVERY 10.0     /* Seconds between progress lines */
+
+/* MIN() and MAX() are functions in utils.c, which we don't link with. */
+#define LG_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define LG_MAX(a, b) ((a) > (b) ? (a) : (b))
+
+/* Telnet */
+#define IAC 255
+#define DONT 254
+#define DO 253
+#define WONT 252
+#define WILL 251
+#define SB 250
+#define SE 240
+
+enum { ST_FREE, ST_LOGIN, ST_PLAYING, ST_DEAD };
+
+/* What to answer at each login prompt, first match wins. */
+enum { REPLY_NAME, REPLY_PASS, REPLY_YES, REPLY_SEX, REPLY_CLASS, REPLY_TOWN, REPLY_ENTER, REPLY_MENU, REPLY_FAIL };
+
+static const struct {
+    const char *prompt;
+    int reply;
+} login_rules[] = {
+    {"Personagem:", REPLY_NAME},    {"(S/N)", REPLY_YES},        {"novamente a senha", REPLY_PASS},
+    {"senha para", REPLY_PASS},     {"Senha incorreta", REPLY_FAIL}, {"Senha:", REPLY_PASS},
+    {"sexo", REPLY_SEX},            {"Classe:", REPLY_CLASS},    {"Cidade Natal", REPLY_TOWN},
+    {"APERTE ENTER", REPLY_ENTER},  {"escolha:", REPLY_MENU},    {"Reconectando", REPLY_MENU},
+    {NULL, 0}};
+
+/* The mix used without -m: some of everything the game does a lot of. */
+static const struct {
+    int weight;
+    const char *cmd;
+} default_mix[] = {{30, "look"},      {8, "north"},
+                   {8, "south"},      {8, "east"},
+                   {8, "west"},       {10, "score"},
+                   {6, "who"},        {6, "say Testando a carga."},
+                   {4, "gossip Testando a carga."}, {4, "list"},
+                   {4, "kill guarda"}, {4, "recall"},
+                   {0, NULL}};
+
+struct latency {
+    double *samples; /* Round trips in seconds */
+    int count, size;
+};
+
+struct mix_entry {
+    int weight;
+    char cmd[CMD_LINE_LENGTH];
+    struct latency lat;
+};
+
+struct client {
+    int fd;
+    int state;
+    bool watcher;           /* Only reads the server statistics */
+    char name[32];
+    char password[32];
+    char tail[TAIL_SIZE];   /* Last text received, telnet codes removed */
+    int tail_len;
+    int telnet;             /* Telnet parser state */
+    unsigned char telnet_cmd;
+    double connected_at;
+    double sent_at;         /* When the command in flight went out, or 0 */
+    int pending;            /* Mix entry in flight */
+    double next_at;         /* When to send the next command */
+};
+
+static struct client clients[MAX_CLIENTS + 1];
+static struct mix_entry mix[MAX_MIX];
+static int num_mix = 0, total_weight = 0;
+static int num_clients = 10, port = 4000;
+static double rate = 1.0, duration = 60.0, ramp = 10.0;
+static char prefix[16] = "Carga", password[32] = "loadgen1", class_letter[2] = "G";
+static volatile sig_atomic_t interrupted = 0;
+static int timeouts = 0, disconnects = 0, login_failures = 0;
+static long overruns_start = -1, overruns_end = -1;
+
+static void usage(void);
+static double now(void);
+static void load_mix(const char *fname);
+static void add_mix(int weight, const char *cmd);
+static bool open_client(struct client *c);
+static void close_client(struct client *c, bool lost);
+static void send_line(struct client *c, const char *line);
+static void read_client(struct client *c, double t);
+static void telnet_filter(struct client *c, const unsigned char *data, int len);
+static void handle_login(struct client *c, double t);
+static void handle_prompt(struct client *c, double t);
+static void send_next(struct client *c, double t);
+static void watch_stats(struct client *c);
+static void add_latency(struct latency *lat, double secs);
+static int compare_doubles(const void *a, const void *b);
+static void report(double elapsed);
+static void on_signal(int sig);
+
+int main(int argc, char **argv)
+{
+    struct pollfd fds[MAX_CLIENTS + 1];
+    struct client *map[MAX_CLIENTS + 1];
+    char *watch = NULL, *mixfile = NULL, *p;
+    double t, start, measure_start = 0, last_report, next_connect;
+    int opt, i, n, opened = 0, playing, timeout;
+
+    while ((opt = getopt(argc, argv, "p:n:r:d:c:m:N:P:C:w:h")) != -1) {
+        switch (opt) {
+            case 'p':
+                port = atoi(optarg);
+                break;
+            case 'n':
+                num_clients = atoi(optarg);
+                break;
+            case 'r':
+                rate = atof(optarg);
+                break;
+            case 'd':
+                duration = atof(optarg);
+                break;
+            case 'c':
+                ramp = atof(optarg);
+                break;
+            case 'm':
+                mixfile = optarg;
+                break;
+            case 'N':
+                strncpy(prefix, optarg, sizeof(prefix) - 1);
+                break;
+            case 'P':
+                strncpy(password, optarg, sizeof(password) - 1);
+                break;
+            case 'C':
+                class_letter[0] = *optarg;
+                break;
+            case 'w':
+                watch = optarg;
+                break;
+            default:
+                usage();
+        }
+    }
+
+    if (num_clients < 1 || num_clients > MAX_CLIENTS || rate <= 0 || duration <= 0 || ramp <= 0 || port <= 0)
+        usage();
+    if (watch && !(p = strchr(watch, ':')))
+        usage();
+
+    if (mixfile)
+        load_mix(mixfile);
+    else
+        for (i = 0; default_mix[i].cmd; i++)
+            add_mix(default_mix[i].weight, default_mix[i].cmd);
+
+    if (!total_weight) {
+        fprintf(stderr, "loadgen: the command mix is empty.\n");
+        exit(1);
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+    srand(time(0));
+
+    /* Client 0 is the watcher, if there is one. */
+    for (i = 0; i <= num_clients; i++)
+        clients[i].fd = -1;
+    if (watch) {
+        *p = '\0';
+        clients[0].watcher = TRUE;
+        strncpy(clients[0].name, watch, sizeof(clients[0].name) - 1);
+        strncpy(clients[0].password, p + 1, sizeof(clients[0].password) - 1);
+        if (!open_client(&clients[0]))
+            exit(1);
+    }
+    for (i = 1; i <= num_clients; i++) {
+        int id = i - 1;
+
+        /* Player names may only hold letters. */
+        snprintf(clients[i].name, sizeof(clients[i].name), "%s%c%c%c", prefix, 'a' + (id / 676) % 26,
+                 'a' + (id / 26) % 26, 'a' + id % 26);
+        strcpy(clients[i].password, password);
+    }
+
+    printf("loadgen: %d clients on port %d, %.2f commands/sec each, %d commands in the mix.\n", num_clients, port,
+           rate, num_mix);
+
+    start = last_report = next_connect = now();
+
+    while (!interrupted) {
+        t = now();
+
+        /* Open connections at the ramp rate. */
+        while (opened < num_clients && t >= next_connect) {
+            open_client(&clients[++opened]);
+            next_connect += 1.0 / ramp;
+        }
+
+        for (i = 1, playing = 0; i <= num_clients; i++)
+            if (clients[i].state == ST_PLAYING)
+                playing++;
+
+        /* Measure from the moment the last connection has either logged in
+           or given up. */
+        if (!measure_start && opened == num_clients) {
+            for (i = 1; i <= num_clients; i++)
+                if (clients[i].state == ST_LOGIN)
+                    break;
+            if (i > num_clients) {
+                measure_start = t;
+                for (i = 0; i < num_mix; i++)
+                    mix[i].lat.count = 0;
+                timeouts = 0;
+                printf("loadgen: %d of %d clients playing after %.1fs, measuring for %.0fs.\n", playing,
+                       num_clients, t - start, duration);
+                if (clients[0].state == ST_PLAYING)
+                    send_line(&clients[0], "show stats");
+            }
+        }
+        if (measure_start && t - measure_start >= duration) {
+            if (clients[0].state != ST_PLAYING || overruns_end >= 0)
+                break;
+            if (!clients[0].sent_at) {
+                clients[0].sent_at = t;
+                send_line(&clients[0], "show stats");
+            } else if (t - clients[0].sent_at > CMD_TIMEOUT)
+                break;
+        }
+
+        if (t - last_report >= REPORT_EVERY) {
+            last_report = t;
+            printf("loadgen: %.0fs, %d playing, %d timeouts, %d disconnects.\n", t - start, playing, timeouts,
+                   disconnects);
+            fflush(stdout);
+        }
+
+        /* Send what is due and work out how long we can sleep. */
+        timeout = 100;
+        for (i = 0, n = 0; i <= num_clients; i++) {
+            struct client *c = &clients[i];
+
+            if (c->fd < 0)
+                continue;
+            if (c->state == ST_LOGIN && t - c->connected_at > LOGIN_TIMEOUT) {
+                login_failures++;
+                close_client(c, FALSE);
+                continue;
+            }
+            if (c->state == ST_PLAYING && !c->watcher) {
+                if (c->sent_at && t - c->sent_at > CMD_TIMEOUT) {
+                    timeouts++;
+                    c->sent_at = 0;
+                }
+                if (!c->sent_at && t >= c->next_at)
+                    send_next(c, t);
+                if (!c->sent_at && (c->next_at - t) * 1000 < timeout)
+                    timeout = LG_MAX(0, (int)((c->next_at - t) * 1000));
+            }
+            fds[n].fd = c->fd;
+            fds[n].events = POLLIN;
+            map[n++] = c;
+        }
+        if (opened < num_clients)
+            timeout = LG_MIN(timeout, LG_MAX(0, (int)((next_connect - t) * 1000)));
+
+        if (poll(fds, n, timeout) < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("poll");
+            break;
+        }
+
+        t = now();
+        for (i = 0; i < n; i++)
+            if (fds[i].revents & (POLLIN | POLLERR | POLLHUP))
+                read_client(map[i], t);
+    }
+
+    report(measure_start ? now() - measure_start : 0);
+
+    for (i = 0; i <= num_clients; i++)
+        if (clients[i].fd >= 0)
+            close_client(&clients[i], FALSE);
+
+    return (0);
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "Usage: loadgen [-p port] [-n clients] [-r cmds/sec] [-d secs] [-c conns/sec]\n"
+            "               [-m mixfile] [-N prefix] [-P password] [-C class] [-w name:password]\n"
+            "  -p port       Port of the MUD on this machine (default 4000).\n"
+            "  -n clients    Number of connections, up to %d (default 10).\n"
+            "  -r cmds/sec   Commands each client sends per second (default 1).\n"
+            "  -d secs       How long to measure once everyone is in (default 60).\n"
+            "  -c conns/sec  How fast to open the connections (default 10).\n"
+            "  -m mixfile    Command mix, one '<weight> <command>' per line.\n"
+            "  -N prefix     Character names are prefix + aaa, aab, ... (default Carga).\n"
+            "  -P password   Password for the characters (default loadgen1).\n"
+            "  -C class      Class letter for new characters (default G).\n"
+            "  -w name:pass  Immortal to read 'show stats' with, for pulse overruns.\n",
+            MAX_CLIENTS);
+    exit(1);
+}
+
+static double now(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static void load_mix(const char *fname)
+{
+    char line[CMD_LINE_LENGTH + 16], *cmd;
+    FILE *fl;
+    int weight;
+
+    if (!(fl = fopen(fname, "r"))) {
+        perror(fname);
+        exit(1);
+    }
+
+    while (fgets(line, sizeof(line), fl)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (*line == '#' || *line == '\0')
+            continue;
+        weight = strtol(line, &cmd, 10);
+        while (isspace(*cmd))
+            cmd++;
+        if (weight <= 0 || !*cmd) {
+            fprintf(stderr, "loadgen: ignoring mix line '%s'.\n", line);
+            continue;
+        }
+        add_mix(weight, cmd);
+    }
+    fclose(fl);
+}
+
+static void add_mix(int weight, const char *cmd)
+{
+    if (num_mix >= MAX_MIX) {
+        fprintf(stderr, "loadgen: only %d commands fit in a mix.\n", MAX_MIX);
+        return;
+    }
+    mix[num_mix].weight = weight;
+    strncpy(mix[num_mix].cmd, cmd, CMD_LINE_LENGTH - 1);
+    total_weight += weight;
+    num_mix++;
+}
+
+static bool open_client(struct client *c)
+{
+    struct sockaddr_in sa;
+    int fd;
+
+    if ((fd = socket(PF_INET, SOCK_STREAM, 0)) < 0) {
+        perror("socket");
+        return (FALSE);
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(port);
+    sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (connect(fd, (struct sockaddr *)&sa, sizeof(sa)) < 0) {
+        perror("connect");
+        close(fd);
+        return (FALSE);
+    }
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+
+    c->fd = fd;
+    c->state = ST_LOGIN;
+    c->tail_len = 0;
+    c->telnet = 0;
+    c->sent_at = 0;
+    c->connected_at = now();
+    return (TRUE);
+}
+
+static void close_client(struct client *c, bool lost)
+{
+    if (lost)
+        disconnects++;
+    close(c->fd);
+    c->fd = -1;
+    c->state = ST_DEAD;
+}
+
+static void send_line(struct client *c, const char *line)
+{
+    char buf[CMD_LINE_LENGTH + 3];
+    int len = snprintf(buf, sizeof(buf), "%s\r\n", line);
+
+    /* Lines are tiny, a full socket buffer means the server is stuck. */
+    if (write(c->fd, buf, len) != len)
+        close_client(c, TRUE);
+}
+
+static void read_client(struct client *c, double t)
+{
+    unsigned char buf[8192];
+    int len;
+
+    while (c->fd >= 0) {
+        len = read(c->fd, buf, sizeof(buf));
+        if (len == 0 || (len < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            if (c->state == ST_LOGIN)
+                login_failures++;
+            close_client(c, c->state == ST_PLAYING);
+            return;
+        }
+        if (len < 0)
+            break;
+        telnet_filter(c, buf, len);
+    }
+
+    if (c->fd < 0)
+        return;
+    if (c->state == ST_LOGIN)
+        handle_login(c, t);
+    else if (c->state == ST_PLAYING)
+        handle_prompt(c, t);
+}
+
+/* Strip telnet commands from what the server sent, refusing every option
+   it offers, and keep the tail of the text. */
+static void telnet_filter(struct client *c, const unsigned char *data, int len)
+{
+    unsigned char reply[3];
+    int i;
+
+    for (i = 0; i < len; i++) {
+        unsigned char ch = data[i];
+
+        switch (c->telnet) {
+            case 0: /* Text */
+                if (ch == IAC) {
+                    c->telnet = 1;
+                    continue;
+                }
+                break;
+            case 1: /* After IAC */
+                c->telnet = 0;
+                if (ch == IAC)
+                    break;
+                if (ch == WILL || ch == WONT || ch == DO || ch == DONT) {
+                    c->telnet_cmd = ch;
+                    c->telnet = 2;
+                } else if (ch == SB)
+                    c->telnet = 3;
+                continue;
+            case 2: /* Option of WILL/WONT/DO/DONT */
+                c->telnet = 0;
+                reply[0] = IAC;
+                reply[1] = (c->telnet_cmd == WILL) ? DONT : (c->telnet_cmd == DO) ? WONT : 0;
+                reply[2] = ch;
+                if (reply[1] && write(c->fd, reply, 3) < 0)
+                    ; /* The next read will notice */
+                continue;
+            case 3: /* Subnegotiation, up to IAC SE */
+                if (ch == IAC)
+                    c->telnet = 4;
+                continue;
+            case 4:
+                c->telnet = (ch == SE) ? 0 : 3;
+                continue;
+        }
+
+        if (c->tail_len == TAIL_SIZE - 1) {
+            memmove(c->tail, c->tail + TAIL_SIZE / 2, TAIL_SIZE / 2 - 1);
+            c->tail_len = TAIL_SIZE / 2 - 1;
+        }
+        c->tail[c->tail_len++] = ch;
+    }
+    c->tail[c->tail_len] = '\0';
+}
+
+static void handle_login(struct client *c, double t)
+{
+    int i;
+
+    for (i = 0; login_rules[i].prompt; i++)
+        if (strstr(c->tail, login_rules[i].prompt))
+            break;
+    if (!login_rules[i].prompt)
+        return;
+
+    c->tail_len = 0;
+    *c->tail = '\0';
+
+    switch (login_rules[i].reply) {
+        case REPLY_NAME:
+            send_line(c, c->name);
+            break;
+        case REPLY_PASS:
+            send_line(c, c->password);
+            break;
+        case REPLY_YES:
+            send_line(c, "S");
+            break;
+        case REPLY_SEX:
+            send_line(c, "M");
+            break;
+        case REPLY_CLASS:
+            send_line(c, class_letter);
+            break;
+        case REPLY_TOWN:
+            send_line(c, "1");
+            break;
+        case REPLY_ENTER:
+            send_line(c, "");
+            break;
+        case REPLY_MENU:
+            if (strcmp(login_rules[i].prompt, "Reconectando"))
+                send_line(c, "1");
+            c->state = ST_PLAYING;
+            /* Spread the first commands out over one interval. */
+            c->next_at = t + (rand() / (RAND_MAX + 1.0)) / rate;
+            break;
+        case REPLY_FAIL:
+            fprintf(stderr, "loadgen: wrong password for %s.\n", c->name);
+            login_failures++;
+            close_client(c, FALSE);
+            break;
+    }
+}
+
+static void handle_prompt(struct client *c, double t)
+{
+    if (c->watcher) {
+        watch_stats(c);
+        return;
+    }
+
+    /* The prompt ends in "> "; anything else is more output on its way. */
+    if (c->tail_len < 2 || strcmp(c->tail + c->tail_len - 2, "> "))
+        return;
+
+    c->tail_len = 0;
+    *c->tail = '\0';
+
+    if (!c->sent_at)
+        return;
+
+    add_latency(&mix[c->pending].lat, t - c->sent_at);
+
+    /* Keep to the rate, with some jitter so the clients don't march in step. */
+    c->next_at = c->sent_at + (0.5 + rand() / (RAND_MAX + 1.0)) / rate;
+    c->sent_at = 0;
+}
+
+static void send_next(struct client *c, double t)
+{
+    int i, pick = rand() % total_weight;
+
+    for (i = 0; i < num_mix - 1 && pick >= mix[i].weight; i++)
+        pick -= mix[i].weight;
+
+    c->pending = i;
+    c->sent_at = t;
+    c->tail_len = 0;
+    *c->tail = '\0';
+    send_line(c, mix[i].cmd);
+}
+
+/* Pick the pulse overrun count out of 'show stats'. */
+static void watch_stats(struct client *c)
+{
+    char *p = strstr(c->tail, "pulse overruns"), *q;
+
+    if (!p)
+        return;
+    for (q = p; q > c->tail && isspace(q[-1]); q--)
+        ;
+    while (q > c->tail && isdigit(q[-1]))
+        q--;
+
+    if (overruns_start < 0)
+        overruns_start = atol(q);
+    else
+        overruns_end = atol(q);
+
+    c->tail_len = 0;
+    *c->tail = '\0';
+}
+
+static void add_latency(struct latency *lat, double secs)
+{
+    if (lat->count == lat->size) {
+        lat->size = lat->size ? lat->size * 2 : 256;
+        if (!(lat->samples = realloc(lat->samples, lat->size * sizeof(double)))) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    lat->samples[lat->count++] = secs;
+}
+
+static int compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+#define PCT(lat, p) ((lat)->samples[LG_MIN((lat)->count - 1, (int)((lat)->count * (p)))] * 1000.0)
+
+static void report(double elapsed)
+{
+    struct latency all = {NULL, 0, 0};
+    int i, j, total = 0;
+
+    printf("\nloadgen: %.0fs measured, %d timeouts, %d disconnects, %d failed logins.\n", elapsed, timeouts,
+           disconnects, login_failures);
+    printf("%-28s %8s %9s %9s %9s %9s\n", "command", "count", "p50 ms", "p90 ms", "p99 ms", "max ms");
+
+    for (i = 0; i < num_mix; i++) {
+        struct latency *lat = &mix[i].lat;
+
+        if (!lat->count)
+            continue;
+        qsort(lat->samples, lat->count, sizeof(double), compare_doubles);
+        printf("%-28.28s %8d %9.1f %9.1f %9.1f %9.1f\n", mix[i].cmd, lat->count, PCT(lat, 0.50), PCT(lat, 0.90),
+               PCT(lat, 0.99), lat->samples[lat->count - 1] * 1000.0);
+        for (j = 0; j < lat->count; j++)
+            add_latency(&all, lat->samples[j]);
+        total += lat->count;
+    }
+
+    if (all.count) {
+        qsort(all.samples, all.count, sizeof(double), compare_doubles);
+        printf("%-28s %8d %9.1f %9.1f %9.1f %9.1f\n", "(all)", all.count, PCT(&all, 0.50), PCT(&all, 0.90),
+               PCT(&all, 0.99), all.samples[all.count - 1] * 1000.0);
+        printf("loadgen: %.1f commands/sec.\n", elapsed > 0 ? total / elapsed : 0.0);
+        free(all.samples);
+    }
+
+    if (overruns_start >= 0 && overruns_end >= 0)
+        printf("loadgen: %ld pulse overruns on the server while measuring.\n", overruns_end - overruns_start);
+    else
+        printf("loadgen: pulse overruns unknown (use -w with an immortal to read them).\n");
+}
+
+static void on_signal(int sig) { interrupted = 1; }
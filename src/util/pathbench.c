@@ -0,0 +1,506 @@
+/* ************************************************************************
+ *  File: pathbench.c                                       Part of tbaMUD *
+ *  Usage: Benchmark of find_first_step_enhanced() on the real world.     *
+ *         pathbench [-d worlddir] [-n pairs] [-s seed] [-l]               *
+ *                                                                         *
+ *  Builds the real search from ../graph.c, loads the rooms, exits and    *
+ *  zones of the world files, then runs the same random room pairs        *
+ *  through the A* search, a plain Dijkstra over the same movement costs  *
+ *  and the room BFS it replaced, and prints how many rooms each one      *
+ *  expanded and what it cost.  The A* costs must match Dijkstra's.       *
+ *  Doors are left as the world files have them, before any zone reset,   *
+ *  and the weather does not change the costs.                            *
+ *                                                                         *
+ *  All Rights Reserved                                                    *
+ *  Copyright (C) 2026 Vitalia Reborn Project                             *
+ ************************************************************************ */
+
+#include "graph.c"
+#include "constants.c"
+
+/* What graph.c needs from the rest of the game. */
+struct room_data *world = NULL;
+room_rnum top_of_world = 0;
+struct zone_data *zone_table = NULL;
+zone_rnum top_of_zone_table = 0;
+struct index_data *obj_index = NULL;
+obj_rnum top_of_objt = 0;
+mob_rnum top_of_mobt = 0;
+struct char_data *character_list = NULL;
+struct config_data config_info;
+
+int MAX(int a, int b) { return (a > b ? a : b); }
+
+int MIN(int a, int b) { return (a < b ? a : b); }
+
+void basic_mud_log(const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+int rand_number(int from, int to) { return (from); }
+
+size_t send_to_char(struct char_data *ch, const char *messg, ...) { return (0); }
+
+char *two_arguments(char *argument, char *first_arg, char *second_arg)
+{
+    *first_arg = *second_arg = '\0';
+    return (argument);
+}
+
+struct char_data *get_char_vis(struct char_data *ch, char *name, int *number, int where) { return (NULL); }
+
+int get_mob_skill(struct char_data *ch, int skill_num) { return (0); }
+
+int has_key(struct char_data *ch, obj_vnum key) { return (0); }
+
+void hit(struct char_data *ch, struct char_data *victim, int type) {}
+
+int perform_move(struct char_data *ch, int dir, int following) { return (0); }
+
+ACMD(do_say) {}
+
+float get_weather_movement_modifier(struct char_data *ch) { return (1.0); }
+
+/* As db.c reads flag fields: letters, or a plain number. */
+bitvector_t asciiflag_conv(char *flag)
+{
+    bitvector_t flags = 0;
+    int is_num = TRUE;
+    char *p;
+
+    for (p = flag; *p; p++) {
+        if (islower(*p))
+            flags |= 1 << (*p - 'a');
+        else if (isupper(*p))
+            flags |= 1 << (26 + (*p - 'A'));
+
+        if (!isdigit(*p) && (*p != '-' || p != flag))
+            is_num = FALSE;
+    }
+
+    if (is_num)
+        flags = atol(flag);
+
+    return (flags);
+}
+
+/* The three searches, in the order they are reported. */
+enum { SEARCH_ASTAR, SEARCH_DIJKSTRA, SEARCH_BFS, NUM_SEARCHES };
+
+static const char *search_names[NUM_SEARCHES] = {"A* (landmarks)", "Dijkstra", "room BFS (old)"};
+
+static unsigned long seed = 1;
+static int num_pairs = 2000;
+static bool local_pairs = FALSE;
+static char world_dir[256] = "lib/world";
+
+static struct char_data bench_char;
+static int step_cost[NUM_ROOM_SECTORS];
+
+static void usage(void);
+static double now_secs(void);
+static long next_random(void);
+static FILE *open_world_file(const char *kind, const char *name);
+static bool skip_string(FILE *fl);
+static void load_zones(void);
+static void load_rooms(void);
+static void read_room(FILE *fl, struct room_data *room, room_vnum vnum);
+static int room_compare(const void *a, const void *b);
+static room_rnum find_room(room_vnum vnum);
+static void renum_rooms(void);
+static int dijkstra_search(room_rnum src, room_rnum target, int *total_cost, long *expanded);
+static int bfs_search(room_rnum src, room_rnum target, long *expanded);
+
+int main(int argc, char **argv)
+{
+    double start, elapsed[NUM_SEARCHES] = {0, 0, 0}, landmark_secs;
+    long expanded[NUM_SEARCHES] = {0, 0, 0}, most[NUM_SEARCHES] = {0, 0, 0}, found[NUM_SEARCHES] = {0, 0, 0};
+    long before, rooms;
+    room_rnum zone_first, zone_size;
+    int opt, i, s, dir[NUM_SEARCHES], cost[NUM_SEARCHES], cost_mismatches = 0, reach_mismatches = 0;
+    room_rnum src, target;
+
+    while ((opt = getopt(argc, argv, "d:n:s:lh")) != -1) {
+        switch (opt) {
+            case 'd':
+                snprintf(world_dir, sizeof(world_dir), "%s", optarg);
+                break;
+            case 'n':
+                num_pairs = atoi(optarg);
+                break;
+            case 's':
+                seed = strtoul(optarg, NULL, 10);
+                break;
+            case 'l':
+                local_pairs = TRUE;
+                break;
+            default:
+                usage();
+        }
+    }
+    if (num_pairs < 1)
+        usage();
+
+    config_info.play.diagonal_dirs = YES;
+    config_info.play.track_through_doors = YES;
+
+    load_zones();
+    load_rooms();
+    renum_rooms();
+    printf("pathbench: %d rooms in %d zones, %d %s pairs.\n\n", top_of_world + 1, top_of_zone_table + 1, num_pairs,
+           local_pairs ? "same zone" : "random");
+
+    /* The same per-sector costs find_first_step_enhanced() works out. */
+    for (i = 0; i < NUM_ROOM_SECTORS; i++)
+        step_cost[i] = MAX((int)(movement_loss[i] * get_weather_movement_modifier(&bench_char)), 1);
+
+    start = now_secs();
+    landmarks_ready();
+    landmark_secs = now_secs() - start;
+
+    for (i = 0; i < num_pairs; i++) {
+        src = next_random() % (top_of_world + 1);
+        if (local_pairs) {
+            for (zone_first = src; zone_first > 0 && world[zone_first - 1].zone == world[src].zone; zone_first--)
+                ;
+            for (zone_size = 1; zone_first + zone_size <= top_of_world &&
+                                world[zone_first + zone_size].zone == world[src].zone;
+                 zone_size++)
+                ;
+            target = zone_first + next_random() % zone_size;
+        } else
+            target = next_random() % (top_of_world + 1);
+
+        before = get_astar_rooms_expanded();
+        start = now_secs();
+        dir[SEARCH_ASTAR] = find_first_step_enhanced(&bench_char, src, target, &cost[SEARCH_ASTAR]);
+        elapsed[SEARCH_ASTAR] += now_secs() - start;
+        rooms = get_astar_rooms_expanded() - before;
+        expanded[SEARCH_ASTAR] += rooms;
+        most[SEARCH_ASTAR] = MAX(most[SEARCH_ASTAR], rooms);
+
+        rooms = 0;
+        start = now_secs();
+        dir[SEARCH_DIJKSTRA] = dijkstra_search(src, target, &cost[SEARCH_DIJKSTRA], &rooms);
+        elapsed[SEARCH_DIJKSTRA] += now_secs() - start;
+        expanded[SEARCH_DIJKSTRA] += rooms;
+        most[SEARCH_DIJKSTRA] = MAX(most[SEARCH_DIJKSTRA], rooms);
+
+        rooms = 0;
+        start = now_secs();
+        dir[SEARCH_BFS] = bfs_search(src, target, &rooms);
+        elapsed[SEARCH_BFS] += now_secs() - start;
+        expanded[SEARCH_BFS] += rooms;
+        most[SEARCH_BFS] = MAX(most[SEARCH_BFS], rooms);
+
+        for (s = 0; s < NUM_SEARCHES; s++)
+            if (dir[s] >= 0)
+                found[s]++;
+        if ((dir[SEARCH_ASTAR] >= 0) != (dir[SEARCH_DIJKSTRA] >= 0) ||
+            (dir[SEARCH_ASTAR] >= 0) != (dir[SEARCH_BFS] >= 0))
+            reach_mismatches++;
+        else if (dir[SEARCH_ASTAR] >= 0 && cost[SEARCH_ASTAR] != cost[SEARCH_DIJKSTRA])
+            cost_mismatches++;
+    }
+
+    printf("Landmarks built in %.1f ms.\n\n", landmark_secs * 1e3);
+    printf("%-16s %8s %14s %12s %12s\n", "search", "found", "rooms/search", "most rooms", "us/search");
+    for (s = 0; s < NUM_SEARCHES; s++)
+        printf("%-16s %8ld %14.1f %12ld %12.1f\n", search_names[s], found[s], (double)expanded[s] / num_pairs, most[s],
+               elapsed[s] * 1e6 / num_pairs);
+
+    if (reach_mismatches || cost_mismatches)
+        printf("\npathbench: %d pairs disagree on reachability, %d on the cheapest cost!\n", reach_mismatches,
+               cost_mismatches);
+
+    return (reach_mismatches || cost_mismatches);
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: pathbench [-d worlddir] [-n pairs] [-s seed] [-l]\n"
+                    "  -d worlddir  Directory holding wld/ and zon/ (default lib/world).\n"
+                    "  -n pairs     Room pairs to search (default 2000).\n"
+                    "  -s seed      Seed for the room pairs (default 1).\n"
+                    "  -l           Pick both rooms of a pair in the same zone.\n");
+    exit(1);
+}
+
+static double now_secs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* A small LCG, so every run with the same seed searches the same pairs. */
+static long next_random(void)
+{
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+    return (long)(seed >> 33);
+}
+
+static FILE *open_world_file(const char *kind, const char *name)
+{
+    char path[512];
+    FILE *fl;
+
+    snprintf(path, sizeof(path), "%s/%s/%s", world_dir, kind, name);
+    if (!(fl = fopen(path, "r"))) {
+        perror(path);
+        exit(1);
+    }
+    return (fl);
+}
+
+/* Skips a string ended by '~', as fread_string() reads it. */
+static bool skip_string(FILE *fl)
+{
+    char line[READ_SIZE];
+
+    while (fgets(line, sizeof(line), fl))
+        if (strchr(line, '~'))
+            return (TRUE);
+    return (FALSE);
+}
+
+/* Only the number and room range of each zone matter here. */
+static void load_zones(void)
+{
+    char name[256], line[READ_SIZE];
+    FILE *index, *fl;
+    int count = 0, bot, top;
+
+    index = open_world_file("zon", "index");
+    while (fscanf(index, "%255s", name) == 1 && *name != '$') {
+        fl = open_world_file("zon", name);
+        if (fgets(line, sizeof(line), fl) && *line == '#') {
+            RECREATE(zone_table, struct zone_data, count + 1);
+            memset(&zone_table[count], 0, sizeof(struct zone_data));
+            zone_table[count].number = atoi(line + 1);
+            if (skip_string(fl) && skip_string(fl) && fgets(line, sizeof(line), fl) && /* builders, name */
+                sscanf(line, "%d %d", &bot, &top) == 2) {
+                zone_table[count].bot = bot;
+                zone_table[count].top = top;
+                count++;
+            }
+        }
+        fclose(fl);
+    }
+    fclose(index);
+
+    if (!count) {
+        fprintf(stderr, "pathbench: no zones in %s/zon.\n", world_dir);
+        exit(1);
+    }
+    top_of_zone_table = count - 1;
+}
+
+static void load_rooms(void)
+{
+    char name[256], line[READ_SIZE];
+    FILE *index, *fl;
+    int num_rooms = 0, allocated = 0;
+
+    index = open_world_file("wld", "index");
+    while (fscanf(index, "%255s", name) == 1 && *name != '$') {
+        fl = open_world_file("wld", name);
+        while (fgets(line, sizeof(line), fl) && *line != '$') {
+            if (*line != '#')
+                continue;
+            if (num_rooms >= allocated) {
+                allocated = allocated ? allocated * 2 : 4096;
+                RECREATE(world, struct room_data, allocated);
+            }
+            read_room(fl, &world[num_rooms++], atoi(line + 1));
+        }
+        fclose(fl);
+    }
+    fclose(index);
+
+    if (!num_rooms) {
+        fprintf(stderr, "pathbench: no rooms in %s/wld.\n", world_dir);
+        exit(1);
+    }
+    top_of_world = num_rooms - 1;
+}
+
+/* Reads one room after its "#vnum" line, keeping the flags, the sector and
+   the exits.  Exits point at vnums until renum_rooms(). */
+static void read_room(FILE *fl, struct room_data *room, room_vnum vnum)
+{
+    struct room_direction_data *exit;
+    char line[READ_SIZE], flags[4][128];
+    int zone, sector, key, to, dir;
+
+    memset(room, 0, sizeof(struct room_data));
+    room->number = vnum;
+    room->zone = NOWHERE;
+
+    skip_string(fl); /* name */
+    skip_string(fl); /* description */
+    if (!fgets(line, sizeof(line), fl))
+        return;
+    if (sscanf(line, "%d %127s %127s %127s %127s %d", &zone, flags[0], flags[1], flags[2], flags[3], &sector) == 6) {
+        for (dir = 0; dir < RF_ARRAY_MAX; dir++)
+            room->room_flags[dir] = asciiflag_conv(flags[dir]);
+        room->sector_type = sector;
+    } else if (sscanf(line, "%d %127s %d", &zone, flags[0], &sector) == 3) {
+        room->room_flags[0] = asciiflag_conv(flags[0]);
+        room->sector_type = sector;
+    }
+    if (room->sector_type < 0 || room->sector_type >= NUM_ROOM_SECTORS)
+        room->sector_type = SECT_INSIDE;
+
+    while (fgets(line, sizeof(line), fl) && *line != 'S') {
+        if (*line == 'E') {
+            skip_string(fl); /* keywords */
+            skip_string(fl); /* description */
+        } else if (*line == 'D') {
+            dir = atoi(line + 1);
+            skip_string(fl); /* description */
+            skip_string(fl); /* keyword */
+            if (!fgets(line, sizeof(line), fl) || sscanf(line, "%127s %d %d", flags[0], &key, &to) != 3 || dir < 0 ||
+                dir >= NUM_OF_DIRS)
+                continue;
+            CREATE(exit, struct room_direction_data, 1);
+            exit->exit_info = asciiflag_conv(flags[0]) ? EX_ISDOOR : 0;
+            exit->key = key;
+            exit->to_room = to < 0 ? NOWHERE : to;
+            room->dir_option[dir] = exit;
+        }
+    }
+}
+
+static int room_compare(const void *a, const void *b)
+{
+    return (((const struct room_data *)a)->number - ((const struct room_data *)b)->number);
+}
+
+static room_rnum find_room(room_vnum vnum)
+{
+    int bot = 0, top = top_of_world, mid;
+
+    if (vnum == NOWHERE)
+        return (NOWHERE);
+
+    while (bot <= top) {
+        mid = (bot + top) / 2;
+        if (world[mid].number == vnum)
+            return (mid);
+        if (world[mid].number > vnum)
+            top = mid - 1;
+        else
+            bot = mid + 1;
+    }
+    return (NOWHERE);
+}
+
+/* Sorts the rooms as the game keeps them, puts each in its zone and turns
+   the exits' vnums into rnums. */
+static void renum_rooms(void)
+{
+    room_rnum room;
+    zone_rnum zone;
+    int dir;
+
+    qsort(world, top_of_world + 1, sizeof(struct room_data), room_compare);
+
+    for (room = 0; room <= top_of_world; room++) {
+        for (zone = 0; zone <= top_of_zone_table; zone++)
+            if (world[room].number >= zone_table[zone].bot && world[room].number <= zone_table[zone].top)
+                break;
+        world[room].zone = zone <= top_of_zone_table ? zone : 0;
+
+        for (dir = 0; dir < NUM_OF_DIRS; dir++)
+            if (world[room].dir_option[dir])
+                world[room].dir_option[dir]->to_room = find_room(world[room].dir_option[dir]->to_room);
+    }
+}
+
+/* find_first_step_enhanced() without the landmark bound. */
+static int dijkstra_search(room_rnum src, room_rnum target, int *total_cost, long *expanded)
+{
+    struct path_heap_entry top;
+    room_rnum room, to;
+    int dir, cost;
+
+    *total_cost = 0;
+    if (src == target)
+        return (BFS_ALREADY_THERE);
+
+    bfs_begin();
+    path_heap_size = 0;
+    MARK(src);
+    bfs_hops[src] = 0;
+    bfs_first[src] = -1;
+    path_heap_push(0, 0, src);
+
+    while (path_heap_size) {
+        top = path_heap_pop();
+        room = top.node;
+        if (top.cost != bfs_hops[room])
+            continue;
+        (*expanded)++;
+        if (room == target) {
+            *total_cost = top.cost;
+            return (bfs_first[room]);
+        }
+
+        for (dir = 0; dir < DIR_COUNT; dir++) {
+            if (!TRACKABLE_EDGE(room, dir))
+                continue;
+            to = TOROOM(room, dir);
+            cost = top.cost + step_cost[SECT(to)];
+            if (IS_MARKED(to) && bfs_hops[to] <= cost)
+                continue;
+            MARK(to);
+            bfs_hops[to] = cost;
+            bfs_first[to] = room == src ? dir : bfs_first[room];
+            path_heap_push(cost, cost, to);
+        }
+    }
+
+    return (BFS_NO_PATH);
+}
+
+/* The search find_first_step_enhanced() used to run: a breadth-first walk
+   that counts rooms, not movement points. */
+static int bfs_search(room_rnum src, room_rnum target, long *expanded)
+{
+    room_rnum room;
+    int dir;
+
+    if (src == target)
+        return (BFS_ALREADY_THERE);
+
+    bfs_begin();
+    MARK(src);
+    for (dir = 0; dir < DIR_COUNT; dir++)
+        if (VALID_EDGE(src, dir)) {
+            MARK(TOROOM(src, dir));
+            bfs_enqueue(TOROOM(src, dir), dir);
+        }
+
+    while (bfs_head < bfs_tail) {
+        room = bfs_queue[bfs_head].room;
+        (*expanded)++;
+        if (room == target)
+            return (bfs_queue[bfs_head].dir);
+        for (dir = 0; dir < DIR_COUNT; dir++)
+            if (VALID_EDGE(room, dir)) {
+                MARK(TOROOM(room, dir));
+                bfs_enqueue(TOROOM(room, dir), bfs_queue[bfs_head].dir);
+            }
+        bfs_head++;
+    }
+
+    return (BFS_NO_PATH);
+}
@@ -380,6 +380,7 @@ void mudlog(int type, int level, int file, const char *str, ...)
 {
     char buf[MAX_STRING_LENGTH];
     struct descriptor_data *i;
+    struct broadcast b;
     va_list args;
 
     if (str == NULL)
@@ -400,6 +401,7 @@ void mudlog(int type, int level, int file, const char *str, ...)
     va_end(args);
     strcat(buf, " ]\r\n"); /* strcat: OK */
 
+    broadcast_init(&b, "%s", buf);
     for (i = descriptor_list; i; i = i->next) {
         if (STATE(i) != CON_PLAYING || IS_NPC(i->character)) /* switch */
             continue;
@@ -410,8 +412,11 @@ void mudlog(int type, int level, int file, const char *str, ...)
         if (type > (PRF_FLAGGED(i->character, PRF_LOG1) ? 1 : 0) + (PRF_FLAGGED(i->character, PRF_LOG2) ? 2 : 0))
             continue;
 
-        send_to_char(i->character, "%s%s%s", CCGRN(i->character, C_NRM), buf, CCNRM(i->character, C_NRM));
+        send_to_char(i->character, "%s", CCGRN(i->character, C_NRM));
+        broadcast_send(&b, i);
+        send_to_char(i->character, "%s", CCNRM(i->character, C_NRM));
     }
+    broadcast_free(&b);
 }
 
 /** Take a bitvector and return a human readable
@@ -693,6 +698,7 @@ void stop_follower(struct char_data *ch)
 
     ch->master = NULL;
     REMOVE_BIT_AR(AFF_FLAGS(ch), AFF_CHARM);
+    MSDP_DIRTY(ch, MSDP_DIRTY_GROUP);
 }
 
 /** Finds the number of follows that are following, and charmed by, the
@@ -746,6 +752,7 @@ void add_follower(struct char_data *ch, struct char_data *leader)
     }
 
     ch->master = leader;
+    MSDP_DIRTY(ch, MSDP_DIRTY_GROUP);
 
     CREATE(k, struct follow_type, 1);
 
@@ -2721,11 +2728,7 @@ void mob_posts_quest(struct char_data *ch, obj_vnum item_vnum, int reward)
     struct char_data *qm_char = NULL;
     if (qm_mob_rnum != NOBODY) {
         /* Find questmaster in world to get their name */
-        for (qm_char = character_list; qm_char; qm_char = qm_char->next) {
-            if (IS_NPC(qm_char) && GET_MOB_RNUM(qm_char) == qm_mob_rnum) {
-                break;
-            }
-        }
+        qm_char = first_mob_instance(qm_mob_rnum);
     }
 
     /* Get reward item name for quest info */
@@ -3350,7 +3353,8 @@ void mob_posts_protection_quest(struct char_data *ch, int quest_type, int target
 
             /* Check if any instance of this mob is in a shop room */
             struct char_data *mob_instance;
-            for (mob_instance = character_list; mob_instance; mob_instance = mob_instance->next) {
+            for (mob_instance = first_mob_instance(target_mob_rnum); mob_instance;
+                 mob_instance = mob_instance->next_instance) {
                 /* Safety check: validate mob_instance before dereferencing */
                 if (!mob_instance)
                     break;
@@ -5024,13 +5028,9 @@ mob_vnum find_questmaster_for_zone_enhanced(zone_rnum zone, struct char_data *re
                 qm_zone = world[mob_proto[mob_rnum].in_room].zone;
             } else {
                 /* Look for instance in world */
-                struct char_data *qm_char;
-                for (qm_char = character_list; qm_char; qm_char = qm_char->next) {
-                    if (IS_NPC(qm_char) && GET_MOB_RNUM(qm_char) == mob_rnum) {
-                        qm_zone = world[IN_ROOM(qm_char)].zone;
-                        break;
-                    }
-                }
+                struct char_data *qm_char = first_mob_instance(mob_rnum);
+                if (qm_char)
+                    qm_zone = world[IN_ROOM(qm_char)].zone;
             }
 
             if (qm_zone != NOWHERE) {
@@ -5112,12 +5112,10 @@ mob_vnum find_questmaster_for_zone(zone_rnum zone)
             /* Se não tem sala inicial, verifica se existe uma instância no mundo */
             else {
                 struct char_data *qm_char;
-                for (qm_char = character_list; qm_char; qm_char = qm_char->next) {
-                    if (IS_NPC(qm_char) && GET_MOB_RNUM(qm_char) == mob_rnum) {
-                        qm_zone = world[IN_ROOM(qm_char)].zone;
-                        if (qm_zone == zone) {
-                            return mob_index[mob_rnum].vnum;
-                        }
+                for (qm_char = first_mob_instance(mob_rnum); qm_char; qm_char = qm_char->next_instance) {
+                    qm_zone = world[IN_ROOM(qm_char)].zone;
+                    if (qm_zone == zone) {
+                        return mob_index[mob_rnum].vnum;
                     }
                 }
             }
@@ -5128,11 +5126,8 @@ mob_vnum find_questmaster_for_zone(zone_rnum zone)
     for (mob_rnum = 0; mob_rnum <= top_of_mobt; mob_rnum++) {
         if (mob_index[mob_rnum].func == questmaster) {
             /* Verifica se existe uma instância ativa no mundo */
-            struct char_data *qm_char;
-            for (qm_char = character_list; qm_char; qm_char = qm_char->next) {
-                if (IS_NPC(qm_char) && GET_MOB_RNUM(qm_char) == mob_rnum) {
-                    return mob_index[mob_rnum].vnum;
-                }
+            if (first_mob_instance(mob_rnum)) {
+                return mob_index[mob_rnum].vnum;
             }
             /* Se não há instância ativa, mas tem questmaster function, usa mesmo assim */
             if (best_qm == NOBODY) {
@@ -5154,25 +5149,15 @@ mob_vnum find_questmaster_for_zone(zone_rnum zone)
 /* Enhancement 2: Helper function to find current owner of an item */
 struct char_data *find_item_owner(obj_vnum item_vnum)
 {
-    struct char_data *ch;
     struct obj_data *obj;
+    struct char_data *owner;
 
-    /* Search through all characters in game */
-    for (ch = character_list; ch; ch = ch->next) {
-        /* Check carried items */
-        for (obj = ch->carrying; obj; obj = obj->next_content) {
-            if (GET_OBJ_VNUM(obj) == item_vnum) {
-                return ch;
-            }
-        }
-
-        /* Check equipped items */
-        int i;
-        for (i = 0; i < NUM_WEARS; i++) {
-            if (GET_EQ(ch, i) && GET_OBJ_VNUM(GET_EQ(ch, i)) == item_vnum) {
-                return ch;
-            }
-        }
+    /* Search through the live copies of the item for one carried or equipped,
+       also inside whatever bags the owner has */
+    for (obj = first_obj_instance(real_object(item_vnum)); obj; obj = obj->next_instance) {
+        obj_location(obj, &owner);
+        if (owner)
+            return owner;
     }
 
     return NULL; /* Item not found in anyone's possession */
@@ -7277,10 +7262,28 @@ void update_mob_emotion_assisted(struct char_data *mob, struct char_data *assist
 /**
  * Update mob emotions over time (passive decay/stabilization)
  * Call this periodically for emotional regulation
- * Uses configurable decay rates that vary by emotion type and intensity
  * @param mob The mob whose emotions to regulate
  */
 void update_mob_emotion_passive(struct char_data *mob)
+{
+    if (!mob || !IS_NPC(mob) || !mob->ai_data || !CONFIG_MOB_CONTEXTUAL_SOCIALS)
+        return;
+
+    update_mob_emotion_decay(mob);
+
+    /* Emotional self-regulation behaviors (justify / deflect / apologize / reframe) */
+    perform_emotional_regulation(mob);
+}
+
+/**
+ * The silent part of update_mob_emotion_passive(): emotions drift back
+ * toward their baselines and memories decay, without any visible behavior,
+ * so it can also be run repeatedly to catch up a mob that sat out a
+ * dormant zone.
+ * Uses configurable decay rates that vary by emotion type and intensity
+ * @param mob The mob whose emotions to decay
+ */
+void update_mob_emotion_decay(struct char_data *mob)
 {
     if (!mob || !IS_NPC(mob) || !mob->ai_data || !CONFIG_MOB_CONTEXTUAL_SOCIALS)
         return;
@@ -7560,9 +7563,6 @@ void update_mob_emotion_passive(struct char_data *mob)
 
     /* MALP/MPLP consolidation: evaluate episodic slots, build long-term memory (RFC-1002) */
     consolidator_tick(mob);
-
-    /* Emotional self-regulation behaviors (justify / deflect / apologize / reframe) */
-    perform_emotional_regulation(mob);
 }
 
 /**
@@ -8443,12 +8443,9 @@ void mob_mourn_death(struct char_data *mob, struct char_data *deceased)
     }
 
     /* Find the social command number */
-    for (cmd_num = 0; *complete_cmd_info[cmd_num].command != '\n'; cmd_num++) {
-        if (!strcmp(complete_cmd_info[cmd_num].command, social_to_use))
-            break;
-    }
+    cmd_num = find_command(social_to_use);
 
-    if (*complete_cmd_info[cmd_num].command != '\n') {
+    if (cmd_num >= 0) {
         /* Perform the mourning social */
         do_action(mob, "", cmd_num, 0);
 
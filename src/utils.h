@@ -179,6 +179,7 @@ void update_mob_emotion_robbed_shopping(struct char_data *buyer, struct char_dat
 void update_mob_emotion_rescued(struct char_data *mob, struct char_data *rescuer);
 void update_mob_emotion_assisted(struct char_data *mob, struct char_data *assistant);
 void update_mob_emotion_passive(struct char_data *mob);
+void update_mob_emotion_decay(struct char_data *mob);
 void update_mob_emotion_contagion(struct char_data *mob);
 void decay_emotion_memories(struct char_data *mob);
 void perform_emotional_regulation(struct char_data *mob);
@@ -1398,6 +1399,10 @@ int get_mob_skill(struct char_data *ch, int skill_num);
 #define CONFIG_SPECIAL_IN_COMM config_info.operation.special_in_comm
 /** Activate debug mode? */
 #define CONFIG_DEBUG_MODE config_info.operation.debug_mode
+/** Minutes a zone and its neighbours must be empty before it goes dormant. */
+#define CONFIG_ZONE_DORMANCY config_info.operation.zone_dormancy
+/** How often mobs in dormant zones act; 0 freezes them until the zone wakes. */
+#define CONFIG_DORMANT_MOB_RATE config_info.operation.dormant_mob_rate
 
 /* Autowiz */
 /** Use autowiz or not? */